@@ -0,0 +1,503 @@
+#include <benchmark/benchmark.h>
+
+#include <clang/AST/ASTConsumer.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Rewrite/Core/Rewriter.h>
+#include <clang/Tooling/Tooling.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <random>
+
+#include "../../Common/include/Context.h"
+#include "../../Common/include/DependencyGraph.h"
+#include "../../Common/include/Helper.h"
+#include "../../Common/include/Options.h"
+#include "../../Common/include/Visitors.h"
+
+#define _SILENCE_ALL_CXX17_DEPRECATION_WARNINGS
+
+using namespace Common;
+
+/**
+ * The number of calls to the global `operator new` since the start of the process.\n
+ * The counter is updated by the replacement allocation functions below.
+ */
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(const std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (const auto pointer = std::malloc(size == 0 ? 1 : size))
+	{
+		return pointer;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+/**
+ * Contains the microbenchmarks of the kernels that are run for each variant of the reduction.\n
+ * Each benchmark reports the time per operation and the number of allocations per operation (`allocs/op`).
+ */
+namespace Benchmarks
+{
+	/**
+	 * Reports the allocations made in the measured part of the benchmark.
+	 *
+	 * @param state The state of the benchmark.
+	 * @param allocations The number of allocations made by all iterations.
+	 */
+	static void ReportAllocations(benchmark::State& state, const size_t allocations)
+	{
+		state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations),
+		                                                 benchmark::Counter::kAvgIterations);
+	}
+
+	/**
+	 * Creates a synthetic dependency graph.\n
+	 * In a shallow graph, all nodes are children of the first node (e.g., statements of a single function).
+	 * In a deep graph, each node is the child of the previous one (e.g., nested blocks). Every third node also
+	 * depends on its predecessor through a variable. The last node is the criterion.
+	 *
+	 * @param nodeCount The number of nodes (code units) in the graph.
+	 * @param deep Specifies whether the nodes should be nested in each other.
+	 * @return The created graph.
+	 */
+	static DependencyGraph CreateGraph(const int nodeCount, const bool deep)
+	{
+		auto graph = DependencyGraph();
+
+		for (auto i = 0; i < nodeCount; i++)
+		{
+			graph.InsertNodeDataForDebugging(i, i, std::string(16 + i % 7, 'x'), "Stmt", "black");
+		}
+
+		for (auto i = 1; i < nodeCount; i++)
+		{
+			graph.InsertStatementDependency(deep ? i - 1 : 0, i);
+
+			if (i % 3 == 0)
+			{
+				graph.InsertVariableDependency(i - 1, i);
+			}
+		}
+
+		graph.AddCriterionNode(nodeCount - 1);
+
+		return graph;
+	}
+
+	/**
+	 * Creates bit masks with randomly set bits, always using the same seed.
+	 *
+	 * @param nodeCount The size of each bit mask.
+	 * @param count The number of bit masks.
+	 * @return The created bit masks.
+	 */
+	static std::vector<BitMask> CreateBitMasks(const int nodeCount, const int count)
+	{
+		auto generator = std::mt19937(42);
+		auto bitMasks = std::vector<BitMask>();
+
+		for (auto i = 0; i < count; i++)
+		{
+			auto bitMask = BitMask(nodeCount);
+
+			for (auto j = 0; j < nodeCount; j++)
+			{
+				bitMask[j] = generator() % 2 == 0;
+			}
+
+			bitMasks.push_back(bitMask);
+		}
+
+		return bitMasks;
+	}
+
+	/**
+	 * Creates the source code of a synthetic C program.\n
+	 * A shallow program consists of a single function with a sequence of statements, a deep program nests
+	 * each statement in a block of the previous one.
+	 *
+	 * @param statementCount The number of statements, each statement makes a few code units.
+	 * @param deep Specifies whether the statements should be nested in each other.
+	 * @return The source code of the program.
+	 */
+	static std::string CreateSource(const int statementCount, const bool deep)
+	{
+		auto source = std::string("int main(void)\n{\n\tint value = 0;\n");
+
+		for (auto i = 0; i < statementCount; i++)
+		{
+			source += deep
+				          ? "\tif (value < " + std::to_string(i + 1) + ")\n\t{\n\t\tvalue++;\n"
+				          : "\tvalue += " + std::to_string(i) + ";\n";
+		}
+
+		if (deep)
+		{
+			for (auto i = 0; i < statementCount; i++)
+			{
+				source += "\t}\n";
+			}
+		}
+
+		return source + "\treturn value;\n}\n";
+	}
+
+	static void BM_Increment(benchmark::State& state)
+	{
+		auto bitMask = BitMask(state.range(0));
+		const auto allocationsBefore = allocationCount.load();
+
+		for (auto _ : state)
+		{
+			Increment(bitMask);
+			benchmark::DoNotOptimize(bitMask);
+		}
+
+		ReportAllocations(state, allocationCount.load() - allocationsBefore);
+	}
+
+	static void BM_InitializeBitMask(benchmark::State& state)
+	{
+		auto bitMask = BitMask(state.range(0));
+		size_t number = 0;
+		const auto allocationsBefore = allocationCount.load();
+
+		for (auto _ : state)
+		{
+			InitializeBitMask(bitMask, number++);
+			benchmark::DoNotOptimize(bitMask);
+		}
+
+		ReportAllocations(state, allocationCount.load() - allocationsBefore);
+	}
+
+	static void BM_IsValid(benchmark::State& state)
+	{
+		const auto nodeCount = static_cast<int>(state.range(0));
+		auto graph = CreateGraph(nodeCount, state.range(1) != 0);
+		const auto bitMasks = CreateBitMasks(nodeCount, 256);
+
+		// Fill the caches of the graph, as the binning does before validating the bit masks.
+		graph.Prepare(nodeCount);
+
+		size_t i = 0;
+		const auto allocationsBefore = allocationCount.load();
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(IsValid(bitMasks[i++ % bitMasks.size()], graph));
+		}
+
+		ReportAllocations(state, allocationCount.load() - allocationsBefore);
+	}
+
+	static void BM_IsValidEncoded(benchmark::State& state)
+	{
+		const auto nodeCount = static_cast<int>(state.range(0));
+		auto graph = CreateGraph(nodeCount, state.range(1) != 0);
+		auto bitMasks = std::vector<EncodedBitMask>();
+
+		for (const auto& bitMask : CreateBitMasks(nodeCount, 256))
+		{
+			bitMasks.push_back(EncodeBitMask(bitMask));
+		}
+
+		graph.Prepare(nodeCount);
+		const auto encodedGraph = EncodedDependencies(graph, nodeCount);
+
+		size_t i = 0;
+		const auto allocationsBefore = allocationCount.load();
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(IsValid(bitMasks[i++ % bitMasks.size()], encodedGraph));
+		}
+
+		ReportAllocations(state, allocationCount.load() - allocationsBefore);
+	}
+
+	static void BM_MergeVectorMaps(benchmark::State& state)
+	{
+		const auto nodeCount = static_cast<int>(state.range(0));
+		const auto bitMasks = CreateBitMasks(nodeCount, 1024);
+
+		// The bins of a single worker, as created by the binning of the naive algorithm.
+		auto bins = EpochRanges();
+
+		for (size_t i = 0; i < bitMasks.size(); i++)
+		{
+			bins[(i % 5 + 1) * 0.2].Add(bitMasks[i]);
+		}
+
+		size_t allocations = 0;
+
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			auto from = bins;
+			auto to = bins;
+			state.ResumeTiming();
+
+			const auto allocationsBefore = allocationCount.load();
+			MergeVectorMaps(from, to);
+			allocations += allocationCount.load() - allocationsBefore;
+
+			benchmark::DoNotOptimize(to);
+		}
+
+		ReportAllocations(state, allocations);
+	}
+
+	static void BM_GetDependentNodes(benchmark::State& state)
+	{
+		const auto nodeCount = static_cast<int>(state.range(0));
+		const auto original = CreateGraph(nodeCount, state.range(1) != 0);
+
+		size_t allocations = 0;
+
+		// Each iteration queries all nodes of a fresh graph, the results are not cached yet.
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			auto graph = original;
+			state.ResumeTiming();
+
+			const auto allocationsBefore = allocationCount.load();
+
+			for (auto node = 0; node < nodeCount; node++)
+			{
+				benchmark::DoNotOptimize(graph.GetDependentNodes(node));
+			}
+
+			allocations += allocationCount.load() - allocationsBefore;
+		}
+
+		state.SetItemsProcessed(state.iterations() * nodeCount);
+		ReportAllocations(state, allocations);
+	}
+
+	static void BM_GetTotalCharacterCount(benchmark::State& state)
+	{
+		const auto original = CreateGraph(static_cast<int>(state.range(0)), state.range(1) != 0);
+
+		size_t allocations = 0;
+
+		// The count is computed during the first call only, each iteration uses a fresh graph.
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			auto graph = original;
+			state.ResumeTiming();
+
+			const auto allocationsBefore = allocationCount.load();
+			benchmark::DoNotOptimize(graph.GetTotalCharacterCount());
+			allocations += allocationCount.load() - allocationsBefore;
+		}
+
+		ReportAllocations(state, allocations);
+	}
+
+	/**
+	 * Maps the parsed synthetic program and runs the measured printing passes over its AST.\n
+	 * Every other code unit is removed in each pass.
+	 */
+	class PrintingBenchmarkConsumer final : public clang::ASTConsumer
+	{
+		clang::CompilerInstance* ci_;
+		benchmark::State& state_;
+
+	public:
+		PrintingBenchmarkConsumer(clang::CompilerInstance* ci, benchmark::State& state) : ci_(ci), state_(state)
+		{
+		}
+
+		void HandleTranslationUnit(clang::ASTContext& context) override
+		{
+			auto mapping = std::make_shared<NodeMapping>();
+
+			// No code unit is on the error-inducing line, all of them can be removed.
+			MappingASTVisitor mappingVisitor(ci_, mapping, 0);
+			mappingVisitor.TraverseDecl(context.getTranslationUnitDecl());
+
+			VariantPrintingASTVisitor printingVisitor(ci_, 0);
+			printingVisitor.SetData(mappingVisitor.GetSkippedNodes(), mappingVisitor.graph, mappingVisitor.errorLines);
+
+			auto bitMask = BitMask(mapping->size(), true);
+
+			for (size_t i = 0; i < bitMask.size(); i += 2)
+			{
+				bitMask[i] = false;
+			}
+
+			size_t allocations = 0;
+
+			for (auto _ : state_)
+			{
+				const auto allocationsBefore = allocationCount.load();
+
+				auto rewriter = std::make_shared<clang::Rewriter>(context.getSourceManager(), context.getLangOpts());
+
+				printingVisitor.Reset(bitMask, rewriter);
+				printingVisitor.TraverseDecl(context.getTranslationUnitDecl());
+
+				allocations += allocationCount.load() - allocationsBefore;
+			}
+
+			state_.counters["code units"] = static_cast<double>(mapping->size());
+			ReportAllocations(state_, allocations);
+		}
+	};
+
+	class PrintingBenchmarkAction final : public clang::ASTFrontendAction
+	{
+		benchmark::State& state_;
+
+	public:
+		explicit PrintingBenchmarkAction(benchmark::State& state) : state_(state)
+		{
+		}
+
+		std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& ci, llvm::StringRef file) override
+		{
+			return std::make_unique<PrintingBenchmarkConsumer>(&ci, state_);
+		}
+	};
+
+	static void BM_VariantPrinting(benchmark::State& state)
+	{
+		const auto source = CreateSource(static_cast<int>(state.range(0)), state.range(1) != 0);
+
+		if (!clang::tooling::runToolOnCodeWithArgs(std::make_unique<PrintingBenchmarkAction>(state), source,
+		                                           {"-std=c99"}, "benchmark.c"))
+		{
+			state.SkipWithError("The synthetic program could not be parsed.");
+		}
+	}
+
+	/**
+	 * Lists the inputs of the end-to-end evaluation, sorted by their names.
+	 *
+	 * @return The paths to the C and C++ files in `EvaluationData/`.
+	 */
+	static std::vector<std::filesystem::path> GetEvaluationFiles()
+	{
+		auto files = std::vector<std::filesystem::path>();
+		std::error_code error;
+
+		for (const auto& entry : std::filesystem::directory_iterator("../EvaluationData", error))
+		{
+			if (entry.path().extension() == ".c" || entry.path().extension() == ".cpp")
+			{
+				files.push_back(entry.path());
+			}
+		}
+
+		std::sort(files.begin(), files.end());
+
+		return files;
+	}
+
+	/**
+	 * Measures the compilation of a single variant, i.e., what `Compile` costs each validation.\n
+	 * The variant is an unchanged input of the evaluation. The first compilation is not measured, it lets
+	 * the fast profile plan its jobs the same way the first variant of a reduction does.
+	 */
+	static void BM_Compile(benchmark::State& state)
+	{
+		const auto file = GetEvaluationFiles()[state.range(0)];
+		const auto language = file.extension() == ".c" ? clang::Language::C : clang::Language::CXX;
+
+		CompilationProfile = state.range(1) != 0 ? CompileProfile::Fast : CompileProfile::Default;
+
+		std::filesystem::create_directories(TempFolder);
+
+		const auto variant = std::filesystem::path(TempFolder + std::string("0_") + file.filename().string());
+		std::filesystem::copy_file(file, variant, std::filesystem::copy_options::overwrite_existing);
+
+		const auto entry = std::filesystem::directory_entry(variant);
+
+		if (Compile(entry, language) != 0)
+		{
+			state.SkipWithError("The input could not be compiled.");
+			return;
+		}
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(Compile(entry, language));
+		}
+
+		state.SetLabel(file.filename().string());
+	}
+
+	/**
+	 * Registers each input of the evaluation (by its index) with both profiles (0 = default, 1 = fast).
+	 */
+	static void EvaluationArguments(benchmark::internal::Benchmark* benchmark)
+	{
+		const auto fileCount = static_cast<int>(GetEvaluationFiles().size());
+
+		for (auto file = 0; file < fileCount; file++)
+		{
+			for (auto fast : {0, 1})
+			{
+				benchmark->Args({file, fast});
+			}
+		}
+
+		benchmark->ArgNames({"input", "fast"});
+	}
+
+	/**
+	 * Registers the sizes (10 - 60 code units) and shapes (0 = shallow, 1 = deep) of the benchmarks.
+	 */
+	static void GraphArguments(benchmark::internal::Benchmark* benchmark)
+	{
+		for (auto deep : {0, 1})
+		{
+			for (auto nodeCount : {10, 20, 40, 60})
+			{
+				benchmark->Args({nodeCount, deep});
+			}
+		}
+
+		benchmark->ArgNames({"units", "deep"});
+	}
+
+	BENCHMARK(BM_Increment)->Arg(10)->Arg(20)->Arg(40)->Arg(60)->ArgName("units");
+	BENCHMARK(BM_InitializeBitMask)->Arg(10)->Arg(20)->Arg(40)->Arg(60)->ArgName("units");
+	BENCHMARK(BM_IsValid)->Apply(GraphArguments);
+	BENCHMARK(BM_IsValidEncoded)->Apply(GraphArguments);
+	BENCHMARK(BM_MergeVectorMaps)->Arg(10)->Arg(20)->Arg(40)->Arg(60)->ArgName("units");
+	BENCHMARK(BM_GetDependentNodes)->Apply(GraphArguments);
+	BENCHMARK(BM_GetTotalCharacterCount)->Apply(GraphArguments);
+
+	// The sizes are given in statements, each statement makes up a few code units (see the `code units` counter).
+	BENCHMARK(BM_VariantPrinting)->Args({3, 0})->Args({6, 0})->Args({12, 0})->Args({20, 0})
+	                             ->Args({3, 1})->Args({6, 1})->Args({12, 1})->Args({20, 1})
+	                             ->ArgNames({"statements", "deep"});
+
+	// Compilations take tens of milliseconds, a few iterations are enough.
+	BENCHMARK(BM_Compile)->Apply(EvaluationArguments)->Iterations(10)->Unit(benchmark::kMillisecond);
+} // namespace Benchmarks
+
+BENCHMARK_MAIN();
@@ -0,0 +1,400 @@
+#ifndef BITMASKBIN_H
+#define BITMASKBIN_H
+#pragma once
+
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using BitMask = std::vector<bool>;
+
+/**
+ * A bit mask of at most 64 code units encoded in a single integer.\n
+ * The last bit of the bit mask (.size() - 1) is the least significant bit of the integer, i.e., the encoding
+ * matches the numbering used by `InitializeBitMask`.
+ */
+using EncodedBitMask = std::uint64_t;
+
+/**
+ * The greatest number of code units whose bit masks can be encoded.
+ */
+constexpr size_t MaxEncodedBitMaskSize = 64;
+
+/**
+ * Path to the directory into which bins that do not fit into the memory are spilled.\n
+ * The directory is cleared before each binning.
+ */
+inline const char* SpillFolder = "./spill/";
+
+/**
+ * Encodes a bit mask of at most `MaxEncodedBitMaskSize` bits.
+ *
+ * @param bitMask The bit mask to be encoded.
+ * @return The integer whose bits correspond to the bits of the bit mask.
+ */
+inline EncodedBitMask EncodeBitMask(const BitMask& bitMask)
+{
+	EncodedBitMask code = 0;
+
+	for (const auto bit : bitMask)
+	{
+		code = code << 1 | (bit ? 1 : 0);
+	}
+
+	return code;
+}
+
+/**
+ * Decodes an integer into a bit mask, the size of the bit mask is kept.
+ *
+ * @param code The encoded bit mask.
+ * @param bitMask The bit mask to be overwritten.
+ */
+inline void DecodeBitMask(EncodedBitMask code, BitMask& bitMask)
+{
+	for (auto i = bitMask.size(); i > 0; i--)
+	{
+		bitMask[i - 1] = (code & 1) != 0;
+		code >>= 1;
+	}
+}
+
+/**
+ * Reports that a bin could not be spilled to the disk or that a spilled bin could not be read back.
+ */
+class SpillError final : public std::runtime_error
+{
+public:
+	using std::runtime_error::runtime_error;
+};
+
+/**
+ * An immutable file with encoded bit masks spilled from a bin.\n
+ * The file is removed once the last bin referring to it is destroyed. Failing file operations throw `SpillError`.
+ */
+class SpilledSegment
+{
+	std::string path_;
+	size_t count_;
+
+public:
+	/**
+	 * Writes the given bit masks into a new file in the `SpillFolder`.
+	 *
+	 * @param codes The encoded bit masks to be written.
+	 */
+	explicit SpilledSegment(const std::vector<EncodedBitMask>& codes) : count_(codes.size())
+	{
+		static std::atomic<size_t> segmentCount{0};
+
+		std::error_code error;
+		std::filesystem::create_directories(SpillFolder, error);
+
+		if (error)
+		{
+			throw SpillError("The directory '" + std::string(SpillFolder) + "' for the spilled bins could not be "
+				"created: " + error.message());
+		}
+
+		path_ = std::string(SpillFolder) + "segment_" + std::to_string(segmentCount++) + ".bin";
+
+		auto ofs = std::ofstream(path_, std::ios::binary);
+		ofs.write(reinterpret_cast<const char*>(codes.data()),
+		          static_cast<std::streamsize>(codes.size() * sizeof(EncodedBitMask)));
+		ofs.close();
+
+		if (!ofs)
+		{
+			// The destructor is not run for a segment whose construction failed.
+			std::filesystem::remove(path_, error);
+
+			throw SpillError("The bin could not be spilled to '" + path_ + "'. Consider freeing disk space or "
+				"increasing the `--max-memory` limit.");
+		}
+	}
+
+	~SpilledSegment()
+	{
+		std::error_code error;
+		std::filesystem::remove(path_, error);
+	}
+
+	// Rule of three.
+
+	SpilledSegment(const SpilledSegment& other) = delete;
+	SpilledSegment& operator=(const SpilledSegment& other) = delete;
+
+	/**
+	 * Maps the file into the memory.
+	 *
+	 * @return The buffer with the bit masks of the segment.
+	 */
+	[[nodiscard]] std::shared_ptr<llvm::MemoryBuffer> Map() const
+	{
+		auto buffer = llvm::MemoryBuffer::getFileSlice(path_, count_ * sizeof(EncodedBitMask), 0);
+
+		if (!buffer)
+		{
+			throw SpillError("The spilled bin '" + path_ + "' could not be read: " + buffer.getError().message());
+		}
+
+		return std::shared_ptr<llvm::MemoryBuffer>(std::move(buffer.get()));
+	}
+
+	[[nodiscard]] size_t GetCount() const
+	{
+		return count_;
+	}
+};
+
+/**
+ * A compact container of bit masks of the same size, each bit mask is stored as a single `EncodedBitMask`.\n
+ * The bit masks are kept in the order in which they were added (for the binning, the order of their enumeration)
+ * and decoded on demand while iterating.\n
+ * If a limit is set, the bin keeps at most the given number of bit masks in the memory. Older bit masks are
+ * spilled into append-only segment files, which are memory-mapped one at a time when the bin is iterated.
+ * Adding, appending and iterating may therefore throw `SpillError`.
+ */
+class BitMaskBin
+{
+	size_t bitMaskSize_{0};
+	size_t maxCodesInMemory_{0};
+	std::vector<std::shared_ptr<SpilledSegment>> segments_;
+	std::vector<EncodedBitMask> codes_;
+
+	void SpillIfFull()
+	{
+		if (maxCodesInMemory_ > 0 && codes_.size() >= maxCodesInMemory_)
+		{
+			Spill();
+		}
+	}
+
+public:
+
+	/**
+	 * Iterates over the bit masks of a bin, decoding each of them into a buffer owned by the iterator.\n
+	 * Spilled segments are visited first, in the order of their creation, followed by the bit masks kept
+	 * in the memory. The reference returned by the dereference operator is valid until the iterator is moved.
+	 */
+	class Iterator
+	{
+		const BitMaskBin* bin_;
+		size_t segment_;
+		size_t offset_;
+		std::shared_ptr<llvm::MemoryBuffer> mappedSegment_;
+		const EncodedBitMask* codes_{nullptr};
+		size_t count_{0};
+		mutable BitMask bitMask_;
+
+		/**
+		 * Points the iterator to the data of the current segment or to the bit masks kept in the memory.
+		 */
+		void Load()
+		{
+			if (segment_ < bin_->segments_.size())
+			{
+				mappedSegment_ = bin_->segments_[segment_]->Map();
+				codes_ = reinterpret_cast<const EncodedBitMask*>(mappedSegment_->getBufferStart());
+				count_ = bin_->segments_[segment_]->GetCount();
+			}
+			else
+			{
+				mappedSegment_.reset();
+				codes_ = bin_->codes_.data();
+				count_ = bin_->codes_.size();
+			}
+		}
+
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = BitMask;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const BitMask*;
+		using reference = const BitMask&;
+
+		Iterator(const BitMaskBin* bin, const size_t segment, const size_t offset) :
+			bin_(bin), segment_(segment), offset_(offset), bitMask_(bin->bitMaskSize_)
+		{
+			Load();
+		}
+
+		reference operator*() const
+		{
+			DecodeBitMask(codes_[offset_], bitMask_);
+
+			return bitMask_;
+		}
+
+		pointer operator->() const
+		{
+			return &**this;
+		}
+
+		Iterator& operator++()
+		{
+			if (++offset_ == count_ && segment_ < bin_->segments_.size())
+			{
+				segment_++;
+				offset_ = 0;
+				Load();
+			}
+
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const
+		{
+			return segment_ == other.segment_ && offset_ == other.offset_;
+		}
+
+		bool operator!=(const Iterator& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	BitMaskBin() = default;
+
+	/**
+	 * Moves the bit masks kept in the memory to a new segment.
+	 */
+	void Spill()
+	{
+		if (!codes_.empty())
+		{
+			segments_.push_back(std::make_shared<SpilledSegment>(codes_));
+			std::vector<EncodedBitMask>().swap(codes_);
+		}
+	}
+
+	/**
+	 * Creates an empty bin.
+	 *
+	 * @param bitMaskSize The size of the bit masks, at most `MaxEncodedBitMaskSize`.
+	 * @param maxCodesInMemory The number of bit masks after which the bin is spilled to the disk,
+	 * zero for no limit.
+	 */
+	explicit BitMaskBin(const size_t bitMaskSize, const size_t maxCodesInMemory = 0) :
+		bitMaskSize_(bitMaskSize), maxCodesInMemory_(maxCodesInMemory)
+	{
+	}
+
+	void Add(const EncodedBitMask code)
+	{
+		codes_.push_back(code);
+		SpillIfFull();
+	}
+
+	void Add(const BitMask& bitMask)
+	{
+		bitMaskSize_ = bitMask.size();
+		Add(EncodeBitMask(bitMask));
+	}
+
+	/**
+	 * Moves all bit masks of another bin to the end of this bin.\n
+	 * Spilled segments are taken over without being read.
+	 *
+	 * @param other The bin whose bit masks are taken. It is left empty.
+	 */
+	void Append(BitMaskBin&& other)
+	{
+		if (empty())
+		{
+			bitMaskSize_ = other.bitMaskSize_;
+			maxCodesInMemory_ = std::max(maxCodesInMemory_, other.maxCodesInMemory_);
+		}
+
+		if (!other.segments_.empty())
+		{
+			// Keep the order - the bit masks of this bin precede the spilled ones of the other bin.
+			Spill();
+			segments_.insert(segments_.end(), other.segments_.begin(), other.segments_.end());
+			other.segments_.clear();
+		}
+
+		// The bit masks of both bins together may exceed the limit of this bin.
+		if (maxCodesInMemory_ > 0 && codes_.size() + other.codes_.size() > maxCodesInMemory_)
+		{
+			Spill();
+		}
+
+		if (codes_.empty())
+		{
+			codes_.swap(other.codes_);
+		}
+		else
+		{
+			codes_.insert(codes_.end(), other.codes_.begin(), other.codes_.end());
+		}
+
+		std::vector<EncodedBitMask>().swap(other.codes_);
+		SpillIfFull();
+	}
+
+	/**
+	 * Getter for the bit masks kept in the memory, the spilled bit masks are not included.
+	 *
+	 * @return The encoded bit masks that have not been spilled.
+	 */
+	[[nodiscard]] const std::vector<EncodedBitMask>& GetCodes() const
+	{
+		return codes_;
+	}
+
+	[[nodiscard]] size_t GetBitMaskSize() const
+	{
+		return bitMaskSize_;
+	}
+
+	[[nodiscard]] size_t GetSpilledCount() const
+	{
+		size_t count = 0;
+
+		for (const auto& segment : segments_)
+		{
+			count += segment->GetCount();
+		}
+
+		return count;
+	}
+
+	[[nodiscard]] size_t size() const
+	{
+		return GetSpilledCount() + codes_.size();
+	}
+
+	[[nodiscard]] bool empty() const
+	{
+		return segments_.empty() && codes_.empty();
+	}
+
+	[[nodiscard]] Iterator begin() const
+	{
+		return Iterator(this, 0, 0);
+	}
+
+	[[nodiscard]] Iterator end() const
+	{
+		return Iterator(this, segments_.size(), codes_.size());
+	}
+};
+
+/**
+ * Bins of bit masks accessible by the upper bound of their size ratio.
+ */
+using EpochRanges = std::map<double, BitMaskBin>;
+
+#endif
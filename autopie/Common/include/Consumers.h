@@ -5,6 +5,7 @@
 #include <clang/AST/ASTConsumer.h>
 
 #include "DependencyGraph.h"
+#include "Instrumentation.h"
 #include "Streams.h"
 #include "Visitors.h"
 
@@ -12,6 +13,28 @@
 
 namespace Common
 {
+	/**
+	 * The code prepended to the mutant schema. `__autopie_keep` reads the bit mask from the `SchemaMaskVariable`
+	 * environment variable once, nodes beyond the end of the bit mask are kept.\n
+	 * The `#line` directive restores the line numbers of the original file.
+	 */
+	inline const char* SchemaPrelude = R"(#include <stdlib.h>
+#include <string.h>
+static int __autopie_keep(unsigned long unit)
+{
+	static const char* mask = 0;
+	static unsigned long size = 0;
+	if (!mask)
+	{
+		mask = getenv("AUTOPIE_MASK");
+		mask = mask ? mask : "";
+		size = strlen(mask);
+	}
+	return unit >= size || mask[unit] != '0';
+}
+#line 1
+)";
+
 	/**
 	 * Prepares and dispatches the `VariantPrintingASTVisitor`, prints its output.\n
 	 * Serves as a middle man for data transactions.
@@ -39,6 +62,8 @@ namespace Common
 		void HandleTranslationUnit(clang::ASTContext& context, const std::string& fileName,
 		                           const BitMask& bitMask) const
 		{
+			Instrumentation::ScopedPhase phase("printing");
+
 			auto rewriter = std::make_shared<clang::Rewriter>(context.getSourceManager(), context.getLangOpts());
 
 			visitor_->Reset(bitMask, rewriter);
@@ -59,6 +84,39 @@ namespace Common
 			outFile.close();
 		}
 
+		/**
+		 * Dispatches the visitor to the root node in order to generate the mutant schema - a program in which
+		 * the removable nodes are guarded by runtime switches, see `VariantPrintingASTVisitor::ResetSchema`.\n
+		 * The schema is dumped to the specified file.
+		 *
+		 * @param context The AST context.
+		 * @param fileName The file to which the output should be written.
+		 * @param nodeCount The number of code units.
+		 * @return The nodes guarded in the schema, the remaining nodes cannot be removed at runtime.
+		 */
+		[[nodiscard]] BitMask HandleSchema(clang::ASTContext& context, const std::string& fileName,
+		                                   const size_t nodeCount) const
+		{
+			Instrumentation::ScopedPhase phase("printing");
+
+			auto rewriter = std::make_shared<clang::Rewriter>(context.getSourceManager(), context.getLangOpts());
+			const auto mainFile = context.getSourceManager().getMainFileID();
+
+			visitor_->ResetSchema(rewriter, nodeCount);
+			visitor_->TraverseDecl(context.getTranslationUnitDecl());
+			visitor_->InsertGuards();
+
+			rewriter->InsertText(context.getSourceManager().getLocForStartOfFile(mainFile), SchemaPrelude, false);
+
+			std::error_code errorCode;
+			llvm::raw_fd_ostream outFile(fileName, errorCode, llvm::sys::fs::F_None);
+
+			rewriter->getEditBuffer(mainFile).write(outFile);
+			outFile.close();
+
+			return visitor_->guardedNodes;
+		}
+
 		/**
 		 * Passed instances of members that could not be initialized previously to the visitor.
 		 *
@@ -93,6 +151,11 @@ namespace Common
 		GlobalContext& globalContext_;
 		const int iteration_{0};
 
+		/**
+		 * The consumer is created before the file is parsed, the AST is complete once it is handled.
+		 */
+		const Instrumentation::Clock::time_point creationTime_ = Instrumentation::Clock::now();
+
 	public:
 		DependencyMappingASTConsumer(clang::CompilerInstance* ci, GlobalContext& context) : globalContext_(context)
 		{
@@ -102,11 +165,16 @@ namespace Common
 		}
 
 		DependencyMappingASTConsumer(clang::CompilerInstance* ci, GlobalContext& context,
-		                             const int iteration) : globalContext_(context), iteration_(iteration)
+		                             const int iteration) : DependencyMappingASTConsumer(
+			ci, context, iteration, context.GetErrorLine())
+		{
+		}
+
+		DependencyMappingASTConsumer(clang::CompilerInstance* ci, GlobalContext& context, const int iteration,
+		                             const int errorLine) : globalContext_(context), iteration_(iteration)
 		{
 			nodeMapping_ = std::make_shared<NodeMapping>();
-			mappingVisitor_ = std::make_unique<MappingASTVisitor>(ci, nodeMapping_,
-			                                                      globalContext_.parsedInput.errorLocation.lineNumber);
+			mappingVisitor_ = std::make_unique<MappingASTVisitor>(ci, nodeMapping_, errorLine);
 		}
 
 		/**
@@ -117,8 +185,14 @@ namespace Common
 		 */
 		void HandleTranslationUnit(clang::ASTContext& context) override
 		{
+			Instrumentation::RecordPhase("ast", creationTime_, Instrumentation::Clock::now());
+			Instrumentation::ScopedPhase phase("mapping");
+
 			mappingVisitor_->TraverseDecl(context.getTranslationUnitDecl());
 
+			// Correct the character counts now, the read-only queries of the graph rely on them.
+			mappingVisitor_->graph.GetTotalCharacterCount();
+
 			Out::Verb() << "DEBUG: AST nodes counted: " << mappingVisitor_->codeUnitsCount << ", AST nodes actual: " <<
 				nodeMapping_->size() << "\n";
 
@@ -129,8 +203,15 @@ namespace Common
 
 			if (globalContext_.parsedInput.dumpDot && globalContext_.currentEpoch == 0)
 			{
+				// Projects consist of multiple files, name the dump after the one that is being mapped.
+				const auto& sourceManager = context.getSourceManager();
+				const auto mappedFile = globalContext_.deltaContext.project.IsEnabled()
+					                        ? sourceManager.getFileEntryForID(sourceManager.getMainFileID())->getName().
+					                                        str()
+					                        : globalContext_.parsedInput.errorLocation.filePath;
+
 				const auto dotFileOutput = VisualsFolder + std::string("dotDump_") + std::to_string(iteration_) + "_" +
-					GetFileName(globalContext_.parsedInput.errorLocation.filePath) + ".dot";
+					GetFileName(mappedFile) + ".dot";
 				mappingVisitor_->graph.DumpDot(dotFileOutput);
 			}
 		}
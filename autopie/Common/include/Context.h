@@ -2,11 +2,12 @@
 #define CONTEXT_H
 #pragma once
 
+#include <chrono>
+
 #include "Helper.h"
+#include "Instrumentation.h"
 #include "Streams.h"
 
-using EpochRanges = std::map<double, std::vector<BitMask>>;
-
 namespace Naive
 {
 	/**
@@ -28,14 +29,108 @@ namespace Naive
 
 namespace Delta
 {
+	/**
+	 * Keeps the state of a single translation unit reduced in project mode.
+	 */
+	struct TranslationUnit
+	{
+		std::string originalPath;
+		std::string name; ///< A unique name used for the unit's variants and objects.
+		std::string currentTestCase;
+		std::string currentObject;
+		std::vector<std::string> compileFlags;
+		clang::Language language{clang::Language::Unknown};
+		int codeUnitCount{0};
+
+		/**
+		 * The error-inducing line in the current test case, zero if the error does not occur in this unit.
+		 */
+		size_t errorLine{0};
+
+		/**
+		 * The potential error-inducing lines (LLDB workaround) of the current test case.
+		 */
+		std::vector<size_t> errorLines;
+	};
+
+	/**
+	 * Keeps the data of a project reduction, i.e., a reduction of multiple translation units linked together.\n
+	 * Units are reduced one at a time, the remaining units are linked in using their current object files.
+	 */
+	struct ProjectContext
+	{
+		std::vector<TranslationUnit> units;
+		std::vector<std::string> linkFlags;
+		size_t activeUnit{0};
+		size_t criterionUnit{0};
+
+		/**
+		 * Maps the source code of a variant and its flags to an already compiled object file.\n
+		 * Allows unchanged variants to skip the compilation. The whole text is the key, so colliding hashes
+		 * are told apart by the map and never link a wrong object.
+		 */
+		std::unordered_map<std::string, std::string> objectCache;
+
+		/**
+		 * Maps the path of each validated variant to the object file that was linked for it.
+		 */
+		std::unordered_map<std::string, std::string> variantObjects;
+
+		[[nodiscard]] bool IsEnabled() const
+		{
+			return !units.empty();
+		}
+
+		[[nodiscard]] TranslationUnit& ActiveUnit()
+		{
+			return units[activeUnit];
+		}
+
+		[[nodiscard]] const TranslationUnit& ActiveUnit() const
+		{
+			return units[activeUnit];
+		}
+	};
+
 	struct DeltaAlgorithmContext
 	{
 		int latestCodeUnitCount{0};
+
+		/**
+		 * The number of units the last iteration has split, i.e., all code units for ddmin and the code units
+		 * of the current level for HDD.
+		 */
+		int latestUnitCount{0};
+
+		/**
+		 * The depth in the statement hierarchy that is currently being minimized by HDD.
+		 */
+		int hierarchyLevel{0};
+
+		/**
+		 * The probability of each code unit of the current test case being necessary, used by ProbDD.
+		 */
+		std::vector<double> keepProbabilities;
+
+		/**
+		 * Set if the next iteration should first try removing all declarations unreachable from the criterion.
+		 */
+		bool pruneUnreachable{false};
+
+		/**
+		 * The dependencies learned with `--learn-dependencies` so far, indexed by the translation unit (zero
+		 * outside of the project mode). Each iteration builds a new graph and restores them in it.
+		 */
+		std::unordered_map<size_t, std::vector<LearnedDependency>> learnedDependencies;
+
+		ProjectContext project;
 	};
 } // namespace Delta
 
 /**
- * Keeps track of the current run's statistics - the algorithm's efficiency.
+ * Keeps track of the current run's statistics - the algorithm's efficiency.\n
+ * Phase timers and counters are collected by the process-wide `Instrumentation::Recorder`,
+ * which is reset by the tool starting a new run (see `StartRun`), not by the construction of the statistics.
  */
 struct Statistics
 {
@@ -45,20 +140,74 @@ struct Statistics
 	size_t outputSizeInBytes = 0;
 	int exitCode = EXIT_FAILURE;
 
-	Statistics()
-	= default;
+	Statistics() = default;
 
 	explicit Statistics(const std::string& inputFile)
 	{
 		inputSizeInBytes = file_size(std::filesystem::path(inputFile));
 	}
 
+	/**
+	 * Discards the phases and counters of the previous run of the process, e.g., of a previous `--serve` request.
+	 */
+	static void StartRun()
+	{
+		Instrumentation::GetRecorder().Reset(!TraceFile.empty());
+	}
+
 	void Finalize(const std::string& outputFile)
 	{
 		outputSizeInBytes = file_size(std::filesystem::path(outputFile));
 	}
 };
 
+/**
+ * The state of the reduction loops that is periodically saved to the `--checkpoint-file`, together with
+ * the state kept in the global context (the statistics, the Delta debugging context and the validation cache).\n
+ * A reduction started with the `--resume` option loads the state and continues from the saved iteration
+ * (DeltaReduction) or from the saved variant of the saved epoch (NaiveReduction).
+ */
+struct Checkpoint
+{
+	/**
+	 * Set if the state has been loaded from the file and has not been used to restart the algorithm yet.
+	 */
+	bool resumed{false};
+
+	/**
+	 * The last Delta debugging iteration, or the number of variants generated before the current epoch.
+	 */
+	int iteration{0};
+
+	// Delta debugging.
+	std::string currentTestCase;
+	int partitionCount{0};
+
+	// Delta debugging in project mode.
+	size_t activeUnit{0};
+	std::vector<Delta::TranslationUnit> units; ///< The loaded state of the units, applied once they are set up.
+
+	// Naive reduction.
+	int epoch{0};
+	size_t binCursor{0}; ///< The number of variants of the epoch that have already been validated.
+
+	/**
+	 * The source files of the reduction, all of them identify the checkpoint. The error location's file if empty.
+	 */
+	std::vector<std::string> inputFiles;
+
+	/**
+	 * The time of the last save, the `--checkpoint-interval` is counted from the start of the reduction.
+	 */
+	std::chrono::steady_clock::time_point lastSave{std::chrono::steady_clock::now()};
+
+	/**
+	 * Set once the validations of this reduction are appended to the journal of the validation cache.
+	 * A journal left by another reduction is truncated before the first append.
+	 */
+	bool journalOpened{false};
+};
+
 /**
  * Serves as a container for all publicly available global information.
  * Currently includes the parsed input.
@@ -80,6 +229,30 @@ public:
 	Naive::IterativeDeepeningContext deepeningContext;
 	clang::Language language{clang::Language::Unknown};
 	std::unordered_map<size_t, std::vector<size_t>> variantAdjustedErrorLocations;
+	Checkpoint checkpoint;
+
+	/**
+	 * The bit masks of the variants generated in the current epoch, indexed by the variant number.
+	 * Kept only with `--learn-dependencies` (NaiveReduction).
+	 */
+	std::unordered_map<size_t, BitMask> variantBitMasks;
+
+	/**
+	 * The compilation errors of the last validated variant, see `DependencyGraph::LearnFromErrors`.
+	 */
+	std::vector<CompilationError> compilationErrors;
+
+	/**
+	 * Maps the hash of a validated variant (its source code and the source code of everything it is linked with)
+	 * to the result of its validation. Saved with the checkpoint, the hash is therefore stable across runs.
+	 */
+	std::unordered_map<size_t, bool> validationCache;
+
+	/**
+	 * The validations added to the `validationCache` since the last checkpoint, appended to its journal by
+	 * the next save.
+	 */
+	std::vector<std::pair<size_t, bool>> unsavedValidations;
 
 	GlobalContext(InputData& input, const std::string& inputFile, const int epochs) : stats(inputFile),
 	                                                                                  parsedInput(input),
@@ -87,6 +260,38 @@ public:
 	{
 		Out::Verb() << "DEBUG: GlobalContext - New non-default constructor call.\n";
 	}
+
+	/**
+	 * Creates the path of the source file variant generated in a given iteration.\n
+	 * In project mode, the name is based on the translation unit that is currently being reduced.
+	 *
+	 * @param iteration The number of the iteration (or the variant) which is used as the file name's prefix.
+	 * @return The path to the variant in the temporary directory.
+	 */
+	[[nodiscard]] std::string GetVariantFileName(const int iteration) const
+	{
+		const auto name = deltaContext.project.IsEnabled()
+			                  ? deltaContext.project.ActiveUnit().name
+			                  : GetFileName(parsedInput.errorLocation.filePath);
+
+		return TempFolder + std::to_string(iteration) + "_" + name + LanguageToExtension(language);
+	}
+
+	/**
+	 * Retrieves the error-inducing line of the file that is currently being reduced.\n
+	 * In project mode, the line is zero for translation units other than the one in which the error occurs.
+	 *
+	 * @return The line number that should be used when mapping the current file.
+	 */
+	[[nodiscard]] int GetErrorLine() const
+	{
+		if (deltaContext.project.IsEnabled())
+		{
+			return static_cast<int>(deltaContext.project.ActiveUnit().errorLine);
+		}
+
+		return parsedInput.errorLocation.lineNumber;
+	}
 };
 
 #endif
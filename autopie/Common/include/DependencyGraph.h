@@ -2,8 +2,11 @@
 #define DEPENDENCYGRAPH_H
 #pragma once
 
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <queue>
+#include <unordered_set>
 #include <utility>
 
 #include "Helper.h"
@@ -24,9 +27,12 @@ struct Node
 	int astId{0};
 	int number{0};
 	int characterCount{0};
+	size_t line{0}; ///< The first line of the code removed with the node, zero if it is unknown.
+	size_t lineBreaks{0}; ///< The number of line breaks removed with the node.
 	std::string dumpColor;
 	std::string codeSnippet;
 	std::string nodeTypeName;
+	std::vector<std::string> declaredNames; ///< The names of the functions, types and variables the node declares.
 
 	Node() : dumpColor("black"),
 	         codeSnippet(""),
@@ -57,10 +63,13 @@ class DependencyGraph
 	std::unordered_map<int, std::vector<int>> statementInverseEdges_;
 	std::unordered_map<int, std::vector<int>> variableEdges_;
 	std::unordered_map<int, std::vector<int>> variableInverseEdges_;
+	std::unordered_map<int, std::vector<int>> learnedEdges_;
 	std::unordered_map<int, std::vector<int>> dependentNodesCache_;
 
 	/**
-	 * Recursively searches for all children of a given node in a given unordered map.
+	 * Recursively searches for all children of a given node in a given unordered map.\n
+	 * Each child is reported once. Variable dependencies may form cycles (e.g., mutually referencing records),
+	 * the nodes are therefore not searched twice.
 	 *
 	 * @param startingNode The node whose children should be searched.
 	 * @param container The unordered map in which the search should be conducted.
@@ -70,6 +79,7 @@ class DependencyGraph
 	{
 		auto nodeQ = std::queue<int>();
 		auto allDependencies = std::vector<int>();
+		auto visited = std::unordered_set<int>{startingNode};
 
 		nodeQ.push(startingNode);
 
@@ -84,8 +94,11 @@ class DependencyGraph
 			{
 				for (auto dependency : it->second)
 				{
-					nodeQ.push(dependency);
-					allDependencies.push_back(dependency);
+					if (visited.insert(dependency).second)
+					{
+						nodeQ.push(dependency);
+						allDependencies.push_back(dependency);
+					}
 				}
 			}
 		}
@@ -93,6 +106,165 @@ class DependencyGraph
 		return allDependencies;
 	}
 
+	/**
+	 * Determines which nodes are present in the variant given by a bit mask.\n
+	 * A node is present if its bit is set and all of its statement parents are present. The parents are traversed
+	 * after their children, so the nodes are processed in the reverse traversal order.
+	 *
+	 * @param bitMask The variant represented by a bit mask.
+	 * @return The presence of each node, indexed by the traversal order number.
+	 */
+	[[nodiscard]] BitMask GetPresentNodes(const BitMask& bitMask) const
+	{
+		auto present = bitMask;
+
+		for (auto i = static_cast<int>(present.size()) - 1; i >= 0; i--)
+		{
+			const auto it = statementInverseEdges_.find(i);
+
+			if (!present[i] || it == statementInverseEdges_.end())
+			{
+				continue;
+			}
+
+			for (auto parent : it->second)
+			{
+				if (parent < static_cast<int>(present.size()) && !present[parent])
+				{
+					present[i] = false;
+					break;
+				}
+			}
+		}
+
+		return present;
+	}
+
+	/**
+	 * Maps a line of a variant to the line of the original file.\n
+	 * The variant is printed by removing the ranges of its outermost removed nodes (see
+	 * `VariantPrintingASTVisitor::ShouldBeRemoved`), each of which joins the lines it spans into a single one.
+	 *
+	 * @param bitMask The variant represented by a bit mask.
+	 * @param variantLine The line in the variant.
+	 * @return The corresponding line of the original file, the first line of a removed range for lines
+	 * joined by the removal.
+	 */
+	[[nodiscard]] size_t GetOriginalLine(const BitMask& bitMask, const size_t variantLine) const
+	{
+		auto removedRanges = std::vector<std::pair<size_t, size_t>>();
+
+		for (size_t i = 0; i < bitMask.size(); i++)
+		{
+			const auto& node = GetNodeInfo(static_cast<int>(i));
+
+			if (bitMask[i] || node.line == 0)
+			{
+				continue;
+			}
+
+			const auto it = statementInverseEdges_.find(static_cast<int>(i));
+			auto outermost = true;
+
+			if (it != statementInverseEdges_.end())
+			{
+				for (auto parent : it->second)
+				{
+					if (parent < static_cast<int>(bitMask.size()) && !bitMask[parent])
+					{
+						outermost = false;
+						break;
+					}
+				}
+			}
+
+			if (outermost)
+			{
+				removedRanges.emplace_back(node.line, node.lineBreaks);
+			}
+		}
+
+		std::sort(removedRanges.begin(), removedRanges.end());
+
+		auto originalLine = variantLine;
+
+		for (const auto& range : removedRanges)
+		{
+			if (range.first < originalLine)
+			{
+				originalLine += range.second;
+			}
+		}
+
+		return originalLine;
+	}
+
+	/**
+	 * Extracts the quoted identifiers from a compiler message, e.g., `x` from "use of undeclared identifier 'x'".
+	 *
+	 * @param message The message of the compiler.
+	 * @return The identifiers in the order of their appearance.
+	 */
+	static std::vector<std::string> GetQuotedIdentifiers(const std::string& message)
+	{
+		auto identifiers = std::vector<std::string>();
+		auto begin = message.find('\'');
+
+		while (begin != std::string::npos)
+		{
+			const auto end = message.find('\'', begin + 1);
+
+			if (end == std::string::npos)
+			{
+				break;
+			}
+
+			const auto quoted = message.substr(begin + 1, end - begin - 1);
+
+			if (!quoted.empty() && !std::isdigit(static_cast<unsigned char>(quoted.front())) && std::all_of(
+				quoted.begin(), quoted.end(), [](const char c)
+				{
+					return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+				}))
+			{
+				identifiers.push_back(quoted);
+			}
+
+			begin = message.find('\'', end + 1);
+		}
+
+		return identifiers;
+	}
+
+	/**
+	 * Determines whether a snippet of code contains an identifier as a whole word.
+	 *
+	 * @param code The snippet of code.
+	 * @param identifier The searched identifier.
+	 * @return True if the identifier is in the code, false otherwise.
+	 */
+	static bool ContainsIdentifier(const std::string& code, const std::string& identifier)
+	{
+		const auto isIdentifierCharacter = [](const char c)
+		{
+			return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+		};
+
+		for (auto position = code.find(identifier); position != std::string::npos; position = code.find(
+			     identifier, position + 1))
+		{
+			const auto end = position + identifier.size();
+
+			if ((position == 0 || !isIdentifierCharacter(code[position - 1])) && (end == code.size() || !
+				isIdentifierCharacter(code[end])))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 public:
 
 	/**
@@ -183,6 +355,35 @@ public:
 		it->second.push_back(parent);
 	}
 
+	/**
+	 * Adds a learned dependency edge between two nodes, i.e., an edge found by compiling a variant rather than
+	 * by analyzing the AST, see `LearnFromErrors`.\n
+	 * Unlike the other edges, learned edges are always enforced by `IsValid`, even without the heuristics.
+	 *
+	 * @param parent The traversal order number of the parent.
+	 * @param child The traversal order number of the child.
+	 * @return True if the edge is new, false otherwise.
+	 */
+	bool InsertLearnedDependency(const int parent, const int child)
+	{
+		if (parent == child)
+		{
+			return false;
+		}
+
+		auto& children = learnedEdges_[parent];
+
+		if (std::find(children.begin(), children.end(), child) != children.end())
+		{
+			// The dependency has already been learned.
+			return false;
+		}
+
+		children.push_back(child);
+
+		return true;
+	}
+
 	/**
 	 * Adds additional data for debugging and pretty printing.
 	 *
@@ -218,10 +419,41 @@ public:
 	}
 
 	/**
-	 * Prints the dependency graph node by node into the console.
+	 * Sets the lines of the source code that is removed together with a node.
+	 *
+	 * @param traversalOrderNumber The node number.
+	 * @param line The first line of the removed code.
+	 * @param lineBreaks The number of line breaks in the removed code.
+	 */
+	void SetNodeLocation(const int traversalOrderNumber, const size_t line, const size_t lineBreaks)
+	{
+		debugNodeData_[traversalOrderNumber].line = line;
+		debugNodeData_[traversalOrderNumber].lineBreaks = lineBreaks;
+	}
+
+	/**
+	 * Records the name of a function, type or variable declared by a node.
+	 *
+	 * @param traversalOrderNumber The node number.
+	 * @param name The declared name.
+	 */
+	void InsertDeclaredName(const int traversalOrderNumber, const std::string& name)
+	{
+		if (!name.empty())
+		{
+			debugNodeData_[traversalOrderNumber].declaredNames.push_back(name);
+		}
+	}
+
+	/**
+	 * Prints the dependency graph node by node into the console.\n
+	 * The graphs of translation units analyzed in parallel are printed by worker threads, each dump holds the lock
+	 * of the output streams.
 	 */
 	void PrintGraphForDebugging()
 	{
+		const auto lock = Out::Lock();
+
 		Out::Verb() << "===------------------- Dependency graph and its code --------------------===\n";
 
 		for (auto it = debugNodeData_.cbegin(); it != debugNodeData_.cend(); ++it)
@@ -289,6 +521,14 @@ public:
 			}
 		}
 
+		for (auto it = learnedEdges_.cbegin(); it != learnedEdges_.cend(); ++it)
+		{
+			for (auto child : it->second)
+			{
+				ofs << it->first << " -> " << child << " [color=darkgreen, style=dashed];\n";
+			}
+		}
+
 		ofs << "}\n";
 	}
 
@@ -316,6 +556,170 @@ public:
 		return GetDependentNodesFromContainer(startingNode, variableEdges_);
 	}
 
+	/**
+	 * Getter for the learned dependencies of a given node, see `InsertLearnedDependency`.
+	 *
+	 * @param startingNode The parent node.
+	 * @return A container of the direct children of the node.
+	 */
+	[[nodiscard]] const std::vector<int>& GetLearnedDependentNodes(const int startingNode) const
+	{
+		static const auto noDependencies = std::vector<int>();
+
+		const auto it = learnedEdges_.find(startingNode);
+
+		return it != learnedEdges_.end() ? it->second : noDependencies;
+	}
+
+	/**
+	 * Determines whether a variant keeps a node whose learned dependency is removed.\n
+	 * Such variants have already failed to compile for the same reason and need not be validated.
+	 *
+	 * @param bitMask The variant represented by a bit mask.
+	 * @return True if the variant violates a learned dependency, false otherwise.
+	 */
+	[[nodiscard]] bool ViolatesLearnedDependencies(const BitMask& bitMask) const
+	{
+		for (auto it = learnedEdges_.cbegin(); it != learnedEdges_.cend(); ++it)
+		{
+			if (it->first >= static_cast<int>(bitMask.size()) || bitMask[it->first])
+			{
+				continue;
+			}
+
+			for (auto child : it->second)
+			{
+				if (child < static_cast<int>(bitMask.size()) && bitMask[child])
+				{
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * Learns dependencies from the errors of a variant that could not be compiled.\n
+	 * Each error naming an identifier (e.g., "use of undeclared identifier 'x'") is mapped back to the original
+	 * file. If exactly one removed node declares the identifier, the innermost present node on the error's line
+	 * using the identifier is made dependent on it, so that no future variant keeps the usage without
+	 * the declaration. Errors that cannot be attributed this way are ignored.
+	 *
+	 * @param bitMask The variant represented by a bit mask.
+	 * @param errors The errors reported by the compiler for the variant.
+	 * @param descriptions If given, the new dependencies are also described for `RestoreLearnedDependencies`.
+	 * @return The number of new dependencies.
+	 */
+	int LearnFromErrors(const BitMask& bitMask, const std::vector<CompilationError>& errors,
+	                    std::vector<LearnedDependency>* descriptions = nullptr)
+	{
+		const auto present = GetPresentNodes(bitMask);
+		auto learned = 0;
+
+		for (const auto& error : errors)
+		{
+			const auto line = GetOriginalLine(bitMask, error.line);
+
+			for (const auto& identifier : GetQuotedIdentifiers(error.message))
+			{
+				auto declaringNode = -1;
+				auto declaringNodeCount = 0;
+				auto usingNode = -1;
+
+				for (size_t i = 0; i < present.size(); i++)
+				{
+					const auto& node = GetNodeInfo(static_cast<int>(i));
+
+					if (!present[i])
+					{
+						if (std::find(node.declaredNames.begin(), node.declaredNames.end(), identifier) != node.
+							declaredNames.end())
+						{
+							declaringNode = static_cast<int>(i);
+							declaringNodeCount++;
+						}
+					}
+					else if (node.line != 0 && node.line <= line && line <= node.line + node.lineBreaks &&
+						ContainsIdentifier(node.codeSnippet, identifier))
+					{
+						// Prefer the innermost node, i.e., the one spanning the fewest lines. Children precede their parents.
+						if (usingNode == -1 || node.lineBreaks < GetNodeInfo(usingNode).lineBreaks)
+						{
+							usingNode = static_cast<int>(i);
+						}
+					}
+				}
+
+				if (declaringNodeCount == 1 && usingNode != -1)
+				{
+					if (InsertLearnedDependency(declaringNode, usingNode))
+					{
+						Out::Verb() << "Learned a dependency of node " << usingNode << " on node " << declaringNode <<
+							" from: " << error.message << "\n";
+						learned++;
+
+						if (descriptions != nullptr)
+						{
+							descriptions->push_back({identifier, GetNodeInfo(usingNode).codeSnippet});
+						}
+					}
+
+					break;
+				}
+			}
+		}
+
+		return learned;
+	}
+
+	/**
+	 * Restores dependencies learned in the graph of a previous test case, e.g., of a previous Delta debugging
+	 * iteration, which numbers the nodes differently.\n
+	 * Each description is matched by the code - the only node declaring the identifier becomes the parent of each
+	 * node with the same code snippet. Descriptions whose nodes have been removed or are ambiguous are skipped.
+	 *
+	 * @param descriptions The dependencies described by `LearnFromErrors`.
+	 * @return The number of restored dependencies.
+	 */
+	int RestoreLearnedDependencies(const std::vector<LearnedDependency>& descriptions)
+	{
+		auto restored = 0;
+
+		for (const auto& description : descriptions)
+		{
+			auto declaringNode = -1;
+			auto declaringNodeCount = 0;
+			auto usingNodes = std::vector<int>();
+
+			for (const auto& [number, node] : debugNodeData_)
+			{
+				if (std::find(node.declaredNames.begin(), node.declaredNames.end(), description.identifier) != node.
+					declaredNames.end())
+				{
+					declaringNode = number;
+					declaringNodeCount++;
+				}
+				else if (node.codeSnippet == description.usingCode)
+				{
+					usingNodes.push_back(number);
+				}
+			}
+
+			if (declaringNodeCount != 1)
+			{
+				continue;
+			}
+
+			for (const auto usingNode : usingNodes)
+			{
+				restored += InsertLearnedDependency(declaringNode, usingNode) ? 1 : 0;
+			}
+		}
+
+		return restored;
+	}
+
 	/**
 	 * Searches in a BFS manner for all descendants of a given node.
 	 * This includes both statement and variable dependencies.\n
@@ -325,21 +729,224 @@ public:
 	 * @return A container of nodes (specified by their traversal order number) that are dependent on
 	 * the given node.
 	 */
-	std::vector<int> GetDependentNodes(const int startingNode)
+	const std::vector<int>& GetDependentNodes(const int startingNode)
 	{
-		if (dependentNodesCache_.find(startingNode) != dependentNodesCache_.end())
+		const auto it = dependentNodesCache_.find(startingNode);
+
+		if (it != dependentNodesCache_.end())
 		{
-			return dependentNodesCache_.find(startingNode)->second;
+			return it->second;
 		}
 
-		auto allDependencies = GetStatementDependentNodes(startingNode);
+		auto allDependencies = std::vector<int>();
+		GetDependentNodes(startingNode, allDependencies);
+
+		return dependentNodesCache_.emplace(startingNode, std::move(allDependencies)).first->second;
+	}
+
+	/**
+	 * A read-only variant of `GetDependentNodes`, which can be called from multiple threads at once.\n
+	 * The result is taken from the cache filled before, e.g., by `Prepare`, without being copied. Otherwise,
+	 * the descendants are searched for again and stored in the given buffer.
+	 *
+	 * @param startingNode The node whose descendants are considered.
+	 * @param buffer The container filled if the descendants are not cached. Its previous contents are discarded.
+	 * @return A container of nodes (specified by their traversal order number) that are dependent on
+	 * the given node. Either the cached one or the buffer.
+	 */
+	const std::vector<int>& GetDependentNodes(const int startingNode, std::vector<int>& buffer) const
+	{
+		const auto it = dependentNodesCache_.find(startingNode);
+
+		if (it != dependentNodesCache_.end())
+		{
+			return it->second;
+		}
+
+		buffer = GetStatementDependentNodes(startingNode);
 		auto varDependencies = GetVariableDependentNodes(startingNode);
-		allDependencies.insert(allDependencies.end(), std::make_move_iterator(varDependencies.begin()),
-		                       std::make_move_iterator(varDependencies.end()));
+		buffer.insert(buffer.end(), std::make_move_iterator(varDependencies.begin()),
+		              std::make_move_iterator(varDependencies.end()));
 
-		dependentNodesCache_.insert(std::pair<int, std::vector<int>>(startingNode, allDependencies));
+		return buffer;
+	}
 
-		return allDependencies;
+	/**
+	 * Computes the character counts and caches the descendants of all nodes, so that the graph can be shared
+	 * by multiple threads using only the read-only (const) methods.
+	 *
+	 * @param nodeCount The number of nodes (code units) in the graph.
+	 */
+	void Prepare(const int nodeCount)
+	{
+		GetTotalCharacterCount();
+
+		for (auto i = 0; i < nodeCount; i++)
+		{
+			GetDependentNodes(i);
+		}
+	}
+
+	/**
+	 * Determines the depth of each node in the statement hierarchy.\n
+	 * Nodes without a statement parent (e.g., top-level declarations) are in the depth of zero,
+	 * the depth of other nodes is one more than the depth of their shallowest parent.
+	 *
+	 * @param nodeCount The number of nodes (code units) in the graph.
+	 * @return The depth of each node, indexed by the traversal order number.
+	 */
+	[[nodiscard]] std::vector<int> GetStatementDepths(const int nodeCount) const
+	{
+		auto depths = std::vector<int>(nodeCount, -1);
+		auto nodeQ = std::queue<int>();
+
+		for (auto i = 0; i < nodeCount; i++)
+		{
+			if (statementInverseEdges_.find(i) == statementInverseEdges_.end())
+			{
+				depths[i] = 0;
+				nodeQ.push(i);
+			}
+		}
+
+		while (!nodeQ.empty())
+		{
+			const auto currentNode = nodeQ.front();
+			nodeQ.pop();
+
+			const auto it = statementEdges_.find(currentNode);
+
+			if (it == statementEdges_.end())
+			{
+				continue;
+			}
+
+			for (auto child : it->second)
+			{
+				if (child < nodeCount && depths[child] == -1)
+				{
+					depths[child] = depths[currentNode] + 1;
+					nodeQ.push(child);
+				}
+			}
+		}
+
+		// Nodes unreachable from the roots are treated as roots themselves.
+		std::replace(depths.begin(), depths.end(), -1, 0);
+
+		return depths;
+	}
+
+	/**
+	 * Searches for the top-level code units (e.g., functions and types) unreachable from the criterion,
+	 * which includes `main`.\n
+	 * A reachable node needs its whole statement subtree, its statement parents, and the declarations it uses
+	 * (the parents of its variable dependencies, e.g., called functions and used types). Each returned node can be
+	 * removed together with its subtree, it contains no reachable node and it is not contained in another returned
+	 * node (both determined by the lines of their code).
+	 *
+	 * @param nodeCount The number of nodes (code units) in the graph.
+	 * @return The traversal order numbers of the unreachable top-level nodes, empty if there is no criterion.
+	 */
+	[[nodiscard]] std::vector<int> GetUnreachableDeclarations(const int nodeCount) const
+	{
+		auto reachable = std::vector<bool>(nodeCount, false);
+		auto nodeQ = std::queue<int>();
+
+		const auto reach = [&reachable, &nodeQ, nodeCount](const int node)
+		{
+			if (node >= 0 && node < nodeCount && !reachable[node])
+			{
+				reachable[node] = true;
+				nodeQ.push(node);
+			}
+		};
+
+		for (auto node : criterion_)
+		{
+			reach(node);
+		}
+
+		if (nodeQ.empty())
+		{
+			return {};
+		}
+
+		while (!nodeQ.empty())
+		{
+			const auto currentNode = nodeQ.front();
+			nodeQ.pop();
+
+			for (const auto* container : {&statementEdges_, &statementInverseEdges_, &variableInverseEdges_})
+			{
+				const auto it = container->find(currentNode);
+
+				if (it != container->end())
+				{
+					for (auto node : it->second)
+					{
+						reach(node);
+					}
+				}
+			}
+		}
+
+		const auto contains = [this](const int outer, const int inner)
+		{
+			const auto& outerNode = GetNodeInfo(outer);
+			const auto& innerNode = GetNodeInfo(inner);
+
+			return outerNode.line <= innerNode.line && innerNode.line + innerNode.lineBreaks <= outerNode.line +
+				outerNode.lineBreaks;
+		};
+
+		auto candidates = std::vector<int>();
+
+		for (auto i = 0; i < nodeCount; i++)
+		{
+			if (reachable[i] || GetNodeInfo(i).line == 0 || statementInverseEdges_.find(i) !=
+				statementInverseEdges_.end())
+			{
+				continue;
+			}
+
+			// Nodes sharing the lines of a reachable node (e.g., a namespace) cannot be removed as a whole.
+			auto containsReachable = false;
+
+			for (auto j = 0; j < nodeCount && !containsReachable; j++)
+			{
+				containsReachable = reachable[j] && GetNodeInfo(j).line != 0 && contains(i, j);
+			}
+
+			if (!containsReachable)
+			{
+				candidates.push_back(i);
+			}
+		}
+
+		// The code of a nested candidate is removed together with its outer candidate, it must not be removed twice.
+		// Of candidates spanning the same lines, the one traversed last (the outermost one) is kept.
+		auto outermost = std::vector<int>();
+
+		for (auto candidate : candidates)
+		{
+			const auto nested = std::any_of(candidates.begin(), candidates.end(), [&](const int other)
+			{
+				if (other == candidate || !contains(other, candidate))
+				{
+					return false;
+				}
+
+				return !contains(candidate, other) || other > candidate;
+			});
+
+			if (!nested)
+			{
+				outermost.push_back(candidate);
+			}
+		}
+
+		return outermost;
 	}
 
 	/**
@@ -362,7 +969,7 @@ public:
 	 * @param node The node to be checked.
 	 * @return True if the node's location is the error-inducing file and line, false otherwise.
 	 */
-	bool IsInCriterion(const int node)
+	[[nodiscard]] bool IsInCriterion(const int node) const
 	{
 		return std::find(criterion_.begin(), criterion_.end(), node) != criterion_.end();
 	}
@@ -371,11 +978,15 @@ public:
 	 * Getter for the n-th node in the debug data container.
 	 *
 	 * @param node The traversal order number of the node.
-	 * @return The `Node` object for the node specified by the given number.
+	 * @return The `Node` object for the node specified by the given number, an empty node if there is none.
 	 */
-	Node GetNodeInfo(const int node)
+	[[nodiscard]] const Node& GetNodeInfo(const int node) const
 	{
-		return debugNodeData_[node];
+		static const auto emptyNode = Node();
+
+		const auto it = debugNodeData_.find(node);
+
+		return it != debugNodeData_.end() ? it->second : emptyNode;
 	}
 
 	/**
@@ -416,5 +1027,16 @@ public:
 
 		return totalCharacters_;
 	}
+
+	/**
+	 * A read-only variant of `GetTotalCharacterCount`, which can be called from multiple threads at once.\n
+	 * The count must have been calculated before by the non-const variant or by `Prepare`.
+	 *
+	 * @return The number of characters in all snippets summed.
+	 */
+	[[nodiscard]] int GetTotalCharacterCount() const
+	{
+		return totalCharacters_;
+	}
 };
 #endif
@@ -0,0 +1,89 @@
+#ifndef FORKSERVER_H
+#define FORKSERVER_H
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Execution
+{
+	/**
+	 * The file descriptors through which the fork server stub communicates with AutoPIE.
+	 */
+	constexpr int ControlDescriptor = 198;
+	constexpr int StatusDescriptor = 199;
+
+	/**
+	 * The outcome of a single run of the tested executable.
+	 */
+	struct ExecutionResult
+	{
+		bool timedOut{false};
+		int exitCode{0}; ///< The exit code of the process, valid if it has not been terminated by a signal.
+		int signal{0}; ///< The signal that terminated the process, zero if it exited.
+
+		/**
+		 * Set if the process crashed inside the executable itself (not inside a shared library).
+		 */
+		bool crashedInExecutable{false};
+
+		/**
+		 * The address of the crashing instruction relative to the load address of the executable.
+		 */
+		std::uint64_t crashOffset{0};
+	};
+
+	/**
+	 * Runs an executable repeatedly without paying for `execve`, the dynamic loading and the initialization
+	 * of the C library in each run (an AFL-style fork server).\n
+	 * The executable is started once with a preloaded stub, which stops it at the beginning of `main`.
+	 * For each run, the stub forks a fresh child from this snapshot, lets it continue into `main`
+	 * and reports how it terminated, including the address of the crashing instruction.\n
+	 * The executable is run in the `TempFolder` with the `--arguments`, the same way the LLDB launches it.
+	 * Only POSIX systems with the GNU C library are supported.
+	 */
+	class ForkServer
+	{
+		std::string executable_;
+		int pid_{-1};
+		int controlFd_{-1};
+		int statusFd_{-1};
+
+		void Stop();
+
+	public:
+		/**
+		 * Starts the executable and waits until the stub reports that it is ready.
+		 *
+		 * @param executable The path to the executable.
+		 */
+		explicit ForkServer(std::string executable);
+
+		~ForkServer();
+
+		// Rule of three.
+
+		ForkServer(const ForkServer& other) = delete;
+		ForkServer& operator=(const ForkServer& other) = delete;
+
+		[[nodiscard]] bool IsRunning() const
+		{
+			return pid_ > 0;
+		}
+
+		[[nodiscard]] const std::string& GetExecutable() const
+		{
+			return executable_;
+		}
+
+		std::optional<ExecutionResult> Run(const std::vector<std::string>& environment, int timeout);
+
+		static bool IsSupported();
+	};
+
+	std::string DescribeSignal(int signal);
+} // namespace Execution
+
+#endif
@@ -5,20 +5,32 @@
 #include <clang/Basic/SourceLocation.h>
 #include <clang/Basic/LangStandard.h>
 #include <clang/Lex/Lexer.h>
+#include <clang/Tooling/CommonOptionsParser.h>
+#include <clang/Tooling/Tooling.h>
 
 #include <lldb/lldb-enumerations.h>
 #include <lldb/API/SBDebugger.h>
 #include <lldb/API/SBEvent.h>
 
 #include <filesystem>
+#include <optional>
 #include <utility>
 
+#include "BitMaskBin.h"
+
 /**
  * Path to the temporary directory into which source file variants and executables are generated.\n
  * This path is cleared on each invocation.
  */
 inline const char* TempFolder = "./temp/";
 
+/**
+ * Path to the directory into which the ASTs of the input files are serialized, so that the stages run by the `autopie`
+ * driver over an unchanged file share them.\n
+ * This path is cleared once per invocation, before it is first used.
+ */
+inline const char* SharedASTFolder = "./asts/";
+
 /**
  * Path to the GraphViz output directory into which `.dot` files are generated.
  * This path is NOT cleared on each invocation.
@@ -30,20 +42,62 @@ inline const char* VisualsFolder = "./visuals/";
  */
 inline const char* LogFile = "./autopie.log";
 
+/**
+ * The environment variable from which the executable of a mutant schema reads the bit mask of the variant
+ * that should be run, e.g., `AUTOPIE_MASK=1101`. Nodes beyond the end of the bit mask are kept.
+ */
+inline const char* SchemaMaskVariable = "AUTOPIE_MASK";
+
 enum class DeltaIterationResults
 {
 	FailingPartition,
 	FailingComplement,
 	Unsplitable,
+	LevelMinimized,
+	Pruned,
 	Passing
 };
 
+/**
+ * The algorithms available for the reduction in DeltaReduction.
+ */
+enum class ReductionStrategy
+{
+	DDMin, ///< Minimizing Delta debugging over the flat list of code units.
+	HDD, ///< Hierarchical Delta debugging, minimizes the statement tree level by level.
+	ProbDD ///< Probabilistic Delta debugging, learns the probability of each code unit being necessary.
+};
+
+/**
+ * The backends available for running the executables of the validated variants.
+ */
+enum class ExecutionBackend
+{
+	LLDB, ///< Each executable is launched in the LLDB debugger.
+	ForkServer, ///< Each run is forked from an instance of the executable stopped at `main`, see `Execution::ForkServer`.
+	JIT ///< Each variant is compiled in-process and run in the ORC JIT, see `Execution::RunInJit`.
+};
+
+/**
+ * The sets of options used for compiling the validated variants.
+ */
+enum class CompileProfile
+{
+	Default, ///< Full debug information, the system linker, the driver plans each compilation anew.
+	Fast ///< Line tables only, the LLD linker, the planned compilation jobs are reused for each variant.
+};
+
 class GlobalContext;
 struct Statistics;
 class DependencyGraph;
 
-using BitMask = std::vector<bool>;
-using EpochRanges = std::map<double, std::vector<BitMask>>;
+namespace clang::tooling
+{
+	class ClangTool;
+	struct CompileCommand;
+}
+
+void StopForkServer();
 
 //===----------------------------------------------------------------------===//
 //
@@ -52,30 +106,43 @@ using EpochRanges = std::map<double, std::vector<BitMask>>;
 //===----------------------------------------------------------------------===//
 
 /**
- * Guards the LLDB module, destroying it upon exiting the scope.
+ * Guards the LLDB module, destroying it upon exiting the scope.\n
+ * Sentries may be nested, e.g., a stage run by the `autopie` driver inside the driver's own sentry.
+ * Only the outermost sentry initializes and destroys the debugger so that it is not cold-started by every stage.
  */
 struct LLDBSentry
 {
 	/**
-	 * Initializes the LLDB debugger.
+	 * Initializes the LLDB debugger unless it is already guarded by another sentry.
 	 */
 	LLDBSentry()
 	{
-		lldb::SBDebugger::Initialize();
+		if (activeSentries_++ == 0)
+		{
+			lldb::SBDebugger::Initialize();
+		}
 	}
 
 	/**
-	 * Destroys the LLDB debugger.
+	 * Destroys the LLDB debugger if this is the last living sentry.
 	 */
 	~LLDBSentry()
 	{
-		lldb::SBDebugger::Terminate();
+		if (--activeSentries_ == 0)
+		{
+			// The fork server keeps an LLDB target for mapping crashes to source lines.
+			StopForkServer();
+			lldb::SBDebugger::Terminate();
+		}
 	}
 
 	// Rule of three.
 
 	LLDBSentry(const LLDBSentry& other) = delete;
 	LLDBSentry& operator=(const LLDBSentry& other) = delete;
+
+private:
+	static inline int activeSentries_ = 0;
 };
 
 //===----------------------------------------------------------------------===//
@@ -117,6 +184,25 @@ struct InputData
 	}
 };
 
+/**
+ * An error reported by the compiler for a validated variant, see `DependencyGraph::LearnFromErrors`.
+ */
+struct CompilationError
+{
+	size_t line{0}; ///< The line of the error in the variant.
+	std::string message;
+};
+
+/**
+ * A dependency learned by `DependencyGraph::LearnFromErrors`, described by the code rather than by the traversal
+ * order, so that it can be restored in the graph of a later test case.
+ */
+struct LearnedDependency
+{
+	std::string identifier; ///< The name declared by the parent node and used by the child node.
+	std::string usingCode; ///< The code snippet of the child node.
+};
+
 //===----------------------------------------------------------------------===//
 //
 /// Source range helper functions.
@@ -145,6 +231,17 @@ std::string GetFileName(const std::string& filePath);
 
 std::string EscapeQuotes(const std::string& text);
 
+std::vector<std::string> SplitToWords(const std::string& s, char delimiter);
+
+std::optional<clang::tooling::CommonOptionsParser> ParseCommandLine(int argc, const char** argv);
+
+clang::Language DetermineInputLanguage(clang::tooling::ClangTool& tool,
+                                       const clang::tooling::CompilationDatabase& compilations,
+                                       const std::string& filePath);
+
+int RunOnSharedAST(clang::tooling::ClangTool& tool, const clang::tooling::CompilationDatabase& compilations,
+                   const std::string& filePath, clang::tooling::FrontendActionFactory* factory);
+
 //===----------------------------------------------------------------------===//
 //
 /// BitMask helper functions.
@@ -161,7 +258,25 @@ void InitializeBitMask(BitMask& bitMask, size_t number);
 
 void MergeVectorMaps(EpochRanges& from, EpochRanges& to);
 
-std::pair<bool, double> IsValid(const BitMask& bitMask, DependencyGraph& dependencies, bool = true);
+std::pair<bool, double> IsValid(const BitMask& bitMask, const DependencyGraph& dependencies, bool = true);
+
+/**
+ * The dependency graph of at most `MaxEncodedBitMaskSize` code units encoded in bit masks.\n
+ * Allows the validation of encoded bit masks without decoding them, see `IsValid`.
+ */
+struct EncodedDependencies
+{
+	size_t nodeCount{0};
+	EncodedBitMask criterion{0}; ///< The bits of the nodes on the error-inducing location.
+	std::vector<EncodedBitMask> dependentNodes; ///< The bits of the descendants of each node.
+	std::vector<EncodedBitMask> learnedNodes; ///< The bits of the learned dependencies of each node.
+	std::vector<int> characterCounts;
+	int totalCharacters{0};
+
+	EncodedDependencies(const DependencyGraph& dependencies, size_t nodeCount);
+};
+
+std::pair<bool, double> IsValid(EncodedBitMask bitMask, const EncodedDependencies& dependencies, bool = true);
 
 //===----------------------------------------------------------------------===//
 //
@@ -169,15 +284,35 @@ std::pair<bool, double> IsValid(const BitMask& bitMask, DependencyGraph& depende
 //
 //===----------------------------------------------------------------------===//
 
-int Compile(const std::filesystem::directory_entry& entry, clang::Language language);
+const char* GetDebugInfoFlag();
+
+int Compile(const std::filesystem::directory_entry& entry, clang::Language language,
+            std::vector<CompilationError>* errors = nullptr);
+
+int CompileToObject(const std::string& input, const std::string& output, clang::Language language,
+                    const std::vector<std::string>& flags);
+
+int LinkObjects(const std::vector<std::string>& objects, const std::string& output, clang::Language language,
+                const std::vector<std::string>& flags);
+
+int CompileProject(GlobalContext& globalContext, const std::filesystem::directory_entry& entry);
+
+int CompileSharedLibrary(const std::string& input, const std::string& output);
+
+std::vector<std::string> GetStandaloneCompileFlags(const clang::tooling::CompileCommand& command);
 
 bool ValidateVariant(GlobalContext& globalContext, const std::filesystem::directory_entry& entry);
 
+bool ValidateSchemaVariant(const std::string& executable, const BitMask& bitMask,
+                           const std::vector<size_t>& errorLines);
+
 void DisplayStats(Statistics& stats);
 
 void PrintResult(const std::string& filePath);
 
-bool ValidateResults(GlobalContext& context);
+bool ValidateResults(GlobalContext& context, DependencyGraph* dependencies = nullptr);
+
+void StoreResult(GlobalContext& context, const std::string& filePath);
 
 bool CheckLocationValidity(const std::string& filePath, size_t lineNumber, bool force = true);
 
@@ -189,4 +324,16 @@ std::string LanguageToString(clang::Language lang);
 
 std::string LanguageToExtension(clang::Language lang);
 
+//===----------------------------------------------------------------------===//
+//
+/// Checkpoint helper functions.
+//
+//===----------------------------------------------------------------------===//
+
+bool LoadCheckpoint(GlobalContext& context, const std::string& tool);
+
+void SaveCheckpoint(GlobalContext& context, const std::string& tool, bool force = false);
+
+void RemoveCheckpoint();
+
 #endif
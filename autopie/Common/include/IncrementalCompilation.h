@@ -0,0 +1,23 @@
+#ifndef INCREMENTALCOMPILATION_H
+#define INCREMENTALCOMPILATION_H
+#pragma once
+
+#include <clang/Basic/LangStandard.h>
+
+#include <optional>
+#include <string>
+
+/**
+ * Path to the directory into which the compilation units and the object files of the incremental compilation
+ * are generated.\n
+ * This path is cleared once per invocation, before it is first used.
+ */
+inline const char* ObjectCacheFolder = "./objects/";
+
+namespace Incremental
+{
+	std::optional<int> CompileIncrementally(const std::string& input, const std::string& output,
+	                                        clang::Language language);
+} // namespace Incremental
+
+#endif
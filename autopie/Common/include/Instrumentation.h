@@ -0,0 +1,239 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Contains the phase timers and counters describing where the time of a reduction goes.\n
+ * Phases are hierarchical - a phase started while another one is running on the same thread is recorded
+ * under the path of its parent, e.g., `validation/compile/link`.
+ */
+namespace Instrumentation
+{
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * The accumulated duration and the number of runs of a single phase.
+	 */
+	struct PhaseRecord
+	{
+		double seconds{0};
+		size_t count{0};
+	};
+
+	/**
+	 * A single run of a phase, kept for the Chrome trace-event output.
+	 */
+	struct TraceEvent
+	{
+		std::string name;
+		long long startInMicroseconds{0};
+		long long durationInMicroseconds{0};
+		size_t thread{0};
+	};
+
+	/**
+	 * Collects the phases and counters of all threads.\n
+	 * It is expected that the user does not create additional instances, `GetRecorder` should be used instead.
+	 */
+	class Recorder
+	{
+		mutable std::mutex mutex_;
+		Clock::time_point origin_ = Clock::now();
+		std::map<std::string, PhaseRecord> phases_;
+		std::map<std::string, size_t> counters_;
+		std::map<std::thread::id, size_t> threads_;
+		std::vector<TraceEvent> events_;
+		bool tracing_{false};
+
+	public:
+
+		/**
+		 * Discards all records, the time of the following phases is measured from now on.
+		 *
+		 * @param tracing Specifies whether each run of each phase should be kept for the trace output.
+		 */
+		void Reset(const bool tracing)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			origin_ = Clock::now();
+			phases_.clear();
+			counters_.clear();
+			threads_.clear();
+			events_.clear();
+			tracing_ = tracing;
+		}
+
+		void AddPhase(const std::string& path, const Clock::time_point start, const Clock::time_point end)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			auto& phase = phases_[path];
+			phase.seconds += std::chrono::duration<double>(end - start).count();
+			phase.count++;
+
+			if (tracing_)
+			{
+				// Chrome expects small thread numbers, number the threads in the order of their first phase.
+				const auto thread = threads_.emplace(std::this_thread::get_id(), threads_.size()).first->second;
+
+				events_.push_back(TraceEvent{
+					path, std::chrono::duration_cast<std::chrono::microseconds>(start - origin_).count(),
+					std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), thread
+				});
+			}
+		}
+
+		void Increment(const std::string& counter, const size_t amount)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			counters_[counter] += amount;
+		}
+
+		[[nodiscard]] std::map<std::string, PhaseRecord> GetPhases() const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			return phases_;
+		}
+
+		[[nodiscard]] std::map<std::string, size_t> GetCounters() const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			return counters_;
+		}
+
+		[[nodiscard]] std::vector<TraceEvent> GetEvents() const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			return events_;
+		}
+
+		/**
+		 * Getter for the time elapsed since the last reset.
+		 *
+		 * @return The wall time of the current run in seconds.
+		 */
+		[[nodiscard]] double GetElapsedSeconds() const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			return std::chrono::duration<double>(Clock::now() - origin_).count();
+		}
+	};
+
+	/**
+	 * Retrieves the recorder shared by all threads of the process.
+	 *
+	 * @return The process-wide recorder.
+	 */
+	inline Recorder& GetRecorder()
+	{
+		static Recorder recorder;
+
+		return recorder;
+	}
+
+	/**
+	 * The paths of the phases that are currently running on this thread, the innermost one being the last.
+	 */
+	inline thread_local std::vector<std::string> activePhases;
+
+	/**
+	 * Creates the path of a phase started on this thread.
+	 *
+	 * @param name The name of the phase.
+	 * @return The name prefixed by the path of the innermost running phase.
+	 */
+	inline std::string GetPhasePath(const std::string& name)
+	{
+		return activePhases.empty() ? name : activePhases.back() + "/" + name;
+	}
+
+	/**
+	 * Records a phase whose start and end have been measured elsewhere, e.g., across callbacks.
+	 *
+	 * @param name The name of the phase, it is placed under the innermost running phase of this thread.
+	 * @param start The point in time at which the phase started.
+	 * @param end The point in time at which the phase ended.
+	 */
+	inline void RecordPhase(const std::string& name, const Clock::time_point start, const Clock::time_point end)
+	{
+		GetRecorder().AddPhase(GetPhasePath(name), start, end);
+	}
+
+	/**
+	 * Adds a given amount to a named counter.
+	 *
+	 * @param counter The name of the counter, e.g., `rejected/compilation`.
+	 * @param amount The amount to be added.
+	 */
+	inline void Count(const std::string& counter, const size_t amount = 1)
+	{
+		GetRecorder().Increment(counter, amount);
+	}
+
+	/**
+	 * Measures a phase from its construction until its destruction (or until `Stop` is called).\n
+	 * Usage: `Instrumentation::ScopedPhase phase("compile");`
+	 */
+	class ScopedPhase
+	{
+		std::string path_;
+		Clock::time_point start_;
+		bool running_{true};
+
+	public:
+		explicit ScopedPhase(const std::string& name) : path_(GetPhasePath(name)), start_(Clock::now())
+		{
+			activePhases.push_back(path_);
+		}
+
+		~ScopedPhase()
+		{
+			Stop();
+		}
+
+		// Rule of three.
+
+		ScopedPhase(const ScopedPhase& other) = delete;
+		ScopedPhase& operator=(const ScopedPhase& other) = delete;
+
+		/**
+		 * Ends the phase before the end of its scope. Further calls have no effect.\n
+		 * The phase may be stopped before the phases started inside it, its own entry is removed
+		 * from the running phases.
+		 */
+		void Stop()
+		{
+			if (!running_)
+			{
+				return;
+			}
+
+			running_ = false;
+			GetRecorder().AddPhase(path_, start_, Clock::now());
+
+			const auto entry = std::find(activePhases.rbegin(), activePhases.rend(), path_);
+
+			if (entry != activePhases.rend())
+			{
+				activePhases.erase(std::next(entry).base());
+			}
+		}
+	};
+} // namespace Instrumentation
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef JITEXECUTOR_H
+#define JITEXECUTOR_H
+#pragma once
+
+#include <clang/Basic/LangStandard.h>
+
+#include <string>
+#include <vector>
+
+#include "ForkServer.h"
+
+struct CompilationError;
+
+namespace Execution
+{
+	/**
+	 * The outcome of a variant compiled and run by `RunInJit`.
+	 */
+	struct JitResult
+	{
+		bool compiled{false}; ///< Set if the variant has been compiled into LLVM IR.
+		ExecutionResult execution;
+		size_t crashLine{0}; ///< The line of the crashing instruction, zero if it is unknown.
+		std::string crashFile; ///< The name of the file containing the crashing instruction.
+		std::string failure; ///< Why the variant could not be run, empty unless the JIT itself has failed.
+	};
+
+	/**
+	 * The lines of a source file executed by a run traced by `TraceInJit`.
+	 */
+	struct JitTrace
+	{
+		JitResult run;
+		bool reachedStopLine{false}; ///< Set if the stop line has been executed at least once.
+		std::vector<size_t> codeLines; ///< The sorted lines with any code, only those can be executed.
+		std::vector<size_t> executedLines; ///< The sorted lines executed before the last execution of the stop line.
+	};
+
+	JitResult RunInJit(const std::string& sourceFile, clang::Language language, int timeout,
+	                   std::vector<CompilationError>* errors = nullptr);
+
+	JitTrace TraceInJit(const std::string& sourceFile, clang::Language language, int timeout, size_t stopLine);
+} // namespace Execution
+
+#endif
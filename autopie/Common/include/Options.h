@@ -135,4 +135,217 @@ inline llvm::cl::opt<std::string> SliceFile("slice-file",
                                             llvm::cl::value_desc("filename"),
                                             llvm::cl::cat(AutoPieArgs));
 
+/**
+ * If set to true, all translation units of the compilation database (given by the `-p` option) are reduced jointly.\n
+ * Project mode is also used whenever multiple source paths are given on the command line.
+ */
+inline llvm::cl::opt<bool> ProjectMode("project",
+                                       llvm::cl::desc(
+	                                       "[DeltaReduction] Reduces all translation units of the compilation database (see -p) jointly."),
+                                       llvm::cl::init(false),
+                                       llvm::cl::value_desc("bool"),
+                                       llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies the translation unit in which the error occurred when reducing a whole project.\n
+ * If empty, the first source path given on the command line is used.
+ */
+inline llvm::cl::opt<std::string> LocationFile("loc-file",
+                                               llvm::cl::desc(
+	                                               "[DeltaReduction] The source file in which the error occurred (project mode only)."),
+                                               llvm::cl::init(""),
+                                               llvm::cl::value_desc("filename"),
+                                               llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Additional flags passed to the linker when the object files of a project are linked together.\n
+ * The flags are separated by spaces, e.g., "-lm -lpthread".
+ */
+inline llvm::cl::opt<std::string> LinkFlags("link-flags",
+                                            llvm::cl::desc(
+	                                            "[DeltaReduction] Additional flags used when linking the translation units of a project."),
+                                            llvm::cl::init(""),
+                                            llvm::cl::value_desc("string"),
+                                            llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies the path of a JSON report containing the statistics of the reduction, its phase timers and counters.\n
+ * No report is written if the path is empty.
+ */
+inline llvm::cl::opt<std::string> StatsFile("stats-file",
+                                            llvm::cl::desc(
+	                                            "[NaiveReduction, DeltaReduction] The name of the file to which a JSON report of the run's statistics should be written."),
+                                            llvm::cl::init(""),
+                                            llvm::cl::value_desc("filename"),
+                                            llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies the path of a file to which each run of each phase is written in the Chrome trace-event format.\n
+ * The file can be opened in `chrome://tracing` or Perfetto. No trace is recorded if the path is empty.
+ */
+inline llvm::cl::opt<std::string> TraceFile("trace-file",
+                                            llvm::cl::desc(
+	                                            "[NaiveReduction, DeltaReduction] The name of the file to which a Chrome trace of the run's phases should be written."),
+                                            llvm::cl::init(""),
+                                            llvm::cl::value_desc("filename"),
+                                            llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies the algorithm used by DeltaReduction.\n
+ * The flat ddmin splits all code units into contiguous ranges, HDD minimizes top-level declarations first,
+ * then the statements inside the surviving ones, and so on. ProbDD removes the code units that are the least likely
+ * to be necessary, the likelihood is learned from the previous tests.
+ */
+inline llvm::cl::opt<ReductionStrategy> Strategy("strategy",
+                                                 llvm::cl::desc(
+	                                                 "[DeltaReduction] The reduction algorithm to be used."),
+                                                 llvm::cl::values(
+	                                                 clEnumValN(ReductionStrategy::DDMin, "ddmin",
+	                                                            "Minimizing Delta debugging over all code units."),
+	                                                 clEnumValN(ReductionStrategy::HDD, "hdd",
+	                                                            "Hierarchical Delta debugging over the statement tree."),
+	                                                 clEnumValN(ReductionStrategy::ProbDD, "probdd",
+	                                                            "Probabilistic Delta debugging with learned probabilities of code units.")),
+                                                 llvm::cl::init(ReductionStrategy::DDMin),
+                                                 llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies how the executables of the validated variants are run.\n
+ * The fork server starts each executable once and forks every further run (e.g., each variant of the mutant schema)
+ * from a copy stopped at `main`, skipping `execve`, the dynamic loading and the debugger. Crash locations are still
+ * mapped to source lines using the LLDB. If the server cannot be started, the LLDB is used.\n
+ * The JIT compiles each variant into LLVM IR in-process and runs its `main` in a forked child, skipping the link step
+ * and the executable on the disk. Projects and the mutant schema are run using the LLDB instead.
+ */
+inline llvm::cl::opt<ExecutionBackend> Executor("executor",
+                                                llvm::cl::desc(
+	                                                "[NaiveReduction, DeltaReduction] The backend used for running the validated variants."),
+                                                llvm::cl::values(
+	                                                clEnumValN(ExecutionBackend::LLDB, "lldb",
+	                                                           "Launch each executable in the LLDB debugger."),
+	                                                clEnumValN(ExecutionBackend::ForkServer, "fork-server",
+	                                                           "Fork each run from a copy of the executable stopped at main (Linux only)."),
+	                                                clEnumValN(ExecutionBackend::JIT, "jit",
+	                                                           "Compile each variant in-process and run it in the ORC JIT without linking (Linux only).")),
+                                                llvm::cl::init(ExecutionBackend::LLDB),
+                                                llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies the options used for compiling the validated variants.\n
+ * The oracle only needs to map the error location to a line, so the fast profile emits line tables instead of
+ * full debug information and links using LLD (if installed). The commands planned by the driver for the first
+ * variant are reused for the following ones, skipping the detection of the toolchain and its include directories.
+ */
+inline llvm::cl::opt<CompileProfile> CompilationProfile("compile-profile",
+                                                        llvm::cl::desc(
+	                                                        "[NaiveReduction, DeltaReduction] The options used for compiling the variants."),
+                                                        llvm::cl::values(
+	                                                        clEnumValN(CompileProfile::Default, "default",
+	                                                                   "Full debug information and the system linker."),
+	                                                        clEnumValN(CompileProfile::Fast, "fast",
+	                                                                   "Line tables only, the LLD linker, and reused compilation jobs.")),
+                                                        llvm::cl::init(CompileProfile::Default),
+                                                        llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies the number of worker threads shared by all parallel stages (binning, parsing, compilation).\n
+ * The value of zero uses one worker per hardware thread.
+ */
+inline llvm::cl::opt<unsigned> Jobs("jobs",
+                                    llvm::cl::desc(
+	                                    "[NaiveReduction, DeltaReduction] The number of worker threads. All hardware threads are used by default."),
+                                    llvm::cl::init(0),
+                                    llvm::cl::value_desc("count"),
+                                    llvm::cl::cat(AutoPieArgs));
+
+inline llvm::cl::alias JobsAlias("j",
+                                 llvm::cl::desc("The number of worker threads."),
+                                 llvm::cl::aliasopt(Jobs));
+
+/**
+ * Specifies the amount of memory (in MiB) the bins of NaiveReduction may occupy.\n
+ * Bins exceeding their share are spilled to memory-mapped files in the `SpillFolder`. The value of zero means no limit.
+ * Limits too small to leave each bin `Naive::MinimalSpillSize` bit masks are rejected.
+ */
+inline llvm::cl::opt<unsigned> MaxMemory("max-memory",
+                                         llvm::cl::desc(
+	                                         "[NaiveReduction] The amount of memory (in MiB) the bins of variants may occupy before they are spilled to the disk. Unlimited by default."),
+                                         llvm::cl::init(0),
+                                         llvm::cl::value_desc("MiB"),
+                                         llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Continues an interrupted reduction from the state saved in the `--checkpoint-file`.\n
+ * The temporary directory is not cleared by DeltaReduction, since it holds the saved test cases.
+ */
+inline llvm::cl::opt<bool> Resume("resume",
+                                  llvm::cl::desc(
+	                                  "[NaiveReduction, DeltaReduction] Continue the reduction from the last checkpoint."),
+                                  llvm::cl::init(false),
+                                  llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies the path of the file to which the state of the reduction is periodically saved.\n
+ * No checkpoints are written unless a path is given. The file is removed once the reduction finishes.
+ */
+inline llvm::cl::opt<std::string> CheckpointFile("checkpoint-file",
+                                                 llvm::cl::desc(
+	                                                 "[NaiveReduction, DeltaReduction] The name of the file to which the state of the reduction should be saved. No checkpoints are saved by default."),
+                                                 llvm::cl::init(""),
+                                                 llvm::cl::value_desc("filename"),
+                                                 llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Specifies the minimal time (in seconds) between two checkpoints.\n
+ * The state is saved between iterations (validations), the value of zero saves it after each of them.
+ */
+inline llvm::cl::opt<unsigned> CheckpointInterval("checkpoint-interval",
+                                                  llvm::cl::desc(
+	                                                  "[NaiveReduction, DeltaReduction] The minimal number of seconds between two checkpoints."),
+                                                  llvm::cl::init(60),
+                                                  llvm::cl::value_desc("seconds"),
+                                                  llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Validates the variants of NaiveReduction using a mutant schema - a single executable in which each removable
+ * statement is guarded by a runtime switch. Each variant is run by setting the switches, without being printed,
+ * compiled and linked. Variants removing nodes that cannot be guarded, as well as the found result, are validated
+ * in the usual way.
+ */
+inline llvm::cl::opt<bool> MutantSchema("mutant-schema",
+                                        llvm::cl::desc(
+	                                        "[NaiveReduction] Validate the variants by running a single instrumented executable."),
+                                        llvm::cl::init(false),
+                                        llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Compiles each variant function by function, so that only the functions changed by the variant are compiled again.\n
+ * The object files of the unchanged functions are reused from the `ObjectCacheFolder` and all of them are linked together.
+ */
+inline llvm::cl::opt<bool> IncrementalCompilation("incremental-compilation",
+                                                  llvm::cl::desc(
+	                                                  "[NaiveReduction, DeltaReduction] Compile the variants function by function, reusing the objects of unchanged functions."),
+                                                  llvm::cl::init(false),
+                                                  llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Learns dependencies between code units from the errors of the variants that could not be compiled.\n
+ * Variants violating a learned dependency are not validated, see `DependencyGraph::LearnFromErrors`.
+ */
+inline llvm::cl::opt<bool> LearnDependencies("learn-dependencies",
+                                             llvm::cl::desc(
+	                                             "[NaiveReduction, DeltaReduction] Skip the variants that would fail to compile for the same reason as an already validated one."),
+                                             llvm::cl::init(false),
+                                             llvm::cl::cat(AutoPieArgs));
+
+/**
+ * Before the first iteration, tries removing all top-level declarations that are unreachable from the criterion
+ * in a single step, see `DependencyGraph::GetUnreachableDeclarations`.
+ */
+inline llvm::cl::opt<bool> PruneUnreachable("prune-unreachable",
+                                            llvm::cl::desc(
+	                                            "[DeltaReduction] Remove the declarations unreachable from the criterion before the first iteration."),
+                                            llvm::cl::init(false),
+                                            llvm::cl::cat(AutoPieArgs));
+
 #endif
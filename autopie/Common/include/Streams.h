@@ -2,232 +2,466 @@
 #define STREAMS_H
 #pragma once
 
+#include <algorithm>
 #include <chrono>
-#include <iostream>
+#include <condition_variable>
+#include <ctime>
 #include <fstream>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
 
 #include "Options.h"
 
 /**
  * Contains members for outputting messages in a custom manner.\n
- * The goal is to provide multiple logging levels with different levels of details.
+ * The goal is to provide multiple logging levels with different levels of details.\n
+ * Messages are formatted into a buffer of the writing thread and handed over to a background thread once
+ * a line is complete. Lines written by different threads are therefore never interleaved.
  */
 namespace Out
 {
 	typedef std::ostream& (*Manipulator)(std::ostream&);
 
 	/**
-	 * Retrieves the current time (Greenwich Mean Time).
+	 * The amount of queued text (in bytes) after which the writing threads wait for the flusher to catch up.
+	 */
+	constexpr size_t MaxQueuedBytes = 1 << 20;
+
+	/**
+	 * Formats the current time (Greenwich Mean Time) for the log file entries.\n
+	 * The result is cached by each thread and formatted again only when the second changes.
 	 *
-	 * @return Current GMT represented by the `tm` structure.
+	 * @return Current GMT in the `%Y-%m-%d %H:%M:%S` format.
 	 */
-	static tm* GetTimestamp()
+	inline const std::string& GetTimestamp()
 	{
+		thread_local std::time_t cachedTime = -1;
+		thread_local std::string cachedTimestamp;
+
 		const auto timeStamp = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 
-		return std::gmtime(&timeStamp);
+		if (timeStamp != cachedTime)
+		{
+			tm parts{};
+
+#ifdef _WIN32
+			gmtime_s(&parts, &timeStamp);
+#else
+			gmtime_r(&timeStamp, &parts);
+#endif
+
+			char buffer[32];
+			std::strftime(buffer, sizeof buffer, "%Y-%m-%d %H:%M:%S", &parts);
+
+			cachedTime = timeStamp;
+			cachedTimestamp = buffer;
+		}
+
+		return cachedTimestamp;
 	}
 
 	/**
-	 * Represent an ordinary output stream - one that outputs messages without any constraints.\n
-	 * It is expected that the user does not create additional instances. Instead, instantiated members
-	 * of this namespace should be used.
+	 * Writes the queued text to the standard output and to the log file on a background thread.\n
+	 * The thread is started by the first write, the log file is opened by the first write that requires it.\n
+	 * It is expected that the user does not create additional instances, `GetSink` should be used instead.
 	 */
-	struct Logger
+	class AsyncSink
 	{
-		bool initialized = false;
-		std::ofstream ofs;
+		std::mutex mutex_;
+		std::condition_variable queued_;
+		std::condition_variable written_;
+		std::string consoleQueue_;
+		std::string fileQueue_;
+		size_t enqueuedChunks_ = 0;
+		size_t writtenChunks_ = 0;
+		bool stopping_ = false;
+		std::thread flusher_;
+		std::ofstream ofs_;
+		bool fileOpened_ = false;
+
+		/**
+		 * Opens the log file on the first use.
+		 *
+		 * @return True if the file is ready for writing, false otherwise.
+		 */
+		bool OpenLogFile()
+		{
+			if (!fileOpened_)
+			{
+				fileOpened_ = true;
+				ofs_.open(LogFile);
 
-		explicit Logger(const char* filePath)
+				if (!ofs_)
+				{
+					std::cerr << "The log file could not be initialized. "
+						<< "If you are using the `--log` option, no output will be logged.\n";
+				}
+			}
+
+			return ofs_.is_open();
+		}
+
+		/**
+		 * The body of the flusher - writes the queued text until the sink is destroyed.
+		 */
+		void Work()
 		{
-			try
+			std::string consoleText;
+			std::string fileText;
+
+			while (true)
 			{
-				if (LogToFile)
+				size_t chunks;
+
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					queued_.wait(lock, [this]()
+					{
+						return stopping_ || enqueuedChunks_ != writtenChunks_;
+					});
+
+					if (stopping_ && enqueuedChunks_ == writtenChunks_)
+					{
+						return;
+					}
+
+					consoleText.swap(consoleQueue_);
+					fileText.swap(fileQueue_);
+					chunks = enqueuedChunks_;
+				}
+
+				// Only the flusher touches the streams, no lock is held while writing.
+				std::cout.write(consoleText.data(), consoleText.size());
+				std::cout.flush();
+
+				if (!fileText.empty() && OpenLogFile())
 				{
-					ofs.open(filePath);
-					initialized = true;
+					ofs_.write(fileText.data(), fileText.size());
+					ofs_.flush();
 				}
+
+				consoleText.clear();
+				fileText.clear();
+
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					writtenChunks_ = chunks;
+				}
+
+				written_.notify_all();
 			}
-			catch (std::ios_base::failure& e)
+		}
+
+	public:
+		AsyncSink() = default;
+
+		/**
+		 * Writes the remaining text and joins the flusher.
+		 */
+		~AsyncSink()
+		{
 			{
-				std::cerr << "The log file could not be initialized."
-					<< "If you are using the `--log` option, no output will be logged.\n"
-					<< "Error: " << e.what() << "\n";
+				std::lock_guard<std::mutex> lock(mutex_);
+				stopping_ = true;
+			}
 
-				initialized = false;
+			queued_.notify_all();
+
+			if (flusher_.joinable())
+			{
+				flusher_.join();
 			}
 		}
-	};
 
-	/**
-	 * Represent a constrained output stream.\n
-	 * It is expected that the user does not create additional instances. Instead, instantiated members
-	 * of this namespace should be used.
-	 */
-	struct FilteredLogger
-	{
-		Logger& logger;
+		// Rule of three.
+
+		AsyncSink(const AsyncSink& other) = delete;
+		AsyncSink& operator=(const AsyncSink& other) = delete;
 
-		explicit FilteredLogger(Logger& logger) : logger(logger)
+		/**
+		 * Queues complete lines for writing.
+		 *
+		 * @param consoleText The text for the standard output.
+		 * @param fileText The text for the log file, empty if the file is not used.
+		 */
+		void Enqueue(const std::string& consoleText, const std::string& fileText)
 		{
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+
+				if (!flusher_.joinable())
+				{
+					flusher_ = std::thread(&AsyncSink::Work, this);
+				}
+
+				// Bound the memory used by the queue if the threads produce output faster than it can be written.
+				written_.wait(lock, [this]()
+				{
+					return consoleQueue_.size() < MaxQueuedBytes || enqueuedChunks_ == writtenChunks_;
+				});
+
+				consoleQueue_ += consoleText;
+				fileQueue_ += fileText;
+				enqueuedChunks_++;
+			}
+
+			queued_.notify_one();
 		}
-	};
 
-	inline Logger all_ = Logger(LogFile);
-	inline FilteredLogger verb_ = FilteredLogger(all_);
+		/**
+		 * Waits until all text queued so far has been written.
+		 */
+		void Flush()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+
+			const auto chunks = enqueuedChunks_;
+
+			written_.wait(lock, [this, chunks]()
+			{
+				return writtenChunks_ >= chunks;
+			});
+		}
+	};
 
 	/**
-	 * A stream that outputs messages independently on the `Verbose` option.\n
-	 * If the `Log` option is specified, the output is written both to the standard output and to
-	 * the default .log file. Log file entries are prefixed with a time stamp for each line.
+	 * Retrieves the sink shared by all threads of the process.
 	 *
-	 * Usage: `Out::All() << "foo" << "bar";`
+	 * @return The process-wide output sink.
 	 */
-	inline Logger& All()
+	inline AsyncSink& GetSink()
 	{
-		if (all_.initialized)
-		{
-			all_.ofs << std::put_time(GetTimestamp(), "%Y-%m-%d %H:%M:%S") << ":\t";
-		}
+		static AsyncSink sink;
 
-		return all_;
+		return sink;
 	}
 
 	/**
-	 * A stream that outputs messages only when the `Verbose` option is specified at launch.\n
-	 * Additionally, if both the `Verbose` and `Log` options are specified, the output is written
-	 * both to the standard output and to the default .log file. Log file entries are prefixed
-	 * with a time stamp for each line.
-	 *
-	 * Usage: `Out::Verb() << "foo" << "bar";`
+	 * A stream buffer appending the formatted text to a string.
 	 */
-	inline FilteredLogger& Verb()
+	class StringAppendingBuffer final : public std::streambuf
 	{
-		if (Verbose)
+	public:
+		std::string text;
+
+	protected:
+		int_type overflow(const int_type character) override
 		{
-			if (verb_.logger.initialized)
+			if (!traits_type::eq_int_type(character, traits_type::eof()))
 			{
-				verb_.logger.ofs << std::put_time(GetTimestamp(), "%Y-%m-%d %H:%M:%S") << ":\t";
+				text.push_back(traits_type::to_char_type(character));
 			}
+
+			return character;
 		}
 
-		return verb_;
-	}
+		std::streamsize xsputn(const char* characters, const std::streamsize count) override
+		{
+			text.append(characters, count);
+
+			return count;
+		}
+	};
 
 	/**
-	 * Handles general types sent to the non-constrained stream.\n
-	 * If the `Log` option is specified, the output is written both to the standard output and to
-	 * the default .log file.
+	 * The per-thread formatting state - a buffer with the text of the unfinished line and a stream writing into it.
 	 */
-	template <class T>
-	Logger& operator<<(Logger& logger, const T& x)
+	struct ThreadBuffer
 	{
-		std::cout << x;
+		StringAppendingBuffer buffer;
+		std::ostream stream{&buffer};
+		std::string fileText;
+	};
 
-		if (logger.initialized)
-		{
-			logger.ofs << x;
-		}
+	inline ThreadBuffer& GetThreadBuffer()
+	{
+		thread_local ThreadBuffer threadBuffer;
 
-		return logger;
+		return threadBuffer;
 	}
 
 	/**
-	 * Handles the LLVM string reference sent to the non-constrained stream.\n
-	 * If the `Log` option is specified, the output is written both to the standard output and to
-	 * the default .log file.
+	 * Hands the buffered text of this thread over to the sink.
+	 *
+	 * @param partial Specifies whether an unfinished line should be handed over as well.
 	 */
-	inline Logger& operator<<(Logger& logger, const llvm::StringRef stringRef)
+	inline void Commit(const bool partial)
 	{
-		if (Verbose)
+		auto& text = GetThreadBuffer().buffer.text;
+		const auto end = partial ? text.size() : text.rfind('\n') + 1;
+
+		// No complete line has been written yet (`rfind` returned `npos`).
+		if (end == 0)
 		{
-			std::cout << stringRef.str();
+			return;
+		}
+
+		auto& fileText = GetThreadBuffer().fileText;
+		fileText.clear();
 
-			if (logger.initialized)
+		if (LogToFile)
+		{
+			// Log file entries are prefixed with a time stamp for each line.
+			size_t lineStart = 0;
+
+			while (lineStart < end)
 			{
-				logger.ofs << stringRef.str();
+				const auto lineEnd = std::min(text.find('\n', lineStart), end - 1) + 1;
+
+				fileText += GetTimestamp();
+				fileText += ":\t";
+				fileText.append(text, lineStart, lineEnd - lineStart);
+
+				lineStart = lineEnd;
 			}
 		}
 
-		return logger;
+		GetSink().Enqueue(end == text.size() ? text : text.substr(0, end), fileText);
+		text.erase(0, end);
 	}
 
 	/**
-	 * Handles types already processed by a previous `<<` operator sent to the non-constrained stream.\n
-	 * If the `Log` option is specified, the output is written both to the standard output and to
-	 * the default .log file.
+	 * A single message written to one of the output streams.\n
+	 * The message is formatted only if its level is enabled. Complete lines are handed over to the sink at
+	 * the end of the statement that wrote them, an unfinished line waits for the following messages of its thread.
 	 */
-	inline Logger& operator<<(Logger& logger, const Manipulator manipulator)
+	class Message
 	{
-		std::cout << manipulator;
+		bool enabled_;
 
-		if (logger.initialized)
+	public:
+		explicit Message(const bool enabled) : enabled_(enabled)
 		{
-			logger.ofs << manipulator;
 		}
 
-		return logger;
-	}
+		~Message()
+		{
+			if (enabled_)
+			{
+				Commit(false);
+			}
+		}
 
-	/**
-	 * Handles general types sent to the filtered stream.\n
-	 * If both the `Verbose` and `Log` options are specified, the output is written
-	 * both to the standard output and to the default .log file.
-	 */
-	template <class T>
-	FilteredLogger& operator<<(FilteredLogger& logger, const T& x)
-	{
-		if (Verbose)
+		// Rule of three.
+
+		Message(const Message& other) = delete;
+		Message& operator=(const Message& other) = delete;
+
+		/**
+		 * Handles general types sent to the stream.
+		 */
+		template <class T>
+		Message& operator<<(const T& x)
 		{
-			std::cout << x;
+			if (enabled_)
+			{
+				GetThreadBuffer().stream << x;
+			}
 
-			if (logger.logger.initialized)
+			return *this;
+		}
+
+		/**
+		 * Handles the LLVM string reference sent to the stream.
+		 */
+		Message& operator<<(const llvm::StringRef stringRef)
+		{
+			if (enabled_)
 			{
-				logger.logger.ofs << x;
+				GetThreadBuffer().buffer.text.append(stringRef.data(), stringRef.size());
 			}
+
+			return *this;
 		}
 
-		return logger;
-	}
+		/**
+		 * Handles types already processed by a previous `<<` operator sent to the stream.
+		 */
+		Message& operator<<(const Manipulator manipulator)
+		{
+			if (enabled_)
+			{
+				GetThreadBuffer().stream << manipulator;
+			}
+
+			return *this;
+		}
+	};
+
+	/**
+	 * Serializes messages written by multiple threads.
+	 */
+	inline std::mutex outputMutex_;
 
 	/**
-	 * Handles the LLVM string reference sent to the filtered stream.\n
-	 * If both the `Verbose` and `Log` options are specified, the output is written
-	 * both to the standard output and to the default .log file.
+	 * Locks the output streams for the current scope so that messages written by one thread in multiple
+	 * statements are not interleaved with messages of other threads. Single lines never interleave.
+	 *
+	 * Usage: `const auto lock = Out::Lock(); Out::All() << "foo\n"; Out::All() << "bar\n";`
 	 */
-	inline FilteredLogger& operator<<(FilteredLogger& logger, const llvm::StringRef stringRef)
+	inline std::unique_lock<std::mutex> Lock()
 	{
-		if (Verbose)
-		{
-			std::cout << stringRef.str();
+		return std::unique_lock<std::mutex>(outputMutex_);
+	}
 
-			if (logger.logger.initialized)
-			{
-				logger.logger.ofs << stringRef.str();
-			}
-		}
+	/**
+	 * A stream that outputs messages independently on the `Verbose` option.\n
+	 * If the `Log` option is specified, the output is written both to the standard output and to
+	 * the default .log file. Log file entries are prefixed with a time stamp for each line.
+	 *
+	 * Usage: `Out::All() << "foo" << "bar";`
+	 */
+	inline Message All()
+	{
+		return Message(true);
+	}
 
-		return logger;
+	/**
+	 * A stream that outputs messages only when the `Verbose` option is specified at launch.\n
+	 * Additionally, if both the `Verbose` and `Log` options are specified, the output is written
+	 * both to the standard output and to the default .log file. Log file entries are prefixed
+	 * with a time stamp for each line.\n
+	 * The level is checked before any argument is formatted.
+	 *
+	 * Usage: `Out::Verb() << "foo" << "bar";`
+	 */
+	inline Message Verb()
+	{
+		return Message(Verbose);
 	}
 
 	/**
-	 * Handles types already processed by a previous `<<` operator sent to the filtered stream.\n
-	 * If both the `Verbose` and `Log` options are specified, the output is written
-	 * both to the standard output and to the default .log file.
+	 * A deferred variant of the verbose stream for messages whose arguments are expensive to compute.\n
+	 * The arguments of `Out::Verb() << ...` are evaluated even if the message is discarded, the given callback
+	 * is not called at all unless the `Verbose` option is specified.
+	 *
+	 * Usage: `Out::Verb([&](auto& out) { out << "foo" << Stringify(bitMask) << "\n"; });`
+	 *
+	 * @param formatter A callable accepting the message stream.
 	 */
-	inline FilteredLogger& operator<<(FilteredLogger& logger, const Manipulator manipulator)
+	template <class Formatter>
+	void Verb(Formatter&& formatter)
 	{
 		if (Verbose)
 		{
-			std::cout << manipulator;
-
-			if (logger.logger.initialized)
-			{
-				logger.logger.ofs << manipulator;
-			}
+			auto message = Message(true);
+			formatter(message);
 		}
+	}
 
-		return logger;
+	/**
+	 * Writes all pending output of this thread (including an unfinished line) and waits until all messages
+	 * queued so far by any thread have been written.\n
+	 * Should be called before writing to the standard output directly or before handing it over to another process,
+	 * and at the end of each program, since an unfinished line is not handed over by the exit.
+	 */
+	inline void Flush()
+	{
+		Commit(true);
+		GetSink().Flush();
 	}
 }
 
@@ -0,0 +1,243 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Options.h"
+
+namespace Common
+{
+	/**
+	 * A fixed-size pool of worker threads with a work-stealing scheduler.\n
+	 * Each worker has its own queue. Tasks submitted by a worker are added to its queue and executed in the LIFO
+	 * order, tasks submitted from other threads are distributed over the queues in a round-robin manner.
+	 * An idle worker steals the oldest task of another worker, so that uneven tasks do not leave workers idle.\n
+	 * Tasks must not wait for other tasks of the same pool, otherwise the pool could deadlock.
+	 */
+	class ThreadPool
+	{
+		/**
+		 * The tasks of a single worker.
+		 */
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		std::vector<std::unique_ptr<WorkerQueue>> queues_;
+		std::vector<std::thread> workers_;
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		std::atomic<long> pendingTasks_{0};
+		std::atomic<size_t> nextQueue_{0};
+		bool stopping_ = false;
+
+		/**
+		 * The pool whose worker is the current thread, null for threads outside of any pool.
+		 */
+		static inline thread_local ThreadPool* currentPool_ = nullptr;
+		static inline thread_local size_t currentIndex_ = 0;
+
+		/**
+		 * Takes a task from the worker's own queue (the newest one) or steals a task from another queue
+		 * (the oldest one).
+		 *
+		 * @param index The index of the worker.
+		 * @param task The taken task.
+		 * @return True if a task was found, false otherwise.
+		 */
+		bool TryTake(const size_t index, std::function<void()>& task)
+		{
+			for (size_t i = 0; i < queues_.size(); i++)
+			{
+				auto& queue = *queues_[(index + i) % queues_.size()];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+
+				if (queue.tasks.empty())
+				{
+					continue;
+				}
+
+				if (i == 0)
+				{
+					task = std::move(queue.tasks.back());
+					queue.tasks.pop_back();
+				}
+				else
+				{
+					task = std::move(queue.tasks.front());
+					queue.tasks.pop_front();
+				}
+
+				pendingTasks_--;
+				return true;
+			}
+
+			return false;
+		}
+
+		/**
+		 * The body of each worker - executes and steals tasks until the pool is destroyed.
+		 *
+		 * @param index The index of the worker and of its queue.
+		 */
+		void Work(const size_t index)
+		{
+			currentPool_ = this;
+			currentIndex_ = index;
+
+			while (true)
+			{
+				std::function<void()> task;
+
+				if (TryTake(index, task))
+				{
+					task();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(mutex_);
+				condition_.wait(lock, [this]()
+				{
+					return stopping_ || pendingTasks_ > 0;
+				});
+
+				if (stopping_ && pendingTasks_ <= 0)
+				{
+					return;
+				}
+			}
+		}
+
+	public:
+
+		/**
+		 * Starts the workers.
+		 *
+		 * @param threadCount The number of workers, at least one worker is always started.
+		 */
+		explicit ThreadPool(const unsigned threadCount)
+		{
+			for (unsigned i = 0; i < std::max(threadCount, 1u); i++)
+			{
+				queues_.push_back(std::make_unique<WorkerQueue>());
+			}
+
+			for (size_t i = 0; i < queues_.size(); i++)
+			{
+				workers_.emplace_back(&ThreadPool::Work, this, i);
+			}
+		}
+
+		/**
+		 * Finishes all queued tasks and joins the workers.
+		 */
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stopping_ = true;
+			}
+
+			condition_.notify_all();
+
+			for (auto& worker : workers_)
+			{
+				worker.join();
+			}
+		}
+
+		// Rule of three.
+
+		ThreadPool(const ThreadPool& other) = delete;
+		ThreadPool& operator=(const ThreadPool& other) = delete;
+
+		/**
+		 * Queues a task for execution.
+		 *
+		 * @param task A callable without parameters.
+		 * @return The future result of the task.
+		 */
+		template <typename Task>
+		auto Submit(Task&& task) -> std::future<decltype(task())>
+		{
+			using Result = decltype(task());
+
+			auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+			auto future = packagedTask->get_future();
+
+			const auto index = currentPool_ == this ? currentIndex_ : nextQueue_++ % queues_.size();
+
+			{
+				std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+				queues_[index]->tasks.emplace_back([packagedTask]()
+				{
+					(*packagedTask)();
+				});
+			}
+
+			{
+				// The counter is changed under the lock, so that a worker about to sleep cannot miss the task.
+				std::lock_guard<std::mutex> lock(mutex_);
+				pendingTasks_++;
+			}
+
+			condition_.notify_one();
+
+			return future;
+		}
+
+		[[nodiscard]] size_t Size() const
+		{
+			return workers_.size();
+		}
+
+		/**
+		 * Checks whether the current thread is a worker of any pool.
+		 */
+		[[nodiscard]] static bool IsWorkerThread()
+		{
+			return currentPool_ != nullptr;
+		}
+	};
+
+	/**
+	 * Retrieves the pool shared by all parallel stages of AutoPIE.\n
+	 * The pool is created upon the first use. Its size is given by the `--jobs` option,
+	 * by default, it has as many workers as there are hardware threads. A stage run later by the `autopie` driver
+	 * with a different `--jobs` value gets a new pool, the old one finishes its tasks first.
+	 *
+	 * @return The shared thread pool.
+	 */
+	inline ThreadPool& GetSharedThreadPool()
+	{
+		static std::mutex poolMutex;
+		static std::unique_ptr<ThreadPool> pool;
+
+		const auto size = std::max(Jobs > 0 ? Jobs.getValue() : std::thread::hardware_concurrency(), 1u);
+
+		std::lock_guard<std::mutex> lock(poolMutex);
+
+		// Tasks never replace the pool they run on, the pool is only replaced between stages.
+		if (pool == nullptr || (pool->Size() != size && !ThreadPool::IsWorkerThread()))
+		{
+			pool.reset();
+			pool = std::make_unique<ThreadPool>(size);
+		}
+
+		return *pool;
+	}
+} // namespace Common
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TOOLRUNNER_H
+#define TOOLRUNNER_H
+#pragma once
+
+#include <clang/Tooling/ArgumentsAdjusters.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Common
+{
+	/**
+	 * Describes a single run of a frontend action on a single translation unit.
+	 */
+	struct ToolJob
+	{
+		const clang::tooling::CompilationDatabase& compilations;
+		std::string filePath;
+		std::unique_ptr<clang::tooling::FrontendActionFactory> factory;
+
+		ToolJob(const clang::tooling::CompilationDatabase& database, std::string path,
+		        std::unique_ptr<clang::tooling::FrontendActionFactory> actionFactory) : compilations(database),
+		                                                                                filePath(std::move(path)),
+		                                                                                factory(std::move(
+			                                                                                actionFactory))
+		{
+		}
+	};
+
+	std::vector<int> RunToolsInParallel(std::vector<ToolJob>& jobs, const clang::tooling::ArgumentsAdjuster& adjuster);
+} // namespace Common
+
+#endif
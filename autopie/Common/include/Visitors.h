@@ -38,6 +38,8 @@ namespace Common
 		BitMask bitMask_;
 		int currentNode_ = 0; ///< The traversal order number.
 		RewriterRef rewriter_;
+		bool schema_ = false; ///< Set if the nodes are guarded instead of removed, see `ResetSchema`.
+		std::vector<std::pair<clang::SourceRange, int>> guards_; ///< The guarded ranges in the traversal order.
 
 		/**
 		 * Keeps the original, non-adjusted container of lines.\n
@@ -70,7 +72,10 @@ namespace Common
 		{
 			if (rewriter_)
 			{
-				Out::Verb() << "Removing node " << currentNode_ << ":\n" << RangeToString(astContext_, range) << "\n";
+				Out::Verb([&](auto& out)
+				{
+					out << "Removing node " << currentNode_ << ":\n" << RangeToString(astContext_, range) << "\n";
+				});
 
 				const auto printableRange = GetPrintableRange(GetPrintableRange(range, astContext_.getSourceManager()),
 				                                              astContext_.getSourceManager());
@@ -109,6 +114,57 @@ namespace Common
 			}
 		}
 
+		/**
+		 * Guards a statement by a runtime switch of the mutant schema, see `ResetSchema`.\n
+		 * Only statements directly inside a compound statement are guarded, other nodes (declarations, nested
+		 * expressions, labels) cannot be removed at runtime and are always kept by the schema.
+		 * The guard is inserted later by `InsertGuards`.
+		 *
+		 * @param stmt The statement to be guarded.
+		 */
+		void GuardInSource(clang::Stmt* stmt)
+		{
+			if (!rewriter_ || llvm::isa<clang::DeclStmt>(stmt) || llvm::isa<clang::SwitchCase>(stmt) || llvm::isa<
+				clang::LabelStmt>(stmt) || llvm::isa<clang::NullStmt>(stmt))
+			{
+				return;
+			}
+
+			const auto parents = astContext_.getParents(*stmt);
+
+			if (parents.size() != 1 || !parents[0].get<clang::CompoundStmt>())
+			{
+				return;
+			}
+
+			const auto& sm = astContext_.getSourceManager();
+
+			if (stmt->getBeginLoc().isMacroID() || stmt->getEndLoc().isMacroID())
+			{
+				return;
+			}
+
+			// The guard must enclose the terminating semicolon of the statement (which is not a part of its range),
+			// but not the token following a compound statement.
+			auto end = clang::Lexer::findLocationAfterToken(stmt->getEndLoc(), clang::tok::semi, sm,
+			                                                astContext_.getLangOpts(), false);
+
+			if (end.isInvalid())
+			{
+				end = clang::Lexer::getLocForEndOfToken(stmt->getEndLoc(), 0, sm, astContext_.getLangOpts());
+			}
+
+			const auto printableRange = clang::SourceRange(stmt->getBeginLoc(), end);
+
+			if (printableRange.isInvalid())
+			{
+				return;
+			}
+
+			guards_.emplace_back(printableRange, currentNode_);
+			guardedNodes[currentNode_] = true;
+		}
+
 		/**
 		 * Determines whether a node should be removed based on the dependency graph.\n
 		 * Since the traversal mode is set to postorder, it is possible that a snippet of source
@@ -184,7 +240,14 @@ namespace Common
 		 */
 		void ProcessRelevantExpression(clang::Expr* expr)
 		{
-			if (skippedNodes_->find(currentNode_) == skippedNodes_->end() && ShouldBeRemoved())
+			if (schema_)
+			{
+				if (skippedNodes_->find(currentNode_) == skippedNodes_->end())
+				{
+					GuardInSource(expr);
+				}
+			}
+			else if (skippedNodes_->find(currentNode_) == skippedNodes_->end() && ShouldBeRemoved())
 			{
 				const auto range = expr->getSourceRange();
 
@@ -202,6 +265,11 @@ namespace Common
 		 */
 		std::vector<size_t> adjustedErrorLines;
 
+		/**
+		 * The nodes guarded by a runtime switch in the last mutant schema.
+		 */
+		BitMask guardedNodes;
+
 		VariantPrintingASTVisitor(clang::CompilerInstance* ci, const size_t errorLine) : astContext_(ci->getASTContext()),
 		                                                                              errorLineBackups_({errorLine}),
 		                                                                              adjustedErrorLines({errorLine})
@@ -217,12 +285,54 @@ namespace Common
 		 */
 		void Reset(const BitMask& mask, RewriterRef& rewriter)
 		{
+			schema_ = false;
 			currentNode_ = 0;
 			bitMask_ = mask;
 			rewriter_ = rewriter;
 			adjustedErrorLines = errorLineBackups_;
 		}
 
+		/**
+		 * Initializes data for a pass generating the mutant schema - a single program containing all variants.\n
+		 * Instead of being removed, each removable node is guarded by `__autopie_keep(<node>)`, which reads
+		 * the bit of the node from the bit mask passed in the `SchemaMaskVariable` environment variable.
+		 * No lines are removed, the error lines are not adjusted.
+		 *
+		 * @param rewriter The source code container into which the guards are inserted.
+		 * @param nodeCount The number of code units.
+		 */
+		void ResetSchema(RewriterRef& rewriter, const size_t nodeCount)
+		{
+			schema_ = true;
+			currentNode_ = 0;
+			bitMask_ = BitMask(nodeCount, true);
+			rewriter_ = rewriter;
+			adjustedErrorLines = errorLineBackups_;
+			guardedNodes.assign(nodeCount, false);
+			guards_.clear();
+		}
+
+		/**
+		 * Inserts the guards collected by the traversal of the mutant schema.\n
+		 * The guards are inserted on the lines of their statements, so that the line numbers do not change.
+		 * A statement may end where the next one begins, the closing braces at a location must therefore precede
+		 * the opening ones. The traversal is postorder, so the closing braces are inserted in the traversal order
+		 * (inner first) and the opening ones in the reverse order (outer first).
+		 */
+		void InsertGuards()
+		{
+			for (const auto& guard : guards_)
+			{
+				rewriter_->InsertText(guard.first.getEnd(), " }", true);
+			}
+
+			for (auto it = guards_.rbegin(); it != guards_.rend(); ++it)
+			{
+				rewriter_->InsertText(it->first.getBegin(), "if (__autopie_keep(" + std::to_string(it->second) +
+				                      ")) { ", true);
+			}
+		}
+
 		/**
 		 * Initializes general data for all future passes.
 		 *
@@ -267,7 +377,8 @@ namespace Common
 				return true;
 			}
 
-			if (skippedNodes_->find(currentNode_) == skippedNodes_->end() && ShouldBeRemoved())
+			// Declarations cannot be removed at runtime, the schema keeps them.
+			if (!schema_ && skippedNodes_->find(currentNode_) == skippedNodes_->end() && ShouldBeRemoved())
 			{
 				const auto range = decl->getSourceRange();
 
@@ -467,7 +578,14 @@ namespace Common
 				return true;
 			}
 
-			if (skippedNodes_->find(currentNode_) == skippedNodes_->end() && ShouldBeRemoved())
+			if (schema_)
+			{
+				if (skippedNodes_->find(currentNode_) == skippedNodes_->end())
+				{
+					GuardInSource(stmt);
+				}
+			}
+			else if (skippedNodes_->find(currentNode_) == skippedNodes_->end() && ShouldBeRemoved())
 			{
 				const auto range = stmt->getSourceRange();
 
@@ -519,13 +637,34 @@ namespace Common
 		NodeMappingRef declNodeMapping_;
 
 		/**
-		 * Keeps a list of found declaration references (i.e., variable usages).\n
-		 * Each entry consists of a pair.\n
-		 * The first value is the AST ID (a unique replicable number that can be extracted from each node) of
-		 * the declaration node.\n
-		 * The second value is the AST ID of the node in which the declared variable or function was referenced.
+		 * A usage of a declaration found in an expression or in a type.
+		 */
+		struct DeclReference
+		{
+			clang::Decl* decl; ///< The referenced declaration.
+			int astId; ///< The AST ID of the referencing expression, unused for type references.
+			clang::SourceLocation location; ///< The location of the reference.
+		};
+
+		/**
+		 * Keeps a list of found declaration references in expressions (i.e., usages of variables, functions, fields,
+		 * enum constants and constructors) that have not been assigned to a code unit yet.
 		 */
-		std::vector<std::pair<int, int>> declReferences_;
+		std::vector<DeclReference> declReferences_;
+
+		/**
+		 * Keeps a list of found references to types (records, enums and typedefs) that have not been assigned
+		 * to a code unit yet.
+		 */
+		std::vector<DeclReference> typeReferences_;
+
+		/**
+		 * Keeps the references assigned to the innermost code unit in which they were found.\n
+		 * The first value is the referenced declaration, the second value is the traversal order number of
+		 * the referencing node. The references are turned into dependencies once the whole translation unit
+		 * has been mapped, since a declaration (e.g., the definition of a called function) may follow its usage.
+		 */
+		std::vector<std::pair<clang::Decl*, int>> foundReferences_;
 
 		/**
 		 * Keeps note of which nodes should be skipped during traversal.\n
@@ -568,13 +707,30 @@ namespace Common
 			return nodeMapping_->insert(std::pair<int, int>(astId, codeUnitsCount)).second;
 		}
 
+		/**
+		 * Records the lines of the source code that is removed together with the current node,
+		 * see `VariantPrintingASTVisitor::RemoveFromSource`.
+		 *
+		 * @param range The source range of the node.
+		 */
+		void InsertNodeLocation(const clang::SourceRange range)
+		{
+			const auto& sm = astContext_.getSourceManager();
+			const auto printableRange = GetPrintableRange(GetPrintableRange(range, sm), sm);
+			const auto snippet = GetSourceTextRaw(printableRange, sm).str();
+
+			graph.SetNodeLocation(codeUnitsCount, sm.getSpellingLineNumber(printableRange.getBegin()),
+			                      static_cast<size_t>(std::count(snippet.begin(), snippet.end(), '\n')));
+		}
+
 		/**
 		 * Checks whether the given statement represents a declaration.\n
-		 * If it does, the node ID is mapped to the current traversal number in a separate declaration mapping.
+		 * If it does, the node ID is mapped to the current traversal number in a separate declaration mapping
+		 * and the declared names are recorded in the graph.
 		 *
 		 * @param stmt The statement to be checked and mapped.
 		 */
-		void HandleDeclarationsInStatements(clang::Stmt* stmt) const
+		void HandleDeclarationsInStatements(clang::Stmt* stmt)
 		{
 			if (stmt != nullptr && llvm::isa<clang::DeclStmt>(stmt))
 			{
@@ -590,26 +746,85 @@ namespace Common
 						{
 							(*declNodeMapping_)[id] = codeUnitsCount;
 						}
+
+						if (llvm::isa<clang::NamedDecl>(decl))
+						{
+							graph.InsertDeclaredName(codeUnitsCount,
+							                         llvm::cast<clang::NamedDecl>(decl)->getNameAsString());
+						}
 					}
 				}
 			}
 		}
 
 		/**
-		 * Checks whether an expression is a declaration reference, i.e., a variable usage.\n
-		 * If it does and the variable's declaration has been mapped, a dependency is created.\n
-		 * The dependency states that the parent statement node (if encountered) is dependent on the declaring node.
+		 * Records a usage of a declaration in an expression.\n
+		 * The usage is later assigned to the innermost code unit containing the expression, which is then made
+		 * dependent on the declaration, see `CheckFoundDeclReferences`.
+		 *
+		 * @param decl The referenced declaration.
+		 * @param expr The referencing expression.
+		 */
+		void HandleReferencesInExpressions(clang::Decl* decl, clang::Expr* expr)
+		{
+			if (decl != nullptr && expr != nullptr)
+			{
+				declReferences_.push_back({decl, static_cast<int>(expr->getID(astContext_)), expr->getBeginLoc()});
+			}
+		}
+
+		/**
+		 * Records a usage of a record, an enum or a typedef in a type.\n
+		 * The usage is later assigned to the innermost code unit containing its location.
+		 *
+		 * @param decl The declaration of the type.
+		 * @param location The location of the type's usage.
+		 */
+		void HandleReferencesInTypes(clang::Decl* decl, const clang::SourceLocation location)
+		{
+			if (decl != nullptr && location.isValid() && astContext_.getSourceManager().isInMainFile(location))
+			{
+				typeReferences_.push_back({decl, 0, location});
+			}
+		}
+
+		/**
+		 * Determines whether a location is in a given source range, macros are considered by their expansion.
+		 *
+		 * @param location The location to be checked.
+		 * @param range The source range.
+		 * @return True if the location is in the range, false otherwise.
+		 */
+		bool IsInRange(const clang::SourceLocation location, const clang::SourceRange range) const
+		{
+			const auto& sm = astContext_.getSourceManager();
+			const auto expansionRange = sm.getExpansionRange(range);
+
+			return sm.isPointWithin(sm.getExpansionLoc(location), expansionRange.getBegin(), expansionRange.getEnd());
+		}
+
+		/**
+		 * Assigns the found type references located in the given source range to the current code unit.
 		 *
-		 * @param expr The expression to be checked for variable usages.
+		 * @param range The source range of the current code unit.
 		 */
-		void HandleVariableInstancesInExpressions(clang::Expr* expr)
+		void CheckFoundTypeReferences(const clang::SourceRange range)
 		{
-			// The statement / expression might contain a direct variable usage, e.g. `x = 5;`
-			if (expr != nullptr && llvm::isa<clang::DeclRefExpr>(expr))
+			std::vector<DeclReference> toBeKept;
+
+			for (const auto& reference : typeReferences_)
 			{
-				const auto parentId = llvm::cast<clang::DeclRefExpr>(expr)->getFoundDecl()->getID();
-				declReferences_.push_back(std::pair<int, int>(parentId, expr->getID(astContext_)));
+				if (IsInRange(reference.location, range))
+				{
+					foundReferences_.emplace_back(reference.decl, codeUnitsCount);
+				}
+				else
+				{
+					toBeKept.push_back(reference);
+				}
 			}
+
+			typeReferences_ = toBeKept;
 		}
 
 		/**
@@ -642,32 +857,89 @@ namespace Common
 		}
 
 		/**
-		 * Processes all found declaration references (i.e., variable usages) with respect to the current traversed statement.\n
+		 * Processes all found declaration references with respect to the current traversed statement.\n
 		 * The current statement is given both by the `clang::Stmt*` parameter and by the `codeUnitsCount` traversal order number.\n
-		 * All found declaration references are checked. In order to be processed, the declaring node has to be mapped.\n
-		 * Additionally, the declaration reference's occurence node must be a recursive child of the current statement.\n
-		 * If a declaration reference is successfully recognized, it is added as a variable dependency and removed from
-		 * the list of unprocessed declaration references.
+		 * In order to be processed, the declaration reference's occurence node must be a recursive child of the current
+		 * statement. If a declaration reference is successfully recognized, it is assigned to the current statement
+		 * and removed from the list of unprocessed declaration references, see `ResolveDeclReferences`.\n
+		 * Type references are assigned based on their location.
 		 *
 		 * @param stmt The current statement given by its `clang::Stmt*` instance.
 		 */
 		void CheckFoundDeclReferences(clang::Stmt* stmt)
 		{
-			std::vector<std::pair<int, int>> toBeKept;
+			std::vector<DeclReference> toBeKept;
 
-			for (auto it = declReferences_.begin(); it != declReferences_.end(); ++it)
+			for (const auto& reference : declReferences_)
 			{
-				if (declNodeMapping_->find(it->first) != declNodeMapping_->end() && IsRecursiveChild(stmt, it->second))
+				if (IsRecursiveChild(stmt, reference.astId))
 				{
-					graph.InsertVariableDependency((*declNodeMapping_)[it->first], codeUnitsCount);
+					foundReferences_.emplace_back(reference.decl, codeUnitsCount);
 				}
 				else
 				{
-					toBeKept.push_back(*it);
+					toBeKept.push_back(reference);
 				}
 			}
 
 			declReferences_ = toBeKept;
+
+			CheckFoundTypeReferences(stmt->getSourceRange());
+		}
+
+		/**
+		 * Processes all found declaration and type references with respect to the current traversed declaration.\n
+		 * References located in the declaration that have not been assigned to any of its statements are assigned
+		 * to the declaration itself, e.g., the types of a function's parameters or the type of a field.
+		 *
+		 * @param decl The current declaration.
+		 */
+		void CheckFoundDeclReferences(clang::Decl* decl)
+		{
+			std::vector<DeclReference> toBeKept;
+
+			for (const auto& reference : declReferences_)
+			{
+				if (IsInRange(reference.location, decl->getSourceRange()))
+				{
+					foundReferences_.emplace_back(reference.decl, codeUnitsCount);
+				}
+				else
+				{
+					toBeKept.push_back(reference);
+				}
+			}
+
+			declReferences_ = toBeKept;
+
+			CheckFoundTypeReferences(decl->getSourceRange());
+		}
+
+		/**
+		 * Turns the assigned references into variable dependencies once all declarations have been mapped.\n
+		 * The referencing node is made dependent on each mapped redeclaration of the referenced declaration,
+		 * e.g., on both the prototype and the definition of a called function.
+		 */
+		void ResolveDeclReferences()
+		{
+			for (const auto& [decl, node] : foundReferences_)
+			{
+				for (auto redecl : decl->redecls())
+				{
+					const auto id = static_cast<int>(redecl->getID());
+
+					if (declNodeMapping_->find(id) != declNodeMapping_->end())
+					{
+						graph.InsertVariableDependency(declNodeMapping_->at(id), node);
+					}
+					else if (nodeMapping_->find(id) != nodeMapping_->end())
+					{
+						graph.InsertVariableDependency(nodeMapping_->at(id), node);
+					}
+				}
+			}
+
+			foundReferences_.clear();
 		}
 
 		/**
@@ -735,6 +1007,13 @@ namespace Common
 				if (InsertMapping(id, codeSnippet, line))
 				{
 					graph.InsertNodeDataForDebugging(codeUnitsCount, id, codeSnippet, typeName, "crimson");
+					InsertNodeLocation(decl->getSourceRange());
+					CheckFoundDeclReferences(decl);
+
+					if (llvm::isa<clang::NamedDecl>(decl))
+					{
+						graph.InsertDeclaredName(codeUnitsCount, llvm::cast<clang::NamedDecl>(decl)->getNameAsString());
+					}
 
 					if (llvm::isa<clang::FunctionDecl>(decl) && llvm::cast<clang::FunctionDecl>(decl)->isMain())
 					{
@@ -782,6 +1061,7 @@ namespace Common
 				if (InsertMapping(id, codeSnippet, line))
 				{
 					graph.InsertNodeDataForDebugging(codeUnitsCount, id, codeSnippet, typeName, color);
+					InsertNodeLocation(expr->getSourceRange());
 
 					// Map children as dependencies.
 					CreateChildDependencies(expr);
@@ -819,6 +1099,7 @@ namespace Common
 				if (InsertMapping(id, codeSnippet, line))
 				{
 					graph.InsertNodeDataForDebugging(codeUnitsCount, id, codeSnippet, typeName, "darkorchid");
+					InsertNodeLocation(stmt->getSourceRange());
 
 					HandleDeclarationsInStatements(stmt);
 					CheckFoundDeclReferences(stmt);
@@ -1218,7 +1499,40 @@ namespace Common
 			// Look for variable usages inside the current expression.
 			// If the statement uses a previously declared variable, it should be dependent on that declaration.
 			// e.g. `if (x < 2) { ... } `should depend on `int x = 0;`
-			HandleVariableInstancesInExpressions(expr);
+			// The same applies to functions and enum constants, e.g., `case Red:` should depend on `Red`.
+			HandleReferencesInExpressions(expr->getDecl(), expr);
+
+			return true;
+		}
+
+		/**
+		 * Overrides the parent visit method.\n
+		 * Serves to find field and method references, e.g., `p.x` should depend on the field `x`.
+		 */
+		bool VisitMemberExpr(clang::MemberExpr* expr)
+		{
+			if (SkipIncludeStmt(expr))
+			{
+				return true;
+			}
+
+			HandleReferencesInExpressions(expr->getMemberDecl(), expr);
+
+			return true;
+		}
+
+		/**
+		 * Overrides the parent visit method.\n
+		 * Serves to find constructor calls, which should depend on the called constructor.
+		 */
+		bool VisitCXXConstructExpr(clang::CXXConstructExpr* expr)
+		{
+			if (SkipIncludeStmt(expr))
+			{
+				return true;
+			}
+
+			HandleReferencesInExpressions(expr->getConstructor(), expr);
 
 			return true;
 		}
@@ -1273,6 +1587,46 @@ namespace Common
 
 #pragma endregion Expressions
 
+#pragma region Types
+
+		/**
+		 * Overrides the parent visit method.\n
+		 * Serves to find usages of records and enums, e.g., `struct S s;` should depend on `struct S { ... };`.
+		 */
+		bool VisitTagTypeLoc(clang::TagTypeLoc typeLoc)
+		{
+			HandleReferencesInTypes(typeLoc.getDecl(), typeLoc.getBeginLoc());
+
+			return true;
+		}
+
+		/**
+		 * Overrides the parent visit method.\n
+		 * Serves to find usages of typedefs, e.g., `T t;` should depend on `typedef int T;`.
+		 */
+		bool VisitTypedefTypeLoc(clang::TypedefTypeLoc typeLoc)
+		{
+			HandleReferencesInTypes(typeLoc.getTypedefNameDecl(), typeLoc.getBeginLoc());
+
+			return true;
+		}
+
+#pragma endregion Types
+
+		/**
+		 * Overrides the parent traversal method.\n
+		 * Traverses the whole translation unit and then creates the dependencies of the found references,
+		 * see `ResolveDeclReferences`.
+		 */
+		bool TraverseTranslationUnitDecl(clang::TranslationUnitDecl* decl)
+		{
+			const auto result = RecursiveASTVisitor::TraverseTranslationUnitDecl(decl);
+
+			ResolveDeclReferences();
+
+			return result;
+		}
+
 		/**
 		 * Overrides the parent visit method.\n
 		 * Skips selected node types based on their importance.\n
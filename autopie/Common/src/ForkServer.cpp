@@ -0,0 +1,585 @@
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "../include/ForkServer.h"
+#include "../include/Helper.h"
+#include "../include/Instrumentation.h"
+#include "../include/Options.h"
+#include "../include/Streams.h"
+
+#ifndef _WIN32
+extern char** environ;
+#endif
+
+namespace Execution
+{
+	/**
+	 * The source code of the stub preloaded into the tested executable.\n
+	 * The stub replaces `main` by a wrapper using the `__libc_start_main` hook. The wrapper announces itself
+	 * on the status descriptor and serves the run requests - the environment entries of the run. The child of each
+	 * run records the crashing signal and instruction in a shared page and continues into the original `main`.
+	 * The server reports the child's ID, followed by its wait status and the crash location.\n
+	 * If the status descriptor is not open, the executable runs as usual.
+	 */
+	static const char* ForkServerStub = R"stub(#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#define CONTROL_FD 198
+#define STATUS_FD 199
+
+typedef int (*main_t)(int, char**, char**);
+
+struct crash { volatile uint64_t signal; volatile uint64_t pc; };
+struct report { uint64_t status; uint64_t signal; uint64_t offset; uint64_t in_executable; };
+
+extern char** environ;
+
+static main_t real_main_;
+static uintptr_t executable_base_;
+static struct crash* crash_;
+static char alternate_stack_[1 << 16];
+
+static int transfer(int fd, void* data, size_t size, int writing)
+{
+	char* bytes = (char*)data;
+	while (size > 0)
+	{
+		ssize_t done = writing ? write(fd, bytes, size) : read(fd, bytes, size);
+		if (done <= 0) return 0;
+		bytes += done;
+		size -= (size_t)done;
+	}
+	return 1;
+}
+
+static void handle_crash(int sig, siginfo_t* info, void* context)
+{
+	ucontext_t* uc = (ucontext_t*)context;
+	(void)info;
+	crash_->signal = (uint64_t)sig;
+#if defined(__x86_64__)
+	crash_->pc = (uint64_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+	crash_->pc = (uint64_t)uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+	crash_->pc = (uint64_t)uc->uc_mcontext.pc;
+#else
+	(void)uc;
+#endif
+	raise(sig);
+}
+
+static void install_handlers(void)
+{
+	static const int signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTRAP};
+	stack_t stack;
+	struct sigaction action;
+	size_t i;
+	stack.ss_sp = alternate_stack_;
+	stack.ss_size = sizeof alternate_stack_;
+	stack.ss_flags = 0;
+	sigaltstack(&stack, 0);
+	memset(&action, 0, sizeof action);
+	action.sa_sigaction = handle_crash;
+	action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESETHAND | SA_NODEFER;
+	for (i = 0; i < sizeof signals / sizeof signals[0]; i++) sigaction(signals[i], &action, 0);
+}
+
+static void serve(void)
+{
+	uint32_t length = 0;
+	if (!transfer(STATUS_FD, &length, sizeof length, 1)) return;
+	crash_ = (struct crash*)mmap(0, sizeof *crash_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (crash_ == MAP_FAILED) _exit(1);
+	while (transfer(CONTROL_FD, &length, sizeof length, 0))
+	{
+		char* entries = (char*)malloc(length + 1);
+		struct report report;
+		Dl_info info;
+		int32_t child;
+		int status = 0;
+		if (!entries || !transfer(CONTROL_FD, entries, length, 0)) _exit(1);
+		entries[length] = 0;
+		crash_->signal = 0;
+		crash_->pc = 0;
+		child = (int32_t)fork();
+		if (child == 0)
+		{
+			char* entry = entries;
+			close(CONTROL_FD);
+			close(STATUS_FD);
+			while (entry < entries + length)
+			{
+				size_t size = strlen(entry);
+				if (size > 0) putenv(entry);
+				entry += size + 1;
+			}
+			install_handlers();
+			return;
+		}
+		free(entries);
+		if (!transfer(STATUS_FD, &child, sizeof child, 1)) _exit(1);
+		if (child < 0 || waitpid(child, &status, 0) < 0) status = -1;
+		memset(&report, 0, sizeof report);
+		report.status = (uint64_t)(uint32_t)status;
+		report.signal = crash_->signal;
+		if (crash_->pc != 0 && dladdr((void*)(uintptr_t)crash_->pc, &info) && (uintptr_t)info.dli_fbase ==
+			executable_base_)
+		{
+			report.offset = crash_->pc - executable_base_;
+			report.in_executable = 1;
+		}
+		if (!transfer(STATUS_FD, &report, sizeof report, 1)) _exit(1);
+	}
+	_exit(0);
+}
+
+static int autopie_main(int argc, char** argv, char** envp)
+{
+	Dl_info info;
+	(void)envp;
+	if (dladdr((void*)real_main_, &info)) executable_base_ = (uintptr_t)info.dli_fbase;
+	serve();
+	return real_main_(argc, argv, environ);
+}
+
+int __libc_start_main(main_t main, int argc, char** argv, void (*init)(void), void (*fini)(void),
+                      void (*rtld_fini)(void), void* stack_end)
+{
+	int (*next)(main_t, int, char**, void (*)(void), void (*)(void), void (*)(void), void*) =
+		(int (*)(main_t, int, char**, void (*)(void), void (*)(void), void (*)(void), void*))dlsym(RTLD_NEXT,
+			"__libc_start_main");
+	real_main_ = main;
+	return next(autopie_main, argc, argv, init, fini, rtld_fini, stack_end);
+}
+)stub";
+
+	/**
+	 * The report sent by the stub after each run, see `ForkServerStub`.
+	 */
+	struct RunReport
+	{
+		std::uint64_t status;
+		std::uint64_t signal;
+		std::uint64_t offset;
+		std::uint64_t inExecutable;
+	};
+
+	/**
+	 * The time (in seconds) the server is given to start or to report a killed child.
+	 */
+	constexpr int ServerTimeout = 5;
+
+#ifndef _WIN32
+	/**
+	 * Writes to a pipe with `SIGPIPE` blocked in the calling thread, so that a write to a dead server fails
+	 * with `EPIPE` instead of terminating AutoPIE. The disposition of the signal is left untouched.
+	 *
+	 * @param fd The file descriptor.
+	 * @param bytes The buffer.
+	 * @param size The number of bytes to be written.
+	 * @return The result of `write`.
+	 */
+	static ssize_t WriteWithoutSignal(const int fd, const char* bytes, const size_t size)
+	{
+		sigset_t pipeSignal;
+		sigset_t previousMask;
+		sigset_t pending;
+		sigemptyset(&pipeSignal);
+		sigaddset(&pipeSignal, SIGPIPE);
+
+		pthread_sigmask(SIG_BLOCK, &pipeSignal, &previousMask);
+		sigpending(&pending);
+		const auto wasPending = sigismember(&pending, SIGPIPE) == 1;
+
+		const auto done = write(fd, bytes, size);
+		const auto error = errno;
+
+		if (done < 0 && error == EPIPE && !wasPending)
+		{
+			// Consume the signal raised by this write before the mask is restored.
+			const timespec noWait{0, 0};
+			sigtimedwait(&pipeSignal, nullptr, &noWait);
+		}
+
+		pthread_sigmask(SIG_SETMASK, &previousMask, nullptr);
+		errno = error;
+
+		return done;
+	}
+
+	/**
+	 * Reads or writes the given number of bytes, waiting at most the given time for each chunk.
+	 *
+	 * @param fd The file descriptor.
+	 * @param data The buffer.
+	 * @param size The number of bytes to be transferred.
+	 * @param writing Specifies whether the data should be written.
+	 * @param timeout The time in seconds, a negative value waits indefinitely.
+	 * @return True if all bytes were transferred, false on a timeout, an error or the end of the file.
+	 */
+	static bool Transfer(const int fd, void* data, size_t size, const bool writing, const int timeout = -1)
+	{
+		auto bytes = static_cast<char*>(data);
+
+		while (size > 0)
+		{
+			if (timeout >= 0)
+			{
+				pollfd descriptor{fd, static_cast<short>(writing ? POLLOUT : POLLIN), 0};
+
+				const auto ready = poll(&descriptor, 1, timeout * 1000);
+
+				if (ready < 0 && errno == EINTR)
+				{
+					continue;
+				}
+
+				if (ready <= 0)
+				{
+					return false;
+				}
+			}
+
+			const auto done = writing ? WriteWithoutSignal(fd, bytes, size) : read(fd, bytes, size);
+
+			if (done < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (done <= 0)
+			{
+				return false;
+			}
+
+			bytes += done;
+			size -= static_cast<size_t>(done);
+		}
+
+		return true;
+	}
+
+	/**
+	 * Compiles the stub into a shared library in the `TempFolder` unless it has been compiled already.
+	 *
+	 * @return The absolute path to the library, empty if the library could not be compiled.
+	 */
+	static std::string PrepareStub()
+	{
+		const auto library = std::filesystem::absolute(std::string(TempFolder) + "autopie_forkserver.so").string();
+
+		if (std::filesystem::exists(library))
+		{
+			return library;
+		}
+
+		const auto source = std::string(TempFolder) + "autopie_forkserver.c";
+
+		{
+			std::ofstream ofs(source);
+			ofs << ForkServerStub;
+		}
+
+		Instrumentation::ScopedPhase phase("compile");
+
+		if (CompileSharedLibrary(source, library) != 0)
+		{
+			return "";
+		}
+
+		return library;
+	}
+#endif
+
+	/**
+	 * Determines whether fork servers can be started at all, i.e., whether the platform is supported and the stub
+	 * has been compiled. A server of a particular executable may still fail to start.
+	 *
+	 * @return True if the stub is ready, false if the LLDB has to be used for all executables.
+	 */
+	bool ForkServer::IsSupported()
+	{
+#ifdef _WIN32
+		return false;
+#else
+		return !PrepareStub().empty();
+#endif
+	}
+
+	ForkServer::ForkServer(std::string executable) : executable_(std::move(executable))
+	{
+#ifdef _WIN32
+		llvm::errs() << "The fork server is not supported on Windows, the LLDB is used instead.\n";
+#else
+		Instrumentation::ScopedPhase phase("fork-server");
+
+		const auto library = PrepareStub();
+
+		if (library.empty())
+		{
+			Out::All() << "The fork server stub could not be compiled, the LLDB is used instead.\n";
+			return;
+		}
+
+		// Everything the child needs is prepared before forking, only async-signal-safe calls may follow
+		// (other threads of AutoPIE could hold locks, e.g., the allocator's).
+		const auto path = std::filesystem::absolute(executable_).string();
+		const auto preload = "LD_PRELOAD=" + library;
+		const auto workingDirectory = std::string(TempFolder);
+
+		// The arguments are passed the same way the LLDB launches the executable.
+		const char* argv[] = {path.c_str(), Arguments.c_str(), nullptr};
+
+		std::vector<const char*> environment{preload.c_str()};
+
+		for (auto entry = environ; *entry != nullptr; entry++)
+		{
+			if (std::strncmp(*entry, "LD_PRELOAD=", 11) != 0)
+			{
+				environment.push_back(*entry);
+			}
+		}
+
+		environment.push_back(nullptr);
+
+		int control[2];
+		int status[2];
+
+		if (pipe(control) != 0)
+		{
+			return;
+		}
+
+		if (pipe(status) != 0)
+		{
+			close(control[0]);
+			close(control[1]);
+			return;
+		}
+
+		const auto pid = fork();
+
+		if (pid == 0)
+		{
+			dup2(control[0], ControlDescriptor);
+			dup2(status[1], StatusDescriptor);
+			close(control[0]);
+			close(control[1]);
+			close(status[0]);
+			close(status[1]);
+
+			// The output of the tested program is discarded.
+			const auto null = open("/dev/null", O_RDWR);
+
+			if (null >= 0)
+			{
+				dup2(null, STDIN_FILENO);
+				dup2(null, STDOUT_FILENO);
+				dup2(null, STDERR_FILENO);
+			}
+
+			if (chdir(workingDirectory.c_str()) == 0)
+			{
+				execve(path.c_str(), const_cast<char* const*>(argv), const_cast<char* const*>(environment.data()));
+			}
+
+			_exit(127);
+		}
+
+		close(control[0]);
+		close(status[1]);
+		controlFd_ = control[1];
+		statusFd_ = status[0];
+
+		if (pid < 0)
+		{
+			Stop();
+			return;
+		}
+
+		pid_ = pid;
+
+		std::uint32_t hello;
+
+		if (!Transfer(statusFd_, &hello, sizeof hello, false, ServerTimeout))
+		{
+			Out::All() << "The fork server of '" << executable_ << "' did not start, the LLDB is used instead.\n";
+			Stop();
+			return;
+		}
+
+		Instrumentation::Count("fork-server/started");
+#endif
+	}
+
+	ForkServer::~ForkServer()
+	{
+		Stop();
+	}
+
+	/**
+	 * Terminates the server and closes the pipes.
+	 */
+	void ForkServer::Stop()
+	{
+#ifndef _WIN32
+		if (controlFd_ >= 0)
+		{
+			close(controlFd_);
+			controlFd_ = -1;
+		}
+
+		if (statusFd_ >= 0)
+		{
+			close(statusFd_);
+			statusFd_ = -1;
+		}
+
+		if (pid_ > 0)
+		{
+			kill(pid_, SIGKILL);
+			waitpid(pid_, nullptr, 0);
+			pid_ = -1;
+		}
+#endif
+	}
+
+	/**
+	 * Runs the executable once.\n
+	 * A run exceeding the timeout is killed, the server itself is stopped if it does not respond.
+	 *
+	 * @param environment The `NAME=value` entries added to the environment of the run.
+	 * @param timeout The time limit of the run in seconds.
+	 * @return The outcome of the run, empty if the server failed.
+	 */
+	std::optional<ExecutionResult> ForkServer::Run(const std::vector<std::string>& environment, const int timeout)
+	{
+#ifdef _WIN32
+		return std::nullopt;
+#else
+		if (!IsRunning())
+		{
+			return std::nullopt;
+		}
+
+		std::string request;
+
+		for (const auto& entry : environment)
+		{
+			request += entry;
+			request += '\0';
+		}
+
+		auto length = static_cast<std::uint32_t>(request.size());
+		std::int32_t child = -1;
+
+		if (!Transfer(controlFd_, &length, sizeof length, true, ServerTimeout) ||
+			!Transfer(controlFd_, request.data(), request.size(), true, ServerTimeout) ||
+			!Transfer(statusFd_, &child, sizeof child, false, ServerTimeout) || child < 0)
+		{
+			Stop();
+			return std::nullopt;
+		}
+
+		ExecutionResult result;
+		RunReport report{};
+
+		if (!Transfer(statusFd_, &report, sizeof report, false, timeout))
+		{
+			Out::Verb() << "The run has not finished in " << timeout << " seconds, killing the process ...\n";
+
+			result.timedOut = true;
+			kill(child, SIGKILL);
+
+			if (!Transfer(statusFd_, &report, sizeof report, false, ServerTimeout))
+			{
+				Stop();
+				return std::nullopt;
+			}
+		}
+
+		const auto status = static_cast<int>(report.status);
+
+		if (WIFSIGNALED(status))
+		{
+			result.signal = WTERMSIG(status);
+		}
+		else if (WIFEXITED(status))
+		{
+			result.exitCode = WEXITSTATUS(status);
+		}
+
+		result.crashedInExecutable = report.inExecutable != 0 && static_cast<int>(report.signal) == result.signal;
+		result.crashOffset = report.offset;
+
+		return result;
+#endif
+	}
+
+	/**
+	 * Describes a signal in the same way the LLDB describes the stop reason of a process terminated by it,
+	 * so that the description can be matched against the `--error-message`.
+	 *
+	 * @param signal The number of the signal.
+	 * @return The description of the signal.
+	 */
+	std::string DescribeSignal(const int signal)
+	{
+		std::string name;
+
+		switch (signal)
+		{
+		case SIGSEGV:
+			name = "SIGSEGV: invalid address";
+			break;
+		case SIGFPE:
+			name = "SIGFPE: arithmetic exception";
+			break;
+		case SIGILL:
+			name = "SIGILL: illegal instruction";
+			break;
+		case SIGABRT:
+			name = "SIGABRT: abort";
+			break;
+#ifndef _WIN32
+		case SIGBUS:
+			name = "SIGBUS: bus error";
+			break;
+		case SIGTRAP:
+			name = "SIGTRAP: trace trap";
+			break;
+#endif
+		default:
+			name = std::to_string(signal);
+			break;
+		}
+
+		auto description = "stop reason = signal " + name;
+
+#ifndef _WIN32
+		description += std::string(" (") + strsignal(signal) + ")";
+#endif
+
+		return description;
+	}
+} // namespace Execution
@@ -5,10 +5,21 @@
 #include <clang/Basic/SourceManager.h>
 #include <clang/Driver/Compilation.h>
 #include <clang/Driver/Driver.h>
+#include <clang/Driver/Job.h>
+#include <clang/Driver/Tool.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/SerializedDiagnosticReader.h>
+#include <clang/Frontend/SerializedDiagnostics.h>
 #include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
 
+#include <lldb/API/SBAddress.h>
 #include <lldb/API/SBError.h>
+#include <lldb/API/SBFileSpec.h>
+#include <lldb/API/SBLineEntry.h>
 #include <lldb/API/SBListener.h>
+#include <lldb/API/SBModule.h>
 #include <lldb/API/SBProcess.h>
 #include <lldb/API/SBStream.h>
 #include <lldb/API/SBTarget.h>
@@ -16,16 +27,32 @@
 
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/Object/MachO.h>
+#include <llvm/Support/FormatVariadic.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
 #include <llvm/Support/Program.h>
 #include <llvm/Support/VirtualFileSystem.h>
+#include <llvm/Support/xxhash.h>
 
+#include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
 #include <optional>
+#include <tuple>
+#include <unordered_map>
 
 #include "../include/Context.h"
 #include "../include/DependencyGraph.h"
+#include "../include/ForkServer.h"
+#include "../include/JitExecutor.h"
 #include "../include/Helper.h"
+#include "../include/IncrementalCompilation.h"
+#include "../include/Instrumentation.h"
 
 //===----------------------------------------------------------------------===//
 //
@@ -182,6 +209,228 @@ std::string EscapeQuotes(const std::string& text)
 	return result;
 }
 
+/**
+ * Parses the command line of a component into the `AutoPieArgs` options.\n
+ * Unlike the constructor of `CommonOptionsParser`, a malformed command line is reported and does not terminate
+ * the process, so that a request of the `autopie` driver in the `--serve` mode fails on its own.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments, including the program name.
+ * @return The parsed command line, empty if it could not be parsed.
+ */
+std::optional<clang::tooling::CommonOptionsParser> ParseCommandLine(int argc, const char** argv)
+{
+	auto parser = clang::tooling::CommonOptionsParser::create(argc, argv, AutoPieArgs);
+
+	if (!parser)
+	{
+		llvm::errs() << llvm::toString(parser.takeError()) << "\n";
+		return std::nullopt;
+	}
+
+	return std::move(*parser);
+}
+
+/**
+ * The modification time and the size of a file, used to detect that it has changed.
+ */
+using FileStamp = std::tuple<std::filesystem::file_time_type, std::uintmax_t>;
+
+/**
+ * An input file parsed by `DetermineInputLanguage`, kept for the stages that run over the unchanged file.
+ */
+struct SharedAST
+{
+	FileStamp stamp;
+
+	/**
+	 * The compile commands of the file, the AST depends on its flags.
+	 */
+	std::string commandLine;
+
+	clang::Language language;
+
+	/**
+	 * The path to the serialized AST, empty if the AST could not be saved.
+	 */
+	std::string astFile;
+};
+
+/**
+ * The parsed input files, keyed by their canonical paths. The serialized ASTs are kept in the `SharedASTFolder`.
+ */
+static std::map<std::string, SharedAST> sharedASTs;
+
+/**
+ * Joins the compile commands of a file into a single string.
+ *
+ * @param compilations The compilation database of the file.
+ * @param filePath The path to the source file.
+ * @return The working directories and the arguments of all compile commands of the file.
+ */
+static std::string GetCommandLine(const clang::tooling::CompilationDatabase& compilations,
+                                  const std::string& filePath)
+{
+	auto result = std::string();
+
+	for (const auto& command : compilations.getCompileCommands(filePath))
+	{
+		result += command.Directory + "\n";
+
+		for (const auto& argument : command.CommandLine)
+		{
+			result += argument + "\n";
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Looks up the parsed AST of a file that has not changed since it was parsed.
+ *
+ * @param compilations The compilation database of the file.
+ * @param filePath The path to the source file.
+ * @return The shared AST of the file, null if the file has not been parsed or if it has changed since.
+ */
+static const SharedAST* FindSharedAST(const clang::tooling::CompilationDatabase& compilations,
+                                      const std::string& filePath)
+{
+	std::error_code errorCode;
+	const auto canonicalPath = std::filesystem::weakly_canonical(filePath, errorCode).string();
+	const auto stamp = FileStamp(std::filesystem::last_write_time(filePath, errorCode),
+	                             std::filesystem::file_size(filePath, errorCode));
+
+	const auto shared = sharedASTs.find(canonicalPath);
+
+	if (errorCode || shared == sharedASTs.end() || shared->second.stamp != stamp || shared->second.commandLine !=
+		GetCommandLine(compilations, filePath))
+	{
+		return nullptr;
+	}
+
+	return &shared->second;
+}
+
+/**
+ * Determines the language of a source file by building its AST.\n
+ * The AST is serialized into the `SharedASTFolder` and remembered for the lifetime of the process, keyed by
+ * the file's path, size, modification time and compile commands. `RunOnSharedAST` runs the actions of the stage
+ * over it, so consecutive stages run by the `autopie` driver parse an unchanged input only once.
+ *
+ * @param tool The tool set up for the given file.
+ * @param compilations The compilation database with which the tool has been created.
+ * @param filePath The path to the source file.
+ * @return The language of the file or `clang::Language::Unknown` if its AST could not be built.
+ */
+clang::Language DetermineInputLanguage(clang::tooling::ClangTool& tool,
+                                       const clang::tooling::CompilationDatabase& compilations,
+                                       const std::string& filePath)
+{
+	static auto folderCleared = false;
+	static size_t astCount = 0;
+
+	if (const auto* shared = FindSharedAST(compilations, filePath))
+	{
+		Instrumentation::Count("cache/language/hits");
+
+		Out::Verb() << "File: " << filePath << ", language: " << LanguageToString(shared->language) << " (cached)\n";
+
+		return shared->language;
+	}
+
+	Instrumentation::Count("cache/language/misses");
+	Instrumentation::ScopedPhase phase("language");
+
+	Out::Verb() << "Checking the language...\n";
+
+	// The built ASTs are freed at the end of the function, only their serialized form is kept.
+	std::vector<std::unique_ptr<clang::ASTUnit>> trees;
+	tool.buildASTs(trees);
+
+	if (trees.size() != 1)
+	{
+		llvm::errs() << "Although only one AST was expected, " << trees.size() << " ASTs have been built.\n";
+		return clang::Language::Unknown;
+	}
+
+	auto& tree = *trees.begin();
+	const auto language = tree->getInputKind().getLanguage();
+
+	Out::Verb() << "File: " << tree->getOriginalSourceFileName() << ", language: " << LanguageToString(language) <<
+		"\n";
+
+	std::error_code errorCode;
+	const auto canonicalPath = std::filesystem::weakly_canonical(filePath, errorCode).string();
+	const auto stamp = FileStamp(std::filesystem::last_write_time(filePath, errorCode),
+	                             std::filesystem::file_size(filePath, errorCode));
+
+	if (errorCode || language == clang::Language::Unknown)
+	{
+		return language;
+	}
+
+	auto shared = SharedAST{stamp, GetCommandLine(compilations, filePath), language, std::string()};
+
+	// An AST with errors cannot be loaded, the stages parse such a file themselves.
+	if (!tree->getDiagnostics().hasErrorOccurred())
+	{
+		if (!folderCleared)
+		{
+			std::filesystem::remove_all(SharedASTFolder, errorCode);
+			folderCleared = true;
+		}
+
+		std::filesystem::create_directories(SharedASTFolder, errorCode);
+
+		const auto astFile = std::filesystem::absolute(
+			std::string(SharedASTFolder) + std::to_string(astCount++) + ".ast", errorCode).string();
+
+		// Saving returns true on failure.
+		if (!errorCode && !tree->Save(astFile))
+		{
+			shared.astFile = astFile;
+		}
+	}
+
+	sharedASTs[canonicalPath] = std::move(shared);
+
+	return language;
+}
+
+/**
+ * Runs a frontend action over a source file, reusing the AST built by `DetermineInputLanguage` if the file has not
+ * changed since.\n
+ * The serialized AST is loaded instead of parsing the source again. The consumers of the action get the AST context
+ * and the source manager of the parsed file, the source code is read from the unchanged file.
+ *
+ * @param tool The tool set up for the given file, used if there is no shared AST of the file.
+ * @param compilations The compilation database with which the tool has been created.
+ * @param filePath The path to the source file.
+ * @param factory The factory of the action.
+ * @return The result of the tool's run.
+ */
+int RunOnSharedAST(clang::tooling::ClangTool& tool, const clang::tooling::CompilationDatabase& compilations,
+                   const std::string& filePath, clang::tooling::FrontendActionFactory* factory)
+{
+	const auto* shared = FindSharedAST(compilations, filePath);
+
+	if (shared == nullptr || shared->astFile.empty())
+	{
+		Instrumentation::Count("cache/ast/misses");
+		return tool.run(factory);
+	}
+
+	Instrumentation::Count("cache/ast/hits");
+
+	Out::Verb() << "Using the AST of " << filePath << " parsed by an earlier stage.\n";
+
+	const auto astCompilations = clang::tooling::FixedCompilationDatabase(".", {"-x", "ast"});
+	clang::tooling::ClangTool astTool(astCompilations, {shared->astFile});
+
+	return astTool.run(factory);
+}
+
 //===----------------------------------------------------------------------===//
 //
 /// BitMask helper functions.
@@ -283,24 +532,18 @@ void InitializeBitMask(BitMask& bitMask, size_t number)
 
 /**
  * Merges two maps of bit mask containers.
- * Results are saved to the latter map.
+ * Results are saved to the latter map.\n
+ * The bit masks are moved rather than copied and the containers of the former map are released right away,
+ * so that the merged bit masks are never kept twice.
  *
- * @param from The map from which data is taken.
+ * @param from The map from which data is taken. Its containers are left empty.
  * @param to The map to which data is saved.
  */
 void MergeVectorMaps(EpochRanges& from, EpochRanges& to)
 {
 	for (auto it = from.begin(); it != from.end(); ++it)
 	{
-		const auto toIt = to.insert(*it);
-
-		if (!toIt.second)
-		{
-			auto fromElement = &it->second;
-			auto toElement = &toIt.first->second;
-
-			toElement->insert(toElement->end(), fromElement->begin(), fromElement->end());
-		}
+		to[it->first].Append(std::move(it->second));
 	}
 }
 
@@ -308,18 +551,21 @@ void MergeVectorMaps(EpochRanges& from, EpochRanges& to)
  * Determines whether the bitmask that represents a certain source file variant is valid.\n
  * In order to be valid, it must satisfy the relationships given by the dependency graph.\n
  * If a parent code unit is set zero, so must be its children.\n
- * Code units on the error-inducing line must be present.
+ * Code units on the error-inducing line must be present.\n
+ * Learned dependencies (see `DependencyGraph::LearnFromErrors`) are enforced even without the heuristics.
  *
  * @param bitMask The variant represent by a bitmask.
- * @param dependencies The code unit relationship graph.
+ * @param dependencies The code unit relationship graph. Its character counts must have been calculated already
+ * (see `DependencyGraph::Prepare`), the graph is not modified and can be shared by multiple threads.
  * @param heuristics Specifies whether a dependency graph related heuristics should be used to determine
  * the validity of the variant.
  * @return A pair of values. True if the bitmask results in a valid source file variant in terms of code unit
  * relationships. If valid, the second value is set to the variant's size ratio when compared to the original size.
  */
-std::pair<bool, double> IsValid(const BitMask& bitMask, DependencyGraph& dependencies, const bool heuristics)
+std::pair<bool, double> IsValid(const BitMask& bitMask, const DependencyGraph& dependencies, const bool heuristics)
 {
 	auto characterCount = dependencies.GetTotalCharacterCount();
+	auto buffer = std::vector<int>();
 
 	for (size_t i = 0; i < bitMask.size(); i++)
 	{
@@ -335,7 +581,7 @@ std::pair<bool, double> IsValid(const BitMask& bitMask, DependencyGraph& depende
 
 			if (heuristics)
 			{
-				for (auto child : dependencies.GetDependentNodes(i))
+				for (auto child : dependencies.GetDependentNodes(i, buffer))
 				{
 					// The parent will be removed and there is no point in keeping its children.
 					if (bitMask[child])
@@ -344,12 +590,121 @@ std::pair<bool, double> IsValid(const BitMask& bitMask, DependencyGraph& depende
 					}
 				}
 			}
+
+			for (auto child : dependencies.GetLearnedDependentNodes(i))
+			{
+				// The variant would not compile, the child cannot be kept without its parent.
+				if (static_cast<size_t>(child) < bitMask.size() && bitMask[child])
+				{
+					return std::pair<bool, double>(false, 0);
+				}
+			}
 		}
 	}
 
 	return std::pair<bool, double>(true, static_cast<double>(characterCount) / dependencies.GetTotalCharacterCount());
 }
 
+/**
+ * Encodes the relationships of the code units of a graph into bit masks.
+ *
+ * @param dependencies The code unit relationship graph. Its character counts must have been calculated already.
+ * @param nodeCount The number of code units, at most `MaxEncodedBitMaskSize`.
+ */
+EncodedDependencies::EncodedDependencies(const DependencyGraph& dependencies, const size_t nodeCount) :
+	nodeCount(nodeCount), dependentNodes(nodeCount, 0), learnedNodes(nodeCount, 0), characterCounts(nodeCount, 0),
+	totalCharacters(dependencies.GetTotalCharacterCount())
+{
+	// The first code unit is the most significant bit of the encoded bit mask.
+	const auto bit = [nodeCount](const size_t node)
+	{
+		return static_cast<EncodedBitMask>(1) << (nodeCount - 1 - node);
+	};
+
+	auto buffer = std::vector<int>();
+
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		characterCounts[i] = dependencies.GetNodeInfo(static_cast<int>(i)).characterCount;
+
+		if (dependencies.IsInCriterion(static_cast<int>(i)))
+		{
+			criterion |= bit(i);
+		}
+
+		for (const auto child : dependencies.GetDependentNodes(static_cast<int>(i), buffer))
+		{
+			if (child >= 0 && static_cast<size_t>(child) < nodeCount)
+			{
+				dependentNodes[i] |= bit(child);
+			}
+		}
+
+		for (const auto child : dependencies.GetLearnedDependentNodes(static_cast<int>(i)))
+		{
+			if (child >= 0 && static_cast<size_t>(child) < nodeCount)
+			{
+				learnedNodes[i] |= bit(child);
+			}
+		}
+	}
+}
+
+/**
+ * Determines whether an encoded bitmask is valid, the same way as the `BitMask` overload does.\n
+ * The criterion and the children of each removed code unit are checked against the whole bit mask at once.
+ *
+ * @param bitMask The variant represented by an encoded bitmask.
+ * @param dependencies The encoded code unit relationship graph.
+ * @param heuristics Specifies whether a dependency graph related heuristics should be used to determine
+ * the validity of the variant.
+ * @return A pair of values. True if the bitmask results in a valid source file variant in terms of code unit
+ * relationships. If valid, the second value is set to the variant's size ratio when compared to the original size.
+ */
+std::pair<bool, double> IsValid(const EncodedBitMask bitMask, const EncodedDependencies& dependencies,
+                                const bool heuristics)
+{
+	const auto allBits = dependencies.nodeCount == MaxEncodedBitMaskSize
+		                     ? ~static_cast<EncodedBitMask>(0)
+		                     : (static_cast<EncodedBitMask>(1) << dependencies.nodeCount) - 1;
+	auto removed = ~bitMask & allBits;
+
+	// Criterion nodes should be present.
+	if (removed & dependencies.criterion)
+	{
+		return std::pair<bool, double>(false, 0);
+	}
+
+	auto characterCount = dependencies.totalCharacters;
+
+	for (size_t node = 0; removed != 0; node++)
+	{
+		const auto bit = static_cast<EncodedBitMask>(1) << (dependencies.nodeCount - 1 - node);
+
+		if (!(removed & bit))
+		{
+			continue;
+		}
+
+		removed &= ~bit;
+		characterCount -= dependencies.characterCounts[node];
+
+		// The parent will be removed and there is no point in keeping its children.
+		if (heuristics && (dependencies.dependentNodes[node] & bitMask) != 0)
+		{
+			return std::pair<bool, double>(false, 0);
+		}
+
+		// The variant would not compile, the child cannot be kept without its parent.
+		if ((dependencies.learnedNodes[node] & bitMask) != 0)
+		{
+			return std::pair<bool, double>(false, 0);
+		}
+	}
+
+	return std::pair<bool, double>(true, static_cast<double>(characterCount) / dependencies.totalCharacters);
+}
+
 //===----------------------------------------------------------------------===//
 //
 /// Variant validation helper functions.
@@ -376,33 +731,77 @@ static std::string GetCompilerName(const clang::Language language)
 }
 
 /**
- * Attempts to compile a given source file entry.\n
- * The compilation is done using clang, the source is being compiled to an executable using
- * options that should guarantee debug symbols present in the output.\n
- * The name of the output should correspond to the name of the source file. Its extension is
- * replaced with `.exe`.\n
- * The compilation is considered as a failed one if the compiler returns a non-zero exit code
- * or if the output file was not created.
+ * Determines the debug information emitted for the compiled variants.\n
+ * The fast profile emits only the line tables, which is all the debugger needs to map the error location.
  *
- * @param entry The file system entry for a source code file.
- * @param language The programming language in which the source file is written.
- * @return Zero if the code was successfully compiled, the compiler's different exit code otherwise.
+ * @return The debug information flag of the current `--compile-profile`.
  */
-int Compile(const std::filesystem::directory_entry& entry, const clang::Language language)
+const char* GetDebugInfoFlag()
 {
-	// Create the paths necessary for the compiler driver.
-	const auto input = entry.path().string();
-	const auto output = TempFolder + entry.path().filename().replace_extension(".out").string();
-	const auto clangPath = llvm::sys::findProgramByName(GetCompilerName(language));
+	return CompilationProfile == CompileProfile::Fast ? "-gline-tables-only" : "-g";
+}
 
-	// Compile using debug symbols - trivial arguments, a relaxation of the fully-fledged solution.
-	const auto arguments = std::vector<const char*>{
-		clangPath->c_str(), /*"-v",*/ "-O0", "-g", "-o", output.c_str(), input.c_str()
+/**
+ * Determines the linker options of the current `--compile-profile`.\n
+ * The fast profile links using LLD if it is installed, the system linker is used otherwise.
+ *
+ * @return The options to be passed to the driver when linking.
+ */
+static std::vector<const char*> GetLinkerFlags()
+{
+	static const auto lldAvailable = static_cast<bool>(llvm::sys::findProgramByName("ld.lld"));
+
+	if (CompilationProfile == CompileProfile::Fast && lldAvailable)
+	{
+		return {"-fuse-ld=lld"};
+	}
+
+	return {};
+}
+
+/**
+ * The jobs of a compilation planned by the driver, reused for compiling other files of the same language
+ * with the fast compile profile.\n
+ * The driver detects the toolchain (the target, the GCC installation and the system include directories) each time
+ * it plans a compilation. The template keeps the planned commands together with the paths they have been planned for,
+ * later compilations only substitute the paths.
+ */
+struct CompilationTemplate
+{
+	struct Job
+	{
+		std::string executable;
+		std::vector<std::string> arguments;
+		bool isLinkJob{false};
 	};
 
+	std::vector<Job> jobs;
+	std::string input;
+	std::string output;
+	std::string temporaryObject; ///< The object file passed from the frontend to the linker.
+	std::string diagnostics; ///< The serialized diagnostics file, empty if the diagnostics are not serialized.
+};
+
+static std::map<clang::Language, CompilationTemplate> compilationTemplates;
+
+/**
+ * Runs the clang driver with the given arguments.\n
+ * Diagnostics are printed to the standard output. The jobs of the compilation are run one by one,
+ * so that the time spent in the frontend and the time spent linking are measured separately.
+ *
+ * @param arguments The arguments of the driver, the first one being the path to the compiler.
+ * @param plannedJobs If set, the jobs of the compilation are saved into it, see `CompilationTemplate`.
+ * @return The exit code of the compilation, non-zero if the compilation could not be built.
+ */
+static int RunCompilerDriver(const std::vector<const char*>& arguments, CompilationTemplate* plannedJobs = nullptr)
+{
 	// Create the driver's components.
+	// Diagnostics are buffered so that compilations running in parallel do not interleave their messages.
+	std::string diagnostics;
+	llvm::raw_string_ostream diagnosticStream(diagnostics);
+
 	clang::DiagnosticOptions diagnosticOptions;
-	const auto textDiagnosticPrinter = std::make_unique<clang::TextDiagnosticPrinter>(llvm::outs(), &diagnosticOptions);
+	const auto textDiagnosticPrinter = std::make_unique<clang::TextDiagnosticPrinter>(diagnosticStream, &diagnosticOptions);
 	llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs> diagIDs;
 
 	auto diagnosticsEngine = std::make_unique<clang::DiagnosticsEngine>(diagIDs, &diagnosticOptions,
@@ -414,186 +813,1259 @@ int Compile(const std::filesystem::directory_entry& entry, const clang::Language
 	const auto compilation = std::unique_ptr<clang::driver::Compilation>(driver.BuildCompilation(arguments));
 
 	auto result = 1; // Set the initial value to invalid, since we don't need that lame energy in our lives.
-	llvm::SmallVector<std::pair<int, const clang::driver::Command*>, 16> failingCommands;
 
-	if (compilation)
+	if (compilation && !driver.getDiags().hasErrorOccurred())
 	{
 		// If valid, run the compilation.
-		result = driver.ExecuteCompilation(*compilation, failingCommands);
-	}
+		result = 0;
 
-	llvm::outs() << "\n";
+		if (plannedJobs != nullptr && compilation->getTempFiles().size() == 1)
+		{
+			plannedJobs->temporaryObject = compilation->getTempFiles().front();
 
-	// Determine the result based on whether the output binary exists.
-	if (!std::filesystem::exists(output))
-	{
-		result |= 1;
+			for (const auto& job : compilation->getJobs())
+			{
+				plannedJobs->jobs.push_back({
+					job.getExecutable(),
+					std::vector<std::string>(job.getArguments().begin(), job.getArguments().end()),
+					job.getCreator().isLinkJob()
+				});
+			}
+		}
+
+		for (const auto& job : compilation->getJobs())
+		{
+			Instrumentation::ScopedPhase phase(job.getCreator().isLinkJob() ? "link" : "frontend");
+			const clang::driver::Command* failingCommand = nullptr;
+
+			result = compilation->ExecuteCommand(job, failingCommand);
+
+			if (result != 0)
+			{
+				diagnosticStream << job.getCreator().getShortName() << " command failed with exit code " << result <<
+					".\n";
+
+				// Remove the partial outputs of the failed job, as `Driver::ExecuteCompilation` would.
+				const auto* action = llvm::cast<clang::driver::JobAction>(&job.getSource());
+				compilation->CleanupFileMap(compilation->getResultFiles(), action, true);
+
+				if (result < 0)
+				{
+					compilation->CleanupFileMap(compilation->getFailureResultFiles(), action, true);
+				}
+
+				break;
+			}
+		}
 	}
 
+	Out::All() << diagnosticStream.str() << "\n";
+
 	return result;
 }
 
 /**
- * Check whether a given location specified by a file and a line number exists.\n
- * In case it does, the function prints a context containing of a set number of lines
- * before and after the given location.
+ * Compiles a source file using the jobs planned for another file, see `CompilationTemplate`.\n
+ * The paths of the input, the output, and the intermediate object are replaced in the arguments of each job.
  *
- * @param filePath The file to be checked.
- * @param lineNumber The line in the given file to be checked, numbering starts from 1.
- * @param force Specifies whether the output (the printing part) should be flushed to the All stream or not.
- * @return True if the given file and line combination is accessible, false otherwise.
+ * @param plan The planned jobs.
+ * @param input The path to the source file.
+ * @param output The path to the executable that should be created.
+ * @param diagnostics The path to the serialized diagnostics, used if the planned jobs serialize them.
+ * @return The exit code of the first failing job, zero if all of them succeeded.
  */
-bool CheckLocationValidity(const std::string& filePath, const size_t lineNumber, const bool force)
+static int RunCompilationTemplate(const CompilationTemplate& plan, const std::string& input, const std::string& output,
+                                  const std::string& diagnostics)
 {
-	std::ifstream ifs(filePath);
+	const auto object = TempFolder + std::filesystem::path(output).filename().replace_extension(".o").string();
+	const auto inputName = std::filesystem::path(input).filename().string();
+	const auto plannedInputName = std::filesystem::path(plan.input).filename().string();
 
-	if (!ifs)
+	auto result = 0;
+
+	for (const auto& job : plan.jobs)
 	{
-		return false;
-	}
+		Instrumentation::ScopedPhase phase(job.isLinkJob ? "link" : "frontend");
 
-	// Read all content and split it into lines.
+		auto arguments = std::vector<std::string>{job.executable};
 
-	auto ss = std::stringstream(std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()));
-	auto lines = std::vector<std::string>();
+		for (const auto& argument : job.arguments)
+		{
+			if (argument == plan.input)
+			{
+				arguments.push_back(input);
+			}
+			else if (argument == plan.output)
+			{
+				arguments.push_back(output);
+			}
+			else if (argument == plan.temporaryObject)
+			{
+				arguments.push_back(object);
+			}
+			else if (!plan.diagnostics.empty() && argument == plan.diagnostics)
+			{
+				arguments.push_back(diagnostics);
+			}
+			else if (argument == plannedInputName)
+			{
+				// The `-main-file-name` of the frontend.
+				arguments.push_back(inputName);
+			}
+			else
+			{
+				arguments.push_back(argument);
+			}
+		}
 
-	for (std::string line; std::getline(ss, line);)
-	{
-		lines.emplace_back(line);
-	}
+		const auto argumentReferences = std::vector<llvm::StringRef>(arguments.begin(), arguments.end());
 
-	if (lineNumber > lines.size())
-	{
-		return false;
+		result = llvm::sys::ExecuteAndWait(job.executable, argumentReferences);
+
+		if (result != 0)
+		{
+			Out::All() << llvm::sys::path::filename(job.executable) << " command failed with exit code " << result <<
+				".\n";
+			break;
+		}
 	}
 
-	// Print the context of the error-inducing line.
+	std::error_code error;
+	std::filesystem::remove(object, error);
 
-	const auto contextSize = 3;
-	const auto contextStart = lineNumber - contextSize > 0 ? lineNumber - contextSize : 1;
-	const auto contextEnd = lineNumber + contextSize < lines.size() ? lineNumber + contextSize : lines.size();
+	return result;
+}
 
-	if (force)
+/**
+ * Collects the errors of a source file from the diagnostics serialized by the compiler (`-serialize-diagnostics`).\n
+ * The compiler runs in a separate process, the serialized diagnostics keep the locations and the messages
+ * without parsing its output.
+ */
+class CompilationErrorReader final : public clang::serialized_diags::SerializedDiagnosticReader
+{
+	std::string fileName_;
+	std::unordered_map<unsigned, std::string> files_;
+	std::vector<CompilationError>& errors_;
+
+protected:
+	std::error_code visitFilenameRecord(const unsigned id, unsigned /*size*/, unsigned /*timestamp*/,
+	                                    const llvm::StringRef name) override
 	{
-		Out::All() << "===---------------- Context of the error-inducing line ------------------===\n";
+		files_[id] = llvm::sys::path::filename(name).str();
+
+		return {};
+	}
+
+	std::error_code visitDiagnosticRecord(const unsigned severity, const clang::serialized_diags::Location& location,
+	                                      unsigned /*category*/, unsigned /*flag*/,
+	                                      const llvm::StringRef message) override
+	{
+		if (severity != clang::serialized_diags::Error && severity != clang::serialized_diags::Fatal)
+		{
+			return {};
+		}
+
+		// Only the errors located in the compiled file itself can be mapped to its code units.
+		const auto it = files_.find(location.FileID);
+
+		if (it != files_.end() && it->second == fileName_)
+		{
+			errors_.push_back({location.Line, message.str()});
+		}
+
+		return {};
+	}
+
+public:
+	/**
+	 * @param sourceFile The path to the compiled source file.
+	 * @param errors The container to which the errors are added.
+	 */
+	CompilationErrorReader(const std::string& sourceFile, std::vector<CompilationError>& errors) :
+		fileName_(llvm::sys::path::filename(sourceFile).str()), errors_(errors)
+	{
+	}
+};
+
+/**
+ * Attempts to compile a given source file entry.\n
+ * The compilation is done using clang, the source is being compiled to an executable using
+ * options that should guarantee debug symbols present in the output.\n
+ * The name of the output should correspond to the name of the source file. Its extension is
+ * replaced with `.exe`.\n
+ * The compilation is considered as a failed one if the compiler returns a non-zero exit code
+ * or if the output file was not created.\n
+ * With `--incremental-compilation`, the file is compiled function by function, see `Incremental::CompileIncrementally`.
+ * With `--compile-profile=fast`, the jobs planned for the first compiled file are reused, see `CompilationTemplate`.
+ * With `--learn-dependencies`, the diagnostics of the whole-file compilation are serialized and its errors are
+ * collected, see `DependencyGraph::LearnFromErrors`.
+ *
+ * @param entry The file system entry for a source code file.
+ * @param language The programming language in which the source file is written.
+ * @param errors If set, the errors of a failed compilation are added to it.
+ * @return Zero if the code was successfully compiled, the compiler's different exit code otherwise.
+ */
+int Compile(const std::filesystem::directory_entry& entry, const clang::Language language,
+            std::vector<CompilationError>* errors)
+{
+	// Create the paths necessary for the compiler driver.
+	const auto input = entry.path().string();
+	const auto output = TempFolder + entry.path().filename().replace_extension(".out").string();
+	const auto diagnostics = LearnDependencies
+		                         ? TempFolder + entry.path().filename().replace_extension(".dia").string()
+		                         : std::string();
+
+	// Reads the serialized errors once the compilation has finished.
+	const auto collectErrors = [&input, &diagnostics, errors](const int result)
+	{
+		if (diagnostics.empty())
+		{
+			return;
+		}
+
+		if (result != 0 && errors != nullptr && std::filesystem::exists(diagnostics))
+		{
+			CompilationErrorReader(input, *errors).readDiagnostics(diagnostics);
+		}
+
+		std::error_code error;
+		std::filesystem::remove(diagnostics, error);
+	};
+
+	if (IncrementalCompilation)
+	{
+		if (const auto result = Incremental::CompileIncrementally(input, output, language))
+		{
+			return *result;
+		}
+	}
+
+	const auto fastProfile = CompilationProfile == CompileProfile::Fast;
+	const auto plannedJobs = compilationTemplates.find(language);
+
+	if (fastProfile && plannedJobs != compilationTemplates.end())
+	{
+		auto result = RunCompilationTemplate(plannedJobs->second, input, output, diagnostics);
+
+		if (!std::filesystem::exists(output))
+		{
+			result |= 1;
+		}
+
+		collectErrors(result);
+
+		return result;
+	}
+
+	const auto clangPath = llvm::sys::findProgramByName(GetCompilerName(language));
+
+	// Compile using debug symbols - trivial arguments, a relaxation of the fully-fledged solution.
+	auto arguments = std::vector<const char*>{clangPath->c_str(), /*"-v",*/ "-O0", GetDebugInfoFlag()};
+
+	for (const auto* flag : GetLinkerFlags())
+	{
+		arguments.push_back(flag);
+	}
+
+	if (!diagnostics.empty())
+	{
+		arguments.insert(arguments.end(), {"-serialize-diagnostics", diagnostics.c_str()});
+	}
+
+	arguments.insert(arguments.end(), {"-o", output.c_str(), input.c_str()});
+
+	auto plan = CompilationTemplate{{}, input, output, {}, diagnostics};
+	auto result = RunCompilerDriver(arguments, fastProfile ? &plan : nullptr);
+
+	// Only a successful compilation is known to have planned all of its jobs.
+	if (fastProfile && result == 0 && !plan.jobs.empty())
+	{
+		compilationTemplates[language] = plan;
+	}
+
+	// Determine the result based on whether the output binary exists.
+	if (!std::filesystem::exists(output))
+	{
+		result |= 1;
+	}
+
+	collectErrors(result);
+
+	return result;
+}
+
+/**
+ * Compiles a single translation unit of a project into an object file.\n
+ * The unit's own flags are used first, debug symbols and no optimizations are then enforced.
+ *
+ * @param input The path to the source file.
+ * @param output The path to the object file that should be created.
+ * @param language The programming language in which the source file is written.
+ * @param flags The compilation flags of the translation unit, as returned by `GetStandaloneCompileFlags`.
+ * @return Zero if the object file was created, the compiler's different exit code otherwise.
+ */
+int CompileToObject(const std::string& input, const std::string& output, const clang::Language language,
+                    const std::vector<std::string>& flags)
+{
+	const auto clangPath = llvm::sys::findProgramByName(GetCompilerName(language));
+
+	auto arguments = std::vector<const char*>{clangPath->c_str()};
+
+	for (const auto& flag : flags)
+	{
+		arguments.push_back(flag.c_str());
+	}
+
+	arguments.insert(arguments.end(), {"-O0", GetDebugInfoFlag(), "-c", "-o", output.c_str(), input.c_str()});
+
+	auto result = RunCompilerDriver(arguments);
+
+	if (!std::filesystem::exists(output))
+	{
+		result |= 1;
+	}
+
+	return result;
+}
+
+/**
+ * Links the given object files into an executable.
+ *
+ * @param objects The paths to the object files.
+ * @param output The path to the executable that should be created.
+ * @param language The language whose compiler driver should be used for linking (C++ adds its runtime).
+ * @param flags Additional linker flags, e.g., libraries.
+ * @return Zero if the executable was created, the linker's different exit code otherwise.
+ */
+int LinkObjects(const std::vector<std::string>& objects, const std::string& output, const clang::Language language,
+                const std::vector<std::string>& flags)
+{
+	const auto clangPath = llvm::sys::findProgramByName(GetCompilerName(language));
+
+	auto arguments = std::vector<const char*>{clangPath->c_str(), "-o", output.c_str()};
+
+	for (const auto& object : objects)
+	{
+		arguments.push_back(object.c_str());
+	}
+
+	for (const auto& flag : flags)
+	{
+		arguments.push_back(flag.c_str());
+	}
+
+	for (const auto* flag : GetLinkerFlags())
+	{
+		arguments.push_back(flag);
+	}
+
+	auto result = RunCompilerDriver(arguments);
+
+	if (!std::filesystem::exists(output))
+	{
+		result |= 1;
+	}
+
+	return result;
+}
+
+/**
+ * Compiles a single C source file into a shared library, e.g., the stub of the fork server.
+ *
+ * @param input The path to the source file.
+ * @param output The path to the library that should be created.
+ * @return Zero if the library was created, the compiler's different exit code otherwise.
+ */
+int CompileSharedLibrary(const std::string& input, const std::string& output)
+{
+	const auto clangPath = llvm::sys::findProgramByName(GetCompilerName(clang::Language::C));
+
+	const auto arguments = std::vector<const char*>{
+		clangPath->c_str(), "-O2", "-shared", "-fPIC", "-o", output.c_str(), input.c_str(), "-ldl"
+	};
+
+	auto result = RunCompilerDriver(arguments);
+
+	if (!std::filesystem::exists(output))
+	{
+		result |= 1;
+	}
+
+	return result;
+}
+
+/**
+ * Builds the executable of a project in which the currently reduced translation unit is replaced by a variant.\n
+ * Only the variant is compiled, the remaining units are linked in using their current object files.
+ * Objects are cached by their source code and flags, so a variant identical to an already compiled one
+ * is not compiled again.\n
+ * The name of the executable corresponds to the name of the variant, its extension is replaced with `.out`.
+ *
+ * @param globalContext The context containing the project data.
+ * @param entry The file system entry for the variant of the active translation unit.
+ * @return Zero if the project was successfully built, a non-zero value otherwise.
+ */
+int CompileProject(GlobalContext& globalContext, const std::filesystem::directory_entry& entry)
+{
+	auto& project = globalContext.deltaContext.project;
+	auto& unit = project.ActiveUnit();
+
+	std::ifstream ifs(entry.path());
+	auto key = std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+	for (const auto& flag : unit.compileFlags)
+	{
+		key += '\0' + flag;
+	}
+
+	auto object = TempFolder + entry.path().filename().replace_extension(".o").string();
+
+	if (const auto cached = project.objectCache.find(key); cached != project.objectCache.end() && std::filesystem::
+		exists(cached->second))
+	{
+		Instrumentation::Count("cache/objects/hits");
+
+		Out::Verb() << "Reusing the object file " << cached->second << ".\n";
+		object = cached->second;
 	}
 	else
 	{
-		Out::Verb() << "===---------------- Context of the error-inducing line ------------------===\n";
+		Instrumentation::Count("cache/objects/misses");
+
+		if (CompileToObject(entry.path().string(), object, unit.language, unit.compileFlags) != 0)
+		{
+			return 1;
+		}
+
+		project.objectCache[std::move(key)] = object;
 	}
 
-	for (auto i = contextStart; i <= contextEnd; i++)
+	project.variantObjects[entry.path().string()] = object;
+
+	auto objects = std::vector<std::string>();
+	auto linkLanguage = clang::Language::C;
+
+	for (size_t i = 0; i < project.units.size(); i++)
 	{
-		if (force)
+		objects.push_back(i == project.activeUnit ? object : project.units[i].currentObject);
+
+		if (project.units[i].language == clang::Language::CXX)
 		{
-			Out::All() << (i != lineNumber ? "    " : "[*] ") << i << ": " << lines[i - 1] << "\n";
+			linkLanguage = clang::Language::CXX;
 		}
-		else
+	}
+
+	const auto output = TempFolder + entry.path().filename().replace_extension(".out").string();
+
+	return LinkObjects(objects, output, linkLanguage, project.linkFlags);
+}
+
+/**
+ * Converts a compile command of a compilation database into flags usable for compiling the unit's variants.\n
+ * Variants are placed in a different directory, so the compiler, the input, and the output are dropped,
+ * relative paths in include options are made absolute, and the original file's directory is added to
+ * the include paths.
+ *
+ * @param command The compile command of a translation unit.
+ * @return The flags that can be passed to the compiler along with any variant of the unit.
+ */
+std::vector<std::string> GetStandaloneCompileFlags(const clang::tooling::CompileCommand& command)
+{
+	const auto directory = std::filesystem::path(command.Directory);
+	const auto sourcePath = std::filesystem::absolute(directory / command.Filename).lexically_normal();
+	const auto pathOptions = std::vector<std::string>{"-I", "-isystem", "-iquote", "-idirafter", "-include"};
+
+	const auto makeAbsolute = [&directory](const std::string& path)
+	{
+		return std::filesystem::path(path).is_absolute()
+			       ? path
+			       : std::filesystem::absolute(directory / path).lexically_normal().string();
+	};
+
+	auto flags = std::vector<std::string>{"-I" + sourcePath.parent_path().string()};
+
+	// The first element is the compiler itself.
+	for (size_t i = 1; i < command.CommandLine.size(); i++)
+	{
+		const auto& argument = command.CommandLine[i];
+
+		if (argument == "-c" || argument == "--")
 		{
-			Out::Verb() << (i != lineNumber ? "    " : "[*] ") << i << ": " << lines[i - 1] << "\n";
+			continue;
+		}
+
+		if (argument == "-o")
+		{
+			i++;
+			continue;
+		}
+
+		if (argument.rfind("-o", 0) == 0 || argument == command.Filename || (argument[0] != '-' &&
+			std::filesystem::absolute(directory / argument).lexically_normal() == sourcePath))
+		{
+			continue;
+		}
+
+		auto handled = false;
+
+		for (const auto& option : pathOptions)
+		{
+			if (argument == option && i + 1 < command.CommandLine.size())
+			{
+				flags.push_back(option);
+				flags.push_back(makeAbsolute(command.CommandLine[++i]));
+				handled = true;
+				break;
+			}
+
+			// Only the short -I form can be joined with its value.
+			if (option == "-I" && argument.rfind(option, 0) == 0 && argument.size() > option.size())
+			{
+				flags.push_back(option + makeAbsolute(argument.substr(option.size())));
+				handled = true;
+				break;
+			}
+		}
+
+		if (!handled)
+		{
+			flags.push_back(argument);
 		}
 	}
 
-	if (force)
+	return flags;
+}
+
+/**
+ * Check whether a given location specified by a file and a line number exists.\n
+ * In case it does, the function prints a context containing of a set number of lines
+ * before and after the given location.
+ *
+ * @param filePath The file to be checked.
+ * @param lineNumber The line in the given file to be checked, numbering starts from 1.
+ * @param force Specifies whether the output (the printing part) should be flushed to the All stream or not.
+ * @return True if the given file and line combination is accessible, false otherwise.
+ */
+bool CheckLocationValidity(const std::string& filePath, const size_t lineNumber, const bool force)
+{
+	std::ifstream ifs(filePath);
+
+	if (!ifs)
+	{
+		return false;
+	}
+
+	// Read all content and split it into lines.
+
+	auto ss = std::stringstream(std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()));
+	auto lines = std::vector<std::string>();
+
+	for (std::string line; std::getline(ss, line);)
+	{
+		lines.emplace_back(line);
+	}
+
+	if (lineNumber > lines.size())
+	{
+		return false;
+	}
+
+	// Print the context of the error-inducing line.
+
+	const auto contextSize = 3;
+	const auto contextStart = lineNumber - contextSize > 0 ? lineNumber - contextSize : 1;
+	const auto contextEnd = lineNumber + contextSize < lines.size() ? lineNumber + contextSize : lines.size();
+
+	if (force)
+	{
+		Out::All() << "===---------------- Context of the error-inducing line ------------------===\n";
+	}
+	else
+	{
+		Out::Verb() << "===---------------- Context of the error-inducing line ------------------===\n";
+	}
+
+	for (auto i = contextStart; i <= contextEnd; i++)
+	{
+		if (force)
+		{
+			Out::All() << (i != lineNumber ? "    " : "[*] ") << i << ": " << lines[i - 1] << "\n";
+		}
+		else
+		{
+			Out::Verb() << (i != lineNumber ? "    " : "[*] ") << i << ": " << lines[i - 1] << "\n";
+		}
+	}
+
+	if (force)
+	{
+		Out::All() << "===----------------------------------------------------------------------===\n";
+	}
+	else
+	{
+		Out::Verb() << "===----------------------------------------------------------------------===\n";
+	}
+
+	return true;
+}
+
+template <typename Out>
+void SplitToWords(const std::string& s, const char delimiter, Out result)
+{
+	std::istringstream iss(s);
+	std::string word;
+
+	while (std::getline(iss, word, delimiter))
+	{
+		*result++ = word;
+	}
+}
+
+/**
+ * Separates a given string into a container strings based on a given delimiter.
+ *
+ * @param s The string to be split.
+ * @param delimiter The character that is taken into consideration when splitting.
+ */
+std::vector<std::string> SplitToWords(const std::string& s, const char delimiter)
+{
+	std::vector<std::string> words;
+
+	SplitToWords(s, delimiter, std::back_inserter(words));
+
+	return words;
+}
+
+/**
+ * Checks whether a given message roughly corresponds to the error message
+ * specified in the program's options.\n
+ * The validation is done by checking whether the current message contains
+ * parts of the original. Any part suffices.
+ *
+ * @param currentMessage The message in which we search for parts of
+ * the original.
+ * @return True if at least a part of the original was found, false otherwise.
+ */
+static bool IsErrorMessageValid(const std::string& currentMessage)
+{
+	auto original = std::string(ErrorMessage);
+	auto actual = std::string(currentMessage);
+
+	// Convert both to the same case
+	std::for_each(original.begin(), original.end(), [](char& c)
+	{
+		c = std::tolower(c);
+	});
+
+	std::for_each(actual.begin(), actual.end(), [](char& c)
+	{
+		c = std::tolower(c);
+	});
+
+	auto messageParts = SplitToWords(original, ' ');
+
+	// Check the parts of the original message.
+	for (auto& part : messageParts)
+	{
+		if (actual.find(part) != std::string::npos)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Runs a given executable in the LLDB debugger.\n
+ * Every time the execution stops, we check the location of the current symbol and
+ * the generated message.\n
+ * If both correspond, we terminate positively.
+ * Otherwise, the search is inconclusive.
+ * Note that the LLDB runtime has a set timeout that can only be changed inside the code.
+ *
+ * @param executable The path to the executable.
+ * @param presumedErrorLines The lines on which the error is expected.
+ * @param presumedErrorFile The name of the file in which the error is expected, empty for any file.
+ * @param environment A null-terminated list of `NAME=value` entries added to the environment of the process,
+ * null if the environment should be inherited as is.
+ * @return True if the execution ends in the desired runtime error, false otherwise.
+ */
+static bool DebugExecutable(const std::string& executable, const std::vector<size_t>& presumedErrorLines,
+                            const std::string& presumedErrorFile, const char** environment)
+{
+	// Keep all LLDB logic written explicitly in this function, not refactored further.
+	// The function could be called when the LLDBSentry is not initialized => unwanted behaviour.
+	// Having this function is a risk already...
+
+	// The time spent creating the debugger, the target and the process is measured apart from the execution.
+	auto debuggingPhase = std::optional<Instrumentation::ScopedPhase>();
+	debuggingPhase.emplace("debugger");
+
+	// Create a debugger object - represents an instance of LLDB.
+	auto debugger(lldb::SBDebugger::Create());
+
+	if (!debugger.IsValid())
+	{
+		llvm::errs() << "Debugger could not be created.\n";
+		exit(EXIT_FAILURE);
+	}
+
+	const char* argv[] = {Arguments.c_str(), nullptr};
+
+	lldb::SBError error;
+	lldb::SBLaunchInfo launchInfo(argv);
+
+	launchInfo.SetWorkingDirectory(TempFolder);
+	launchInfo.SetLaunchFlags(lldb::eLaunchFlagExec | lldb::eLaunchFlagDebug);
+
+	if (environment != nullptr)
+	{
+		launchInfo.SetEnvironmentEntries(environment, true);
+	}
+
+	Out::Verb() << "\nLLDB Target creation for " << executable << " ...\n";
+
+	// Create and launch a target - represents a debugging session of a single executable.
+	// Launching creates a new process in which the executable is ran.
+	auto target = debugger.CreateTarget(executable.c_str(), llvm::sys::getDefaultTargetTriple().c_str(), "", true,
+	                                    error);
+
+	Out::Verb() << "error.Success()              = " << static_cast<int>(error.Success()) << "\n";
+	Out::Verb() << "target.IsValid()             = " << static_cast<int>(target.IsValid()) << "\n";
+
+	Out::Verb() << "\nLLDB Process launch ...\n";
+
+	auto process = target.Launch(launchInfo, error);
+	Out::Verb() << "error.Success()              = " << static_cast<int>(error.Success()) << "\n";
+	Out::Verb() << "process.IsValid()            = " << static_cast<int>(process.IsValid()) << "\n";
+	Out::Verb() << "process.GetProcessID()       = " << process.GetProcessID() << "\n";
+	Out::Verb() << "process.GetState()           = " << StateToString(process.GetState()) << "\n";
+	Out::Verb() << "process.GetNumThreads()      = " << process.GetNumThreads() << "\n";
+
+	auto listener = debugger.GetListener();
+	Out::Verb() << "listener.IsValid()           = " << static_cast<int>(listener.IsValid()) << "\n";
+
+	auto done = false;
+	auto locationFound = false;
+	// The timeout is currently set to 30 seconds for EACH event, not the entire run.
+	const auto timeOut = 30;
+
+	debuggingPhase.reset();
+	debuggingPhase.emplace("execution");
+
+	// The debugger is set to run asynchronously (debugger.GetAsync() => true).
+	// The communication is done via events. Listen for events broadcast by the forked process.
+	// Events are handled depending on the state of the process, the most important is `eStateStopped`
+	// (stopped at a breakpoint, such as an exception) and `eStateExited` (ran without errors).
+	while (!done)
+	{
+		lldb::SBEvent event;
+
+		if (listener.WaitForEvent(timeOut /*seconds*/, event))
+		{
+			if (lldb::SBProcess::EventIsProcessEvent(event))
+			{
+				const auto state = lldb::SBProcess::GetStateFromEvent(event);
+
+				if (state == lldb::eStateInvalid)
+				{
+					Out::Verb() << "Invalid process event: " << StateToString(state) << "\n";
+				}
+				else
+				{
+					Out::Verb() << "Process state event changed to: " << StateToString(state) << "\n";
+
+					if (state == lldb::eStateStopped)
+					{
+						// The debugger stopped at a breakpoint. Since no breakpoints were set, this is most likely an exception.
+						// Analyze the current stack frame to determine the status and position of the error.
+
+						Out::Verb() << "Stopped at a breakpoint.\n";
+						Out::Verb() << "LLDB Threading ...\n";
+
+						auto thread = process.GetSelectedThread();
+						Out::Verb() << "thread.IsValid()             = " << static_cast<int>(thread.IsValid()) << "\n";
+						Out::Verb() << "thread.GetThreadID()         = " << thread.GetThreadID() << "\n";
+						Out::Verb() << "thread.GetName()             = " << (thread.GetName() != nullptr
+							                                                     ? thread.GetName()
+							                                                     : "(null)") << "\n";
+						Out::Verb() << "thread.GetStopReason()       = " << StopReasonToString(thread.GetStopReason())
+							<<
+							"\n";
+						Out::Verb() << "thread.IsSuspended()         = " << static_cast<int>(thread.IsSuspended()) <<
+							"\n";
+						Out::Verb() << "thread.IsStopped()           = " << static_cast<int>(thread.IsStopped()) <<
+							"\n";
+						Out::Verb() << "process.GetState()           = " << StateToString(process.GetState()) << "\n";
+
+						if (thread.GetStopReason() == lldb::StopReason::eStopReasonException)
+						{
+							Out::Verb() << "An exception was hit, killing the process ...\n";
+							done = true;
+						}
+
+						auto frame = thread.GetSelectedFrame();
+						Out::Verb() << "frame.IsValid()              = " << static_cast<int>(frame.IsValid()) << "\n";
+
+						auto function = frame.GetFunction();
+
+						if (function.IsValid())
+						{
+							Out::Verb() << "function.GetDisplayName()   = " << (function.GetDisplayName() != nullptr
+								                                                    ? function.GetDisplayName()
+								                                                    : "(null)") << "\n";
+						}
+
+						auto symbol = frame.GetSymbol();
+						Out::Verb() << "symbol.IsValid()             = " << static_cast<int>(symbol.IsValid()) << "\n";
+
+						if (symbol.IsValid())
+						{
+							Out::Verb() << "symbol.GetDisplayName()      = " << symbol.GetDisplayName() << "\n";
+
+							auto symbolContext = frame.GetSymbolContext(lldb::eSymbolContextLineEntry);
+
+							Out::Verb() << "symbolContext.IsValid()      = " << static_cast<int>(symbolContext.IsValid()
+								)
+								<< "\n";
+
+							if (symbolContext.IsValid())
+							{
+								const auto fileName = symbolContext.GetLineEntry().GetFileSpec().GetFilename();
+								const auto lineNumber = symbolContext.GetLineEntry().GetLine();
+
+								Out::Verb() << "symbolContext.GetFilename()  = " << fileName << "\n";
+								Out::Verb() << "symbolContext.GetLine()      = " << lineNumber << "\n";
+								Out::Verb() << "symbolContext.GetColumn()    = " << symbolContext
+								                                                    .GetLineEntry().GetColumn() << "\n";
+
+								// Iterate over all possible error-inducing lines (the original, plus function decl body)
+								// and determine whether the current location is correct.
+								for (auto presumedErrorLine : presumedErrorLines)
+								{
+									if (lineNumber == presumedErrorLine && (presumedErrorFile.empty() || (fileName !=
+										nullptr && presumedErrorFile == fileName)))
+									{
+										auto stream = lldb::SBStream();
+										thread.GetStatus(stream);
+
+										Out::Verb() << "stream.IsValid()              = " << static_cast<int>(stream.
+											IsValid()) << "\n";
+
+										// The location was correct, validate the message - the runtime error must
+										// be the same.
+										locationFound = true;
+
+										if (stream.IsValid())
+										{
+											const auto currentMessage = stream.GetData();
+
+											Out::Verb() << "stream.GetData()              = " << currentMessage << "\n";
+
+											if (IsErrorMessageValid(currentMessage))
+											{
+												Instrumentation::Count("variants/accepted");
+												return true;
+											}
+										}
+
+										break;
+									}
+								}
+							}
+						}
+
+						process.Continue();
+					}
+					else if (state == lldb::eStateExited)
+					{
+						Out::Verb() << "Process exited.\n";
+
+						auto description = process.GetExitDescription();
+
+						if (description != nullptr)
+						{
+							Out::Verb() << "Exit status " << process.GetExitStatus() << ":" << description << "\n";
+						}
+						else
+						{
+							Out::Verb() << "Exit status " << process.GetExitStatus() << "\n";
+						}
+
+						done = true;
+					}
+					else if (state == lldb::eStateCrashed)
+					{
+						Out::Verb() << "Process crashed.\n";
+						done = true;
+					}
+					else if (state == lldb::eStateDetached)
+					{
+						Out::Verb() << "Process detached.\n";
+						done = true;
+					}
+					else if (state == lldb::eStateUnloaded)
+					{
+						Out::Verb() << "ERROR: Process unloaded!\n";
+						done = true;
+					}
+					else if (state == lldb::eStateConnected)
+					{
+						Out::Verb() << "Process connected.\n";
+					}
+					else if (state == lldb::eStateAttaching)
+					{
+						Out::Verb() << "Process attaching.\n";
+					}
+					else if (state == lldb::eStateLaunching)
+					{
+						Out::Verb() << "Process launching.\n";
+					}
+				}
+			}
+			else
+			{
+				Out::Verb() << "Event: " << lldb::SBEvent::GetCStringFromEvent(event) << "\n";
+			}
+		}
+		else
+		{
+			Out::Verb() << "Process event has not occured in the last" << timeOut <<
+				" seconds, killing the process ...\n";
+			done = true;
+		}
+	}
+
+	Instrumentation::Count(locationFound ? "rejected/message" : "rejected/location");
+
+	debuggingPhase.reset();
+	debuggingPhase.emplace("debugger");
+
+	// Clean up.
+	process.Kill();
+	debugger.DeleteTarget(target);
+	lldb::SBDebugger::Destroy(debugger);
+
+	return false;
+}
+
+/**
+ * Determines whether a crash observed without the debugger (see `RunInForkServer` and `CompileAndRunInJit`)
+ * reproduces the error, i.e., whether it occurred on one of the presumed lines and its signal corresponds
+ * to the error message.
+ *
+ * @param fileName The name of the file containing the crashing instruction, null if it is unknown.
+ * @param lineNumber The line of the crashing instruction.
+ * @param signal The signal that terminated the process.
+ * @param presumedErrorLines The lines on which the error is expected.
+ * @param presumedErrorFile The name of the file in which the error is expected, empty for any file.
+ * @return True if the crash reproduces the error, false otherwise.
+ */
+static bool IsCrashReproducingError(const char* fileName, const size_t lineNumber, const int signal,
+                                    const std::vector<size_t>& presumedErrorLines,
+                                    const std::string& presumedErrorFile)
+{
+	Out::Verb() << "Process crashed at " << (fileName != nullptr ? fileName : "(null)") << ":" << lineNumber << "\n";
+
+	for (auto presumedErrorLine : presumedErrorLines)
+	{
+		if (lineNumber == presumedErrorLine && (presumedErrorFile.empty() || (fileName != nullptr && presumedErrorFile
+			== fileName)))
+		{
+			const auto currentMessage = Execution::DescribeSignal(signal);
+
+			Out::Verb() << "Process message: " << currentMessage << "\n";
+
+			if (IsErrorMessageValid(currentMessage))
+			{
+				Instrumentation::Count("variants/accepted");
+				return true;
+			}
+
+			Instrumentation::Count("rejected/message");
+			return false;
+		}
+	}
+
+	Instrumentation::Count("rejected/location");
+	return false;
+}
+
+/**
+ * The fork server of the executable that was run last, together with the LLDB target used to map its crashes
+ * to source lines. The server is replaced whenever a different executable (or a rebuilt one) is run.
+ */
+struct ForkServerSession
+{
+	std::unique_ptr<Execution::ForkServer> server;
+	std::filesystem::file_time_type modificationTime;
+	lldb::SBDebugger debugger;
+	lldb::SBTarget target;
+	lldb::addr_t headerAddress{0}; ///< The file address of the executable's header, i.e., of its load address.
+};
+
+static std::unique_ptr<ForkServerSession> forkServerSession;
+
+/**
+ * Set once the fork server stub could not be prepared, the LLDB is then used for the rest of the run.\n
+ * A server that fails to start for a particular executable only falls back to the LLDB for that executable.
+ */
+static bool forkServerUnavailable = false;
+
+/**
+ * Stops the fork server and releases its LLDB target. Must be called before the LLDB is terminated.
+ */
+void StopForkServer()
+{
+	if (forkServerSession)
+	{
+		forkServerSession->server.reset();
+		forkServerSession->debugger.DeleteTarget(forkServerSession->target);
+		lldb::SBDebugger::Destroy(forkServerSession->debugger);
+		forkServerSession.reset();
+	}
+}
+
+/**
+ * Retrieves the fork server of a given executable, starting it if necessary.
+ *
+ * @param executable The path to the executable.
+ * @return The session of the running server, null if the server could not be started.
+ */
+static ForkServerSession* GetForkServerSession(const std::string& executable)
+{
+	std::error_code error;
+	const auto modificationTime = std::filesystem::last_write_time(executable, error);
+
+	if (forkServerSession && forkServerSession->server->GetExecutable() == executable && forkServerSession->
+		modificationTime == modificationTime && forkServerSession->server->IsRunning())
+	{
+		return forkServerSession.get();
+	}
+
+	StopForkServer();
+
+	if (forkServerUnavailable)
+	{
+		return nullptr;
+	}
+
+	if (!Execution::ForkServer::IsSupported())
+	{
+		Out::All() << "The fork server cannot be used on this system, the LLDB is used instead.\n";
+		forkServerUnavailable = true;
+		return nullptr;
+	}
+
+	auto session = std::make_unique<ForkServerSession>();
+	session->server = std::make_unique<Execution::ForkServer>(executable);
+	session->modificationTime = modificationTime;
+
+	if (!session->server->IsRunning())
+	{
+		Instrumentation::Count("fork-server/fallbacks");
+		return nullptr;
+	}
+
+	// The target is only used for the symbolication, no process is launched.
+	lldb::SBError lldbError;
+	session->debugger = lldb::SBDebugger::Create();
+	session->target = session->debugger.CreateTarget(executable.c_str(),
+	                                                 llvm::sys::getDefaultTargetTriple().c_str(), "", false, lldbError);
+
+	if (!session->target.IsValid())
+	{
+		Out::All() << "The LLDB target of '" << executable << "' could not be created, the LLDB is used instead.\n";
+		lldb::SBDebugger::Destroy(session->debugger);
+		Instrumentation::Count("fork-server/fallbacks");
+		return nullptr;
+	}
+
+	session->headerAddress = session->target.GetModuleAtIndex(0).GetObjectFileHeaderAddress().GetFileAddress();
+	forkServerSession = std::move(session);
+
+	return forkServerSession.get();
+}
+
+/**
+ * Runs a given executable in the fork server, see `Execution::ForkServer`.\n
+ * The crashing instruction is mapped to a source line using the debug information of the executable,
+ * the error is reproduced if the line and the description of the signal match the criterion.
+ *
+ * @param executable The path to the executable.
+ * @param presumedErrorLines The lines on which the error is expected.
+ * @param presumedErrorFile The name of the file in which the error is expected, empty for any file.
+ * @param environment The `NAME=value` entries added to the environment of the process.
+ * @return True if the execution ends in the desired runtime error, false if it does not,
+ * empty if the fork server could not be used.
+ */
+static std::optional<bool> RunInForkServer(const std::string& executable,
+                                           const std::vector<size_t>& presumedErrorLines,
+                                           const std::string& presumedErrorFile,
+                                           const std::vector<std::string>& environment)
+{
+	const auto session = GetForkServerSession(executable);
+
+	if (session == nullptr)
 	{
-		Out::All() << "===----------------------------------------------------------------------===\n";
+		return std::nullopt;
 	}
-	else
+
+	Instrumentation::ScopedPhase executionPhase("execution");
+
+	// The same timeout as the one of the LLDB events.
+	const auto timeOut = 30;
+	const auto result = session->server->Run(environment, timeOut);
+
+	executionPhase.Stop();
+
+	if (!result.has_value())
 	{
-		Out::Verb() << "===----------------------------------------------------------------------===\n";
+		return std::nullopt;
 	}
 
-	return true;
-}
+	Instrumentation::Count("fork-server/runs");
 
-template <typename Out>
-void SplitToWords(const std::string& s, const char delimiter, Out result)
-{
-	std::istringstream iss(s);
-	std::string word;
+	if (result->timedOut || result->signal == 0)
+	{
+		Out::Verb() << "Process exited with status " << result->exitCode << ".\n";
+		Instrumentation::Count("rejected/location");
+		return false;
+	}
 
-	while (std::getline(iss, word, delimiter))
+	if (!result->crashedInExecutable)
 	{
-		*result++ = word;
+		Out::Verb() << "Process crashed outside of the executable: " << Execution::DescribeSignal(result->signal) <<
+			"\n";
+		Instrumentation::Count("rejected/location");
+		return false;
 	}
+
+	const auto address = session->target.ResolveFileAddress(session->headerAddress + result->crashOffset);
+	const auto lineEntry = address.GetLineEntry();
+
+	return IsCrashReproducingError(lineEntry.GetFileSpec().GetFilename(), lineEntry.GetLine(), result->signal,
+	                               presumedErrorLines, presumedErrorFile);
 }
 
 /**
- * Separates a given string into a container strings based on a given delimiter.
+ * Runs a given executable using the `--executor` backend, see `DebugExecutable` and `RunInForkServer`.\n
+ * The LLDB is used whenever the fork server cannot be.
  *
- * @param s The string to be split.
- * @param delimiter The character that is taken into consideration when splitting.
+ * @param executable The path to the executable.
+ * @param presumedErrorLines The lines on which the error is expected.
+ * @param presumedErrorFile The name of the file in which the error is expected, empty for any file.
+ * @param environment The `NAME=value` entries added to the environment of the process.
+ * @return True if the execution ends in the desired runtime error, false otherwise.
  */
-std::vector<std::string> SplitToWords(const std::string& s, const char delimiter)
+static bool RunExecutable(const std::string& executable, const std::vector<size_t>& presumedErrorLines,
+                          const std::string& presumedErrorFile, const std::vector<std::string>& environment)
 {
-	std::vector<std::string> words;
+	if (Executor == ExecutionBackend::ForkServer)
+	{
+		if (const auto result = RunInForkServer(executable, presumedErrorLines, presumedErrorFile, environment))
+		{
+			return result.value();
+		}
+	}
 
-	SplitToWords(s, delimiter, std::back_inserter(words));
+	if (environment.empty())
+	{
+		return DebugExecutable(executable, presumedErrorLines, presumedErrorFile, nullptr);
+	}
 
-	return words;
+	std::vector<const char*> entries;
+
+	for (const auto& entry : environment)
+	{
+		entries.push_back(entry.c_str());
+	}
+
+	entries.push_back(nullptr);
+
+	return DebugExecutable(executable, presumedErrorLines, presumedErrorFile, entries.data());
 }
 
 /**
- * Checks whether a given message roughly corresponds to the error message
- * specified in the program's options.\n
- * The validation is done by checking whether the current message contains
- * parts of the original. Any part suffices.
+ * Validates a given source file by compiling it in-process and running it in the ORC JIT,
+ * see `Execution::RunInJit`. No executable is linked.
  *
- * @param currentMessage The message in which we search for parts of
- * the original.
- * @return True if at least a part of the original was found, false otherwise.
+ * @param globalContext The algorithm's context used for extracting adjusted line numbers.
+ * @param entry The filesystem's file entry.
+ * @return True if the source code can be compiled and ends in the desired runtime error, false otherwise.
  */
-static bool IsErrorMessageValid(const std::string& currentMessage)
+static bool CompileAndRunInJit(GlobalContext& globalContext, const std::filesystem::directory_entry& entry)
 {
-	auto original = std::string(ErrorMessage);
-	auto actual = std::string(currentMessage);
+	const auto currentVariantName = entry.path().filename().string();
+	const auto currentVariant = std::stol(currentVariantName.substr(0, currentVariantName.find('_')));
 
-	// Convert both to the same case
-	std::for_each(original.begin(), original.end(), [](char& c)
-	{
-		c = std::tolower(c);
-	});
+	const auto presumedErrorLines = globalContext.variantAdjustedErrorLocations[currentVariant];
 
-	std::for_each(actual.begin(), actual.end(), [](char& c)
+	Out::Verb() << "Processing file: " << entry.path().string() << "\n";
+
+	// The same timeout as the one of the LLDB events.
+	const auto timeOut = 30;
+	const auto result = Execution::RunInJit(entry.path().string(), globalContext.language, timeOut,
+	                                        LearnDependencies ? &globalContext.compilationErrors : nullptr);
+
+	if (!result.failure.empty())
 	{
-		c = std::tolower(c);
-	});
+		llvm::errs() << result.failure << "\n";
+		Instrumentation::Count("jit/failures");
+		return false;
+	}
 
-	auto messageParts = SplitToWords(original, ' ');
+	if (!result.compiled)
+	{
+		Instrumentation::Count("rejected/compilation");
+		return false;
+	}
 
-	// Check the parts of the original message.
-	for (auto& part : messageParts)
+	if (result.execution.timedOut || !result.execution.crashedInExecutable)
 	{
-		if (actual.find(part) != std::string::npos)
-		{
-			return true;
-		}
+		Out::Verb() << "Process exited with status " << result.execution.exitCode << ", signal " << result.execution.
+			signal << ".\n";
+		Instrumentation::Count("rejected/location");
+		return false;
 	}
 
-	return false;
+	return IsCrashReproducingError(result.crashFile.c_str(), result.crashLine, result.execution.signal,
+	                               presumedErrorLines, "");
 }
 
 /**
  * Runs the compiler and the LLDB debugger in order to validate a given source file.
- * If the compilation success, the LLDB proceeds to execute the generated binary
- * and checks how it executes.\n
- * Every time the execution stops, we check the location of the current symbol and
- * the generated message.\n
- * If both correspond, we terminate positively.
- * Otherwise, the search is inconclusive.
- * Note that the LLDB runtime has a set timeout that can only be changed inside the code.
+ * If the compilation success, the LLDB (or the fork server) proceeds to execute the generated binary
+ * and checks how it executes, see `RunExecutable`.
  *
  * @param globalContext The algorithm's context used for extracting adjusted line numbers.
  * @param entry The filesystem's file entry.
  * @return True if the source code can be compiled and ends in the desired runtime error, false otherwise.
  */
-bool ValidateVariant(GlobalContext& globalContext, const std::filesystem::directory_entry& entry)
+static bool CompileAndDebugVariant(GlobalContext& globalContext, const std::filesystem::directory_entry& entry)
 {
-	const auto compilationExitCode = Compile(entry, globalContext.language);
+	Instrumentation::ScopedPhase validationPhase("validation");
+	Instrumentation::Count("variants/validated");
+
+	// Project mode links multiple translation units, the JIT runs a single one.
+	if (Executor == ExecutionBackend::JIT && !globalContext.deltaContext.project.IsEnabled())
+	{
+		return CompileAndRunInJit(globalContext, entry);
+	}
+
+	Instrumentation::ScopedPhase compilationPhase("compile");
+
+	const auto compilationExitCode = globalContext.deltaContext.project.IsEnabled()
+		                                 ? CompileProject(globalContext, entry)
+		                                 : Compile(entry, globalContext.language, &globalContext.compilationErrors);
+
+	compilationPhase.Stop();
 
 	if (compilationExitCode != 0)
 	{
 		// File could not be compiled, continue.
+		Instrumentation::Count("rejected/compilation");
 		return false;
 	}
 
@@ -602,246 +2074,200 @@ bool ValidateVariant(GlobalContext& globalContext, const std::filesystem::direct
 
 	const auto presumedErrorLines = globalContext.variantAdjustedErrorLocations[currentVariant];
 
-	Out::Verb() << "Processing file: " << entry.path().string() << "\n";
-
-	// Keep all LLDB logic written explicitly, not refactored in a function.
-	// The function could be called when the LLDBSentry is not initialized => unwanted behaviour.
-	// Having this function is a risk already...
-
-	// Create a debugger object - represents an instance of LLDB.
-	auto debugger(lldb::SBDebugger::Create());
+	// In project mode, the error must also occur in the file of the criterion's translation unit.
+	const auto& project = globalContext.deltaContext.project;
+	auto presumedErrorFile = std::string();
 
-	if (!debugger.IsValid())
+	if (project.IsEnabled())
 	{
-		llvm::errs() << "Debugger could not be created.\n";
-		exit(EXIT_FAILURE);
+		presumedErrorFile = project.activeUnit == project.criterionUnit
+			                    ? currentVariantName
+			                    : std::filesystem::path(project.units[project.criterionUnit].currentTestCase).filename().
+			                    string();
 	}
 
-	const char* argv[] = {Arguments.c_str(), nullptr};
-
-	lldb::SBError error;
-	lldb::SBLaunchInfo launchInfo(argv);
-
-	launchInfo.SetWorkingDirectory(TempFolder);
-	launchInfo.SetLaunchFlags(lldb::eLaunchFlagExec | lldb::eLaunchFlagDebug);
+	Out::Verb() << "Processing file: " << entry.path().string() << "\n";
 
 	const auto executable = TempFolder + entry.path().filename().replace_extension(".out").string();
-	Out::Verb() << "\nLLDB Target creation for " << executable << " ...\n";
 
-	// Create and launch a target - represents a debugging session of a single executable.
-	// Launching creates a new process in which the executable is ran.
-	auto target = debugger.CreateTarget(executable.c_str(), llvm::sys::getDefaultTargetTriple().c_str(), "", true,
-	                                    error);
+	return RunExecutable(executable, presumedErrorLines, presumedErrorFile, {});
+}
 
-	Out::Verb() << "error.Success()              = " << static_cast<int>(error.Success()) << "\n";
-	Out::Verb() << "target.IsValid()             = " << static_cast<int>(target.IsValid()) << "\n";
+/**
+ * Validates a variant of the mutant schema by running the schema's executable with the variant's bit mask.\n
+ * The schema keeps the original line numbers, the error is expected on the original lines.
+ *
+ * @param executable The path to the executable compiled from the mutant schema.
+ * @param bitMask The bit mask of the variant, each guarded node is executed only if its bit is set.
+ * @param errorLines The potential error-inducing lines of the original file.
+ * @return True if the variant ends in the desired runtime error, false otherwise.
+ */
+bool ValidateSchemaVariant(const std::string& executable, const BitMask& bitMask,
+                           const std::vector<size_t>& errorLines)
+{
+	Instrumentation::ScopedPhase validationPhase("schema");
+	Instrumentation::Count("variants/schema");
 
-	Out::Verb() << "\nLLDB Process launch ...\n";
+	return RunExecutable(executable, errorLines, "", {std::string(SchemaMaskVariable) + "=" + Stringify(bitMask)});
+}
 
-	auto process = target.Launch(launchInfo, error);
-	Out::Verb() << "error.Success()              = " << static_cast<int>(error.Success()) << "\n";
-	Out::Verb() << "process.IsValid()            = " << static_cast<int>(process.IsValid()) << "\n";
-	Out::Verb() << "process.GetProcessID()       = " << process.GetProcessID() << "\n";
-	Out::Verb() << "process.GetState()           = " << StateToString(process.GetState()) << "\n";
-	Out::Verb() << "process.GetNumThreads()      = " << process.GetNumThreads() << "\n";
+/**
+ * Computes the key of a variant in the validation cache.\n
+ * The key covers the source code of the variant, its language and, in project mode, the source code
+ * of the other translation units the variant is linked with.
+ *
+ * @param globalContext The context containing the language and the project data.
+ * @param entry The file system entry for the variant.
+ * @return The hash of the variant.
+ */
+static size_t HashVariant(const GlobalContext& globalContext, const std::filesystem::directory_entry& entry)
+{
+	std::ifstream ifs(entry.path());
+	auto key = std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
 
-	auto listener = debugger.GetListener();
-	Out::Verb() << "listener.IsValid()           = " << static_cast<int>(listener.IsValid()) << "\n";
+	key += '\0' + LanguageToString(globalContext.language);
 
-	auto done = false;
-	// The timeout is currently set to 30 seconds for EACH event, not the entire run.
-	const auto timeOut = 30;
+	const auto& project = globalContext.deltaContext.project;
 
-	// The debugger is set to run asynchronously (debugger.GetAsync() => true).
-	// The communication is done via events. Listen for events broadcast by the forked process.
-	// Events are handled depending on the state of the process, the most important is `eStateStopped`
-	// (stopped at a breakpoint, such as an exception) and `eStateExited` (ran without errors).
-	while (!done)
+	// The objects of the other units are named by their iteration, their source code tells them apart.
+	for (size_t i = 0; i < project.units.size(); i++)
 	{
-		lldb::SBEvent event;
-
-		if (listener.WaitForEvent(timeOut /*seconds*/, event))
+		if (i != project.activeUnit)
 		{
-			if (lldb::SBProcess::EventIsProcessEvent(event))
-			{
-				const auto state = lldb::SBProcess::GetStateFromEvent(event);
-
-				if (state == lldb::eStateInvalid)
-				{
-					Out::Verb() << "Invalid process event: " << StateToString(state) << "\n";
-				}
-				else
-				{
-					Out::Verb() << "Process state event changed to: " << StateToString(state) << "\n";
-
-					if (state == lldb::eStateStopped)
-					{
-						// The debugger stopped at a breakpoint. Since no breakpoints were set, this is most likely an exception.
-						// Analyze the current stack frame to determine the status and position of the error.
-
-						Out::Verb() << "Stopped at a breakpoint.\n";
-						Out::Verb() << "LLDB Threading ...\n";
-
-						auto thread = process.GetSelectedThread();
-						Out::Verb() << "thread.IsValid()             = " << static_cast<int>(thread.IsValid()) << "\n";
-						Out::Verb() << "thread.GetThreadID()         = " << thread.GetThreadID() << "\n";
-						Out::Verb() << "thread.GetName()             = " << (thread.GetName() != nullptr
-							                                                     ? thread.GetName()
-							                                                     : "(null)") << "\n";
-						Out::Verb() << "thread.GetStopReason()       = " << StopReasonToString(thread.GetStopReason())
-							<<
-							"\n";
-						Out::Verb() << "thread.IsSuspended()         = " << static_cast<int>(thread.IsSuspended()) <<
-							"\n";
-						Out::Verb() << "thread.IsStopped()           = " << static_cast<int>(thread.IsStopped()) <<
-							"\n";
-						Out::Verb() << "process.GetState()           = " << StateToString(process.GetState()) << "\n";
+			std::ifstream unit(project.units[i].currentTestCase);
+			key += '\0' + std::string(std::istreambuf_iterator<char>(unit), std::istreambuf_iterator<char>());
+		}
+	}
 
-						if (thread.GetStopReason() == lldb::StopReason::eStopReasonException)
-						{
-							Out::Verb() << "An exception was hit, killing the process ...\n";
-							done = true;
-						}
+	// The hash is saved to the journal of the validation cache, std::hash may differ between builds.
+	return llvm::xxHash64(key);
+}
 
-						auto frame = thread.GetSelectedFrame();
-						Out::Verb() << "frame.IsValid()              = " << static_cast<int>(frame.IsValid()) << "\n";
+/**
+ * Validates a given source file, see `CompileAndDebugVariant`.\n
+ * The results are cached by the hash of the variant, so a variant identical to an already validated one
+ * (e.g., a complement repeated by Delta debugging or a variant validated before an interruption) is not
+ * compiled and executed again. In project mode, successful variants are always validated, since their
+ * objects are linked in afterwards.
+ *
+ * @param globalContext The algorithm's context used for extracting adjusted line numbers.
+ * @param entry The filesystem's file entry.
+ * @return True if the source code can be compiled and ends in the desired runtime error, false otherwise.
+ */
+bool ValidateVariant(GlobalContext& globalContext, const std::filesystem::directory_entry& entry)
+{
+	globalContext.compilationErrors.clear();
 
-						auto function = frame.GetFunction();
+	const auto hash = HashVariant(globalContext, entry);
 
-						if (function.IsValid())
-						{
-							Out::Verb() << "function.GetDisplayName()   = " << (function.GetDisplayName() != nullptr
-								                                                    ? function.GetDisplayName()
-								                                                    : "(null)") << "\n";
-						}
+	if (const auto cached = globalContext.validationCache.find(hash); cached != globalContext.validationCache.end()
+		&& !(cached->second && globalContext.deltaContext.project.IsEnabled()))
+	{
+		Instrumentation::Count("cache/validations/hits");
 
-						auto symbol = frame.GetSymbol();
-						Out::Verb() << "symbol.IsValid()             = " << static_cast<int>(symbol.IsValid()) << "\n";
+		Out::Verb() << "Reusing the validation result of an identical variant for " << entry.path().string() <<
+			".\n";
+		return cached->second;
+	}
 
-						if (symbol.IsValid())
-						{
-							Out::Verb() << "symbol.GetDisplayName()      = " << symbol.GetDisplayName() << "\n";
+	Instrumentation::Count("cache/validations/misses");
 
-							auto symbolContext = frame.GetSymbolContext(lldb::eSymbolContextLineEntry);
+	const auto result = CompileAndDebugVariant(globalContext, entry);
+	globalContext.validationCache[hash] = result;
 
-							Out::Verb() << "symbolContext.IsValid()      = " << static_cast<int>(symbolContext.IsValid()
-								)
-								<< "\n";
+	if (!CheckpointFile.empty())
+	{
+		globalContext.unsavedValidations.emplace_back(hash, result);
+	}
 
-							if (symbolContext.IsValid())
-							{
-								const auto fileName = symbolContext.GetLineEntry().GetFileSpec().GetFilename();
-								const auto lineNumber = symbolContext.GetLineEntry().GetLine();
+	return result;
+}
 
-								Out::Verb() << "symbolContext.GetFilename()  = " << fileName << "\n";
-								Out::Verb() << "symbolContext.GetLine()      = " << lineNumber << "\n";
-								Out::Verb() << "symbolContext.GetColumn()    = " << symbolContext
-								                                                    .GetLineEntry().GetColumn() << "\n";
+/**
+ * Writes a JSON value to a given file.
+ *
+ * @param value The value to be written.
+ * @param filePath The path to the output file.
+ */
+static void WriteJson(llvm::json::Value value, const std::string& filePath)
+{
+	std::error_code errorCode;
+	llvm::raw_fd_ostream ofs(filePath, errorCode, llvm::sys::fs::F_None);
 
-								// Iterate over all possible error-inducing lines (the original, plus function decl body)
-								// and determine whether the current location is correct.
-								for (auto presumedErrorLine : presumedErrorLines)
-								{
-									if (lineNumber == presumedErrorLine)
-									{
-										auto stream = lldb::SBStream();
-										thread.GetStatus(stream);
+	if (errorCode)
+	{
+		llvm::errs() << "The output file " << filePath << " could not be opened: " << errorCode.message() << "\n";
+		return;
+	}
 
-										Out::Verb() << "stream.IsValid()              = " << static_cast<int>(stream.
-											IsValid()) << "\n";
+	ofs << llvm::formatv("{0:2}", value) << "\n";
+}
 
-										// The location was correct, validate the message - the runtime error must
-										// be the same.
-										if (stream.IsValid())
-										{
-											const auto currentMessage = stream.GetData();
+/**
+ * Writes the statistics of the current run, including the phase timers and counters, as a JSON report.
+ *
+ * @param stats The instance of the structure keeping track of the current run.
+ * @param filePath The path to the report.
+ */
+static void WriteStatsReport(const Statistics& stats, const std::string& filePath)
+{
+	const auto& recorder = Instrumentation::GetRecorder();
 
-											Out::Verb() << "stream.GetData()              = " << currentMessage << "\n";
+	llvm::json::Object phases;
 
-											if (IsErrorMessageValid(currentMessage))
-											{
-												return true;
-											}
-										}
+	for (const auto& [path, phase] : recorder.GetPhases())
+	{
+		phases[path] = llvm::json::Object{{"seconds", phase.seconds}, {"count", static_cast<int64_t>(phase.count)}};
+	}
 
-										break;
-									}
-								}
-							}
-						}
+	llvm::json::Object counters;
 
-						process.Continue();
-					}
-					else if (state == lldb::eStateExited)
-					{
-						Out::Verb() << "Process exited.\n";
+	for (const auto& [name, count] : recorder.GetCounters())
+	{
+		counters[name] = static_cast<int64_t>(count);
+	}
 
-						auto description = process.GetExitDescription();
+	WriteJson(llvm::json::Object{
+		          {"wallSeconds", recorder.GetElapsedSeconds()},
+		          {"expectedIterations", stats.expectedIterations},
+		          {"totalIterations", static_cast<int64_t>(stats.totalIterations)},
+		          {"inputSizeInBytes", static_cast<int64_t>(stats.inputSizeInBytes)},
+		          {"outputSizeInBytes", static_cast<int64_t>(stats.outputSizeInBytes)},
+		          {"phases", std::move(phases)},
+		          {"counters", std::move(counters)}
+	          }, filePath);
+}
 
-						if (description != nullptr)
-						{
-							Out::Verb() << "Exit status " << process.GetExitStatus() << ":" << description << "\n";
-						}
-						else
-						{
-							Out::Verb() << "Exit status " << process.GetExitStatus() << "\n";
-						}
+/**
+ * Writes all recorded runs of all phases in the Chrome trace-event format.
+ *
+ * @param filePath The path to the trace.
+ */
+static void WriteTrace(const std::string& filePath)
+{
+	llvm::json::Array events;
 
-						done = true;
-					}
-					else if (state == lldb::eStateCrashed)
-					{
-						Out::Verb() << "Process crashed.\n";
-						done = true;
-					}
-					else if (state == lldb::eStateDetached)
-					{
-						Out::Verb() << "Process detached.\n";
-						done = true;
-					}
-					else if (state == lldb::eStateUnloaded)
-					{
-						Out::Verb() << "ERROR: Process unloaded!\n";
-						done = true;
-					}
-					else if (state == lldb::eStateConnected)
-					{
-						Out::Verb() << "Process connected.\n";
-					}
-					else if (state == lldb::eStateAttaching)
-					{
-						Out::Verb() << "Process attaching.\n";
-					}
-					else if (state == lldb::eStateLaunching)
-					{
-						Out::Verb() << "Process launching.\n";
-					}
-				}
-			}
-			else
-			{
-				Out::Verb() << "Event: " << lldb::SBEvent::GetCStringFromEvent(event) << "\n";
-			}
-		}
-		else
-		{
-			Out::Verb() << "Process event has not occured in the last" << timeOut <<
-				" seconds, killing the process ...\n";
-			done = true;
-		}
+	for (const auto& event : Instrumentation::GetRecorder().GetEvents())
+	{
+		events.push_back(llvm::json::Object{
+			{"name", event.name},
+			{"cat", event.name.substr(0, event.name.find('/'))},
+			{"ph", "X"},
+			{"ts", event.startInMicroseconds},
+			{"dur", event.durationInMicroseconds},
+			{"pid", 1},
+			{"tid", static_cast<int64_t>(event.thread)}
+		});
 	}
 
-	// Clean up.
-	process.Kill();
-	debugger.DeleteTarget(target);
-	lldb::SBDebugger::Destroy(debugger);
-
-	return false;
+	WriteJson(llvm::json::Object{{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}}, filePath);
 }
 
 /**
  * Prints the expected number of iterations, the actual number of iterations,
- * the original size of the input file and the size of the output file.
+ * the original size of the input file and the size of the output file.\n
+ * The time spent in each phase and the counters follow. If requested, the statistics are also written
+ * to a JSON report and the phases to a Chrome trace.
  *
  * @param stats The instance of the structure keeping track of the current run.
  */
@@ -853,8 +2279,33 @@ void DisplayStats(Statistics& stats)
 	Out::All() << "Actual iterations:             " << stats.totalIterations << "\n";
 	Out::All() << "Original size [bytes]:        " << stats.inputSizeInBytes << "\n";
 	Out::All() << "Size of the result [bytes]:   " << stats.outputSizeInBytes << "\n";
+	Out::All() << "Wall time [s]:                " << Instrumentation::GetRecorder().GetElapsedSeconds() << "\n";
+
+	Out::All() << "===---------------------------- Phases [s] ------------------------------===\n";
+
+	for (const auto& [path, phase] : Instrumentation::GetRecorder().GetPhases())
+	{
+		Out::All() << path << ": " << phase.seconds << " (" << phase.count << "x)\n";
+	}
+
+	Out::All() << "===------------------------------ Counters ------------------------------===\n";
+
+	for (const auto& [name, count] : Instrumentation::GetRecorder().GetCounters())
+	{
+		Out::All() << name << ": " << count << "\n";
+	}
 
 	Out::All() << "===----------------------------------------------------------------------===\n";
+
+	if (!StatsFile.empty())
+	{
+		WriteStatsReport(stats, StatsFile);
+	}
+
+	if (!TraceFile.empty())
+	{
+		WriteTrace(TraceFile);
+	}
 }
 
 /**
@@ -880,12 +2331,15 @@ void PrintResult(const std::string& filePath)
  * The validation consists of compilation and a debugging session. Whenever the compilation succeeds,
  * the program is run using LLDB to determine whether it produces the desired runtime error.\n
  * If a valid variant is found, it is stored as `autoPieOut.<extensions based on language>` in the
- * temporary directory.
+ * temporary directory.\n
+ * If the dependency graph is given, dependencies are learned from the variants that could not be compiled and
+ * the variants violating them are skipped, see `DependencyGraph::LearnFromErrors`.
  *
  * @param context The global context of the tool required for language options and line number adjustments.
+ * @param dependencies The dependency graph of the input file, may be null.
  * @return True if the epoch produced a valid result, false otherwise.
  */
-bool ValidateResults(GlobalContext& context)
+bool ValidateResults(GlobalContext& context, DependencyGraph* dependencies)
 {
 	// Collect the results.
 	std::vector<std::filesystem::directory_entry> files;
@@ -895,22 +2349,46 @@ bool ValidateResults(GlobalContext& context)
 	}
 
 	// Sort the output by size and iterate it from the smallest to the largest file. The first valid file is the minimal version.
+	// Files of the same size are sorted by their paths, the order must be the same in a resumed run.
 	std::sort(files.begin(), files.end(),
 	          [](const std::filesystem::directory_entry& a, const std::filesystem::directory_entry& b) -> bool
 	          {
-		          return a.file_size() < b.file_size();
+		          return a.file_size() < b.file_size() || (a.file_size() == b.file_size() && a.path() < b.path());
 	          });
 
 	std::optional<std::string> resultFound{};
+	auto& cursor = context.checkpoint.binCursor;
+
+	if (cursor > 0)
+	{
+		Out::All() << "Skipping " << cursor << " variants validated before the checkpoint.\n";
+	}
 
 	// Attempt to compile each file. If successful, run it in LLDB and validate the error message and location.
-	for (const auto& entry : files)
+	for (auto i = cursor; i < files.size(); i++)
 	{
-		if (ValidateVariant(context, entry))
+		const auto variantName = files[i].path().filename().string();
+		const auto bitMask = dependencies != nullptr
+			                     ? context.variantBitMasks.find(std::stoul(variantName.substr(0, variantName.find('_'))))
+			                     : context.variantBitMasks.end();
+		const auto learning = bitMask != context.variantBitMasks.end();
+
+		if (learning && dependencies->ViolatesLearnedDependencies(bitMask->second))
+		{
+			Instrumentation::Count("rejected/learned");
+		}
+		else if (ValidateVariant(context, files[i]))
 		{
-			resultFound = entry.path().string();
+			resultFound = files[i].path().string();
 			break;
 		}
+		else if (learning)
+		{
+			dependencies->LearnFromErrors(bitMask->second, context.compilationErrors);
+		}
+
+		cursor = i + 1;
+		SaveCheckpoint(context, "naive");
 	}
 
 	if (!resultFound.has_value())
@@ -918,20 +2396,32 @@ bool ValidateResults(GlobalContext& context)
 		return false;
 	}
 
-	Out::All() << "Found the smallest error-inducing source file: " << resultFound.value() << "\n";
+	StoreResult(context, resultFound.value());
+
+	return true;
+}
+
+/**
+ * Stores the smallest error-inducing variant found by the naive reduction as `autoPieOut.<extensions based on
+ * language>` in the temporary directory, prints it and the statistics of the search.
+ *
+ * @param context The global context of the tool required for language options and statistics.
+ * @param filePath The path to the found variant.
+ */
+void StoreResult(GlobalContext& context, const std::string& filePath)
+{
+	Out::All() << "Found the smallest error-inducing source file: " << filePath << "\n";
 
 	const auto newFileName = TempFolder + std::string("autoPieOut") + LanguageToExtension(context.language);
 
 	Out::All() << "Changing the file path to '" << newFileName << "'\n";
 
-	std::filesystem::rename(resultFound.value(), newFileName);
+	std::filesystem::rename(filePath, newFileName);
 
 	PrintResult(newFileName);
 
 	context.stats.Finalize(newFileName);
 	DisplayStats(context.stats);
-
-	return true;
 }
 
 /**
@@ -1066,3 +2556,322 @@ std::string LanguageToExtension(const clang::Language lang)
 		throw std::invalid_argument("Language not supported.");
 	}
 }
+
+//===----------------------------------------------------------------------===//
+//
+/// Checkpoint helper functions.
+//
+//===----------------------------------------------------------------------===//
+
+/**
+ * Determines the path of the journal of the validation cache, which is kept next to the `--checkpoint-file`.\n
+ * Each line holds the hash of a validated variant and the result of its validation. The journal is only appended to,
+ * so a save does not write the whole cache again.
+ *
+ * @return The path to the journal.
+ */
+static std::string GetValidationJournalPath()
+{
+	return CheckpointFile + ".cache";
+}
+
+/**
+ * Describes the reduction to which a checkpoint belongs. A checkpoint can only be resumed by the same reduction.\n
+ * The contents of all input files are included (see `Checkpoint::inputFiles`), since the saved positions index
+ * variants of the input and the cached validations depend on the other units of a project. So are the options
+ * changing which variants are generated or how they are validated, e.g., `--mutant-schema`, `--executor`
+ * or `--learn-dependencies`.
+ *
+ * @param context The global context of the reduction.
+ * @param tool The name of the tool (`naive` or `delta`).
+ * @return The input and the options of the reduction.
+ */
+static llvm::json::Object GetCheckpointIdentity(const GlobalContext& context, const std::string& tool)
+{
+	auto files = context.checkpoint.inputFiles;
+
+	if (files.empty())
+	{
+		files.push_back(context.parsedInput.errorLocation.filePath);
+	}
+
+	llvm::json::Array contents;
+
+	for (const auto& file : files)
+	{
+		std::ifstream ifs(file);
+		const auto text = std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+		// A stable hash, the identity is compared with the one saved by a different process.
+		contents.push_back(file + ":" + std::to_string(llvm::xxHash64(text)));
+	}
+
+	return llvm::json::Object{
+		{"tool", tool},
+		{"input", context.parsedInput.errorLocation.filePath},
+		{"contents", std::move(contents)},
+		{"schema", MutantSchema.getValue()},
+		{"executor", static_cast<int64_t>(Executor.getValue())},
+		{"profile", static_cast<int64_t>(CompilationProfile.getValue())},
+		{"learnDependencies", LearnDependencies.getValue()},
+		{"pruneUnreachable", PruneUnreachable.getValue()},
+		{"linkFlags", LinkFlags.getValue()},
+		{"line", static_cast<int64_t>(LineNumber)},
+		{"message", ErrorMessage.getValue()},
+		{"arguments", Arguments.getValue()},
+		{"ratio", ReductionRatio.getValue()},
+		{"strategy", static_cast<int64_t>(Strategy.getValue())}
+	};
+}
+
+/**
+ * Loads the state saved by `SaveCheckpoint` into the global context.\n
+ * The state of the reduction loops is stored in `context.checkpoint`, which is marked as resumed.
+ * If there is no checkpoint, the reduction starts from the beginning.
+ *
+ * @param context The global context of the reduction.
+ * @param tool The name of the tool (`naive` or `delta`).
+ * @return False if the checkpoint exists but cannot be resumed, true otherwise.
+ */
+bool LoadCheckpoint(GlobalContext& context, const std::string& tool)
+{
+	if (CheckpointFile.empty())
+	{
+		llvm::errs() << "The `--resume` option requires the `--checkpoint-file` of the interrupted reduction.\n";
+		return false;
+	}
+
+	if (!std::filesystem::exists(std::string(CheckpointFile)))
+	{
+		Out::All() << "No checkpoint has been found, the reduction starts from the beginning.\n";
+		return true;
+	}
+
+	auto buffer = llvm::MemoryBuffer::getFile(CheckpointFile);
+
+	if (!buffer)
+	{
+		llvm::errs() << "The checkpoint " << CheckpointFile << " could not be read: " << buffer.getError().message() <<
+			"\n";
+		return false;
+	}
+
+	auto parsed = llvm::json::parse(buffer.get()->getBuffer());
+
+	if (!parsed)
+	{
+		llvm::errs() << "The checkpoint " << CheckpointFile << " could not be parsed: " << toString(parsed.takeError())
+			<< "\n";
+		return false;
+	}
+
+	const auto* root = parsed->getAsObject();
+	const auto* identity = root ? root->getObject("identity") : nullptr;
+
+	if (!identity || *identity != GetCheckpointIdentity(context, tool))
+	{
+		llvm::errs() << "The checkpoint " << CheckpointFile << " belongs to a different reduction. Remove it or "
+			"run the reduction without the `--resume` option.\n";
+		return false;
+	}
+
+	auto& checkpoint = context.checkpoint;
+
+	checkpoint.iteration = static_cast<int>(root->getInteger("iteration").getValueOr(0));
+	checkpoint.currentTestCase = root->getString("currentTestCase").getValueOr("").str();
+	checkpoint.partitionCount = static_cast<int>(root->getInteger("partitionCount").getValueOr(0));
+	checkpoint.activeUnit = static_cast<size_t>(root->getInteger("activeUnit").getValueOr(0));
+	checkpoint.epoch = static_cast<int>(root->getInteger("epoch").getValueOr(0));
+	checkpoint.binCursor = static_cast<size_t>(root->getInteger("binCursor").getValueOr(0));
+
+	auto requiredFiles = std::vector<std::string>();
+
+	if (!checkpoint.currentTestCase.empty())
+	{
+		requiredFiles.push_back(checkpoint.currentTestCase);
+	}
+
+	checkpoint.units.clear();
+
+	if (const auto* units = root->getArray("units"))
+	{
+		for (const auto& value : *units)
+		{
+			const auto* object = value.getAsObject();
+
+			if (!object)
+			{
+				continue;
+			}
+
+			Delta::TranslationUnit unit;
+			unit.currentTestCase = object->getString("currentTestCase").getValueOr("").str();
+			unit.currentObject = object->getString("currentObject").getValueOr("").str();
+			unit.codeUnitCount = static_cast<int>(object->getInteger("codeUnitCount").getValueOr(0));
+			unit.errorLine = static_cast<size_t>(object->getInteger("errorLine").getValueOr(0));
+
+			if (const auto* errorLines = object->getArray("errorLines"))
+			{
+				for (const auto& line : *errorLines)
+				{
+					unit.errorLines.push_back(static_cast<size_t>(line.getAsInteger().getValueOr(0)));
+				}
+			}
+
+			requiredFiles.push_back(unit.currentTestCase);
+			requiredFiles.push_back(unit.currentObject);
+			checkpoint.units.push_back(std::move(unit));
+		}
+	}
+
+	// The saved test cases are kept in the temporary directory, which might have been cleared since.
+	for (const auto& file : requiredFiles)
+	{
+		if (!file.empty() && !std::filesystem::exists(file))
+		{
+			llvm::errs() << "The file " << file << " saved in the checkpoint " << CheckpointFile <<
+				" no longer exists.\n";
+			return false;
+		}
+	}
+
+	context.deltaContext.hierarchyLevel = static_cast<int>(root->getInteger("hierarchyLevel").getValueOr(0));
+	context.deltaContext.keepProbabilities.clear();
+
+	if (const auto* probabilities = root->getArray("keepProbabilities"))
+	{
+		for (const auto& probability : *probabilities)
+		{
+			context.deltaContext.keepProbabilities.push_back(probability.getAsNumber().getValueOr(0));
+		}
+	}
+
+	context.stats.expectedIterations = root->getNumber("expectedIterations").getValueOr(0);
+	context.stats.totalIterations = static_cast<size_t>(root->getInteger("totalIterations").getValueOr(0));
+
+	// The last line of the journal might have been cut by the interruption.
+	std::ifstream journal(GetValidationJournalPath());
+	size_t hash;
+	int result;
+
+	while (journal >> hash >> result)
+	{
+		context.validationCache[hash] = result != 0;
+	}
+
+	checkpoint.resumed = true;
+	checkpoint.journalOpened = true;
+
+	Out::All() << "Resuming the reduction from the checkpoint " << CheckpointFile << " (iteration " << checkpoint.
+		iteration << ", " << context.validationCache.size() << " cached validations).\n";
+
+	return true;
+}
+
+/**
+ * Saves the state of the reduction, i.e., `context.checkpoint` and the state kept in the global context,
+ * to the `--checkpoint-file`.\n
+ * Unless forced, the state is saved only if the `--checkpoint-interval` has passed since the last save.
+ * The file is replaced atomically, an interruption during the save keeps the previous checkpoint.
+ *
+ * @param context The global context of the reduction.
+ * @param tool The name of the tool (`naive` or `delta`).
+ * @param force Specifies whether the interval should be ignored.
+ */
+void SaveCheckpoint(GlobalContext& context, const std::string& tool, const bool force)
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	if (CheckpointFile.empty() || (!force && now - context.checkpoint.lastSave < std::chrono::seconds(
+		CheckpointInterval)))
+	{
+		return;
+	}
+
+	context.checkpoint.lastSave = now;
+
+	Instrumentation::ScopedPhase phase("checkpoint");
+
+	const auto& checkpoint = context.checkpoint;
+
+	llvm::json::Array units;
+
+	for (const auto& unit : context.deltaContext.project.units)
+	{
+		llvm::json::Array errorLines;
+
+		for (const auto line : unit.errorLines)
+		{
+			errorLines.push_back(static_cast<int64_t>(line));
+		}
+
+		units.push_back(llvm::json::Object{
+			{"currentTestCase", unit.currentTestCase},
+			{"currentObject", unit.currentObject},
+			{"codeUnitCount", unit.codeUnitCount},
+			{"errorLine", static_cast<int64_t>(unit.errorLine)},
+			{"errorLines", std::move(errorLines)}
+		});
+	}
+
+	// The journal is appended to before the checkpoint is replaced, so it never misses validations it refers to.
+	auto journal = std::ofstream(GetValidationJournalPath(),
+	                             checkpoint.journalOpened ? std::ios::app : std::ios::trunc);
+
+	for (const auto& [hash, result] : context.unsavedValidations)
+	{
+		journal << hash << " " << (result ? 1 : 0) << "\n";
+	}
+
+	journal.close();
+
+	if (!journal)
+	{
+		llvm::errs() << "The validation cache could not be saved to " << GetValidationJournalPath() << ".\n";
+		return;
+	}
+
+	context.checkpoint.journalOpened = true;
+	context.unsavedValidations.clear();
+
+	const auto temporaryPath = CheckpointFile + ".tmp";
+
+	WriteJson(llvm::json::Object{
+		          {"identity", GetCheckpointIdentity(context, tool)},
+		          {"iteration", checkpoint.iteration},
+		          {"currentTestCase", checkpoint.currentTestCase},
+		          {"partitionCount", checkpoint.partitionCount},
+		          {"activeUnit", static_cast<int64_t>(checkpoint.activeUnit)},
+		          {"units", std::move(units)},
+		          {"epoch", checkpoint.epoch},
+		          {"binCursor", static_cast<int64_t>(checkpoint.binCursor)},
+		          {"hierarchyLevel", context.deltaContext.hierarchyLevel},
+		          {"keepProbabilities", llvm::json::Array(context.deltaContext.keepProbabilities)},
+		          {"expectedIterations", context.stats.expectedIterations},
+		          {"totalIterations", static_cast<int64_t>(context.stats.totalIterations)}
+	          }, temporaryPath);
+
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryPath, std::string(CheckpointFile), errorCode);
+
+	if (errorCode)
+	{
+		llvm::errs() << "The checkpoint " << CheckpointFile << " could not be saved: " << errorCode.message() << "\n";
+		return;
+	}
+
+	Out::Verb() << "Checkpoint saved to " << CheckpointFile << ".\n";
+}
+
+/**
+ * Removes the checkpoint of a finished reduction.
+ */
+void RemoveCheckpoint()
+{
+	if (!CheckpointFile.empty())
+	{
+		std::error_code errorCode;
+		std::filesystem::remove(std::string(CheckpointFile), errorCode);
+		std::filesystem::remove(GetValidationJournalPath(), errorCode);
+	}
+}
@@ -0,0 +1,585 @@
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/Stmt.h>
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Lex/Lexer.h>
+#include <clang/Tooling/Tooling.h>
+
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <set>
+#include <unordered_map>
+
+#include "../include/Helper.h"
+#include "../include/IncrementalCompilation.h"
+#include "../include/Instrumentation.h"
+#include "../include/Streams.h"
+#include "../include/ThreadPool.h"
+
+namespace Incremental
+{
+	/**
+	 * A replacement of a part of the variant's source code, given by its offsets.
+	 */
+	struct Edit
+	{
+		unsigned begin;
+		unsigned end;
+		std::string replacement;
+	};
+
+	/**
+	 * Describes how a variant is split into compilation units.\n
+	 * The common unit is the variant without the bodies of the split functions. It defines the global variables
+	 * and everything that has not been split. Each split function has its own unit, in which the bodies of the other
+	 * split functions are removed as well and the definitions of the global variables are replaced by declarations.
+	 */
+	struct SplitPlan
+	{
+		/**
+		 * Removes each split function - the body of a free function is replaced by a semicolon (the prototype
+		 * is kept), the out-of-line definition of a member function is removed completely.
+		 */
+		std::vector<Edit> functionEdits;
+
+		/**
+		 * Replaces each group of global variable definitions by `extern` declarations.
+		 */
+		std::vector<Edit> variableEdits;
+	};
+
+	/**
+	 * Determines whether a statement (or any of its children) declares a static local variable.
+	 *
+	 * @param statement The statement to be traversed.
+	 * @return True if a static local variable has been found, false otherwise.
+	 */
+	static bool ContainsStaticLocal(const clang::Stmt* statement)
+	{
+		if (statement == nullptr)
+		{
+			return false;
+		}
+
+		if (const auto* declarations = llvm::dyn_cast<clang::DeclStmt>(statement))
+		{
+			for (const auto* declaration : declarations->decls())
+			{
+				if (const auto* variable = llvm::dyn_cast<clang::VarDecl>(declaration); variable && variable->
+					isStaticLocal())
+				{
+					return true;
+				}
+			}
+		}
+
+		return std::any_of(statement->child_begin(), statement->child_end(), [](const clang::Stmt* child)
+		{
+			return ContainsStaticLocal(child);
+		});
+	}
+
+	/**
+	 * Determines whether a function definition can be compiled in its own unit.\n
+	 * Only non-template functions with external linkage that are not inline can be split. Their bodies must
+	 * not be written in macros and, in C, they must have a prototype.
+	 *
+	 * @param function The function definition.
+	 * @param languageOptions The options of the parsed language.
+	 * @return True if the function can be split, false otherwise.
+	 */
+	static bool IsSplittable(const clang::FunctionDecl* function, const clang::LangOptions& languageOptions)
+	{
+		return function->doesThisDeclarationHaveABody() && function->isExternallyVisible() && !function->isInlined() &&
+			!function->isConstexpr() && function->getTemplatedKind() == clang::FunctionDecl::TK_NonTemplate &&
+			!function->getDeclContext()->isDependentContext() && (languageOptions.CPlusPlus || function->
+				hasPrototype()) && !function->getBody()->getBeginLoc().isMacroID() && !function->getBody()->
+			getEndLoc().isMacroID();
+	}
+
+	/**
+	 * Determines whether a function definition that has not been split can be compiled in all units.\n
+	 * Such a definition must not define a symbol that would clash with its copies, nor a static variable
+	 * that would not be shared by its copies.
+	 *
+	 * @param function The function definition.
+	 * @param languageOptions The options of the parsed language.
+	 * @return True if the function can be kept in each unit, false otherwise.
+	 */
+	static bool IsDuplicable(const clang::FunctionDecl* function, const clang::LangOptions& languageOptions)
+	{
+		if (!function->isExternallyVisible())
+		{
+			return !ContainsStaticLocal(function->getBody());
+		}
+
+		// C++ inline functions and template instances are merged by the linker, C inline functions are not.
+		return function->getDeclContext()->isDependentContext() || (languageOptions.CPlusPlus && function->
+			isInlined());
+	}
+
+	/**
+	 * Creates the declaration replacing the definition of a global variable in the units of the split functions.
+	 *
+	 * @param variable The global variable.
+	 * @param context The AST context of the variant.
+	 * @return The declaration, empty for static data members (declared by their class), or nothing if
+	 * the variable cannot be declared.
+	 */
+	static std::optional<std::string> DeclareVariable(const clang::VarDecl* variable, const clang::ASTContext& context)
+	{
+		if (variable->isStaticDataMember())
+		{
+			return std::string();
+		}
+
+		if (variable->getTLSKind() != clang::VarDecl::TLS_None)
+		{
+			return std::nullopt;
+		}
+
+		std::string declaration;
+		llvm::raw_string_ostream stream(declaration);
+
+		stream << "extern ";
+		variable->getType().print(stream, clang::PrintingPolicy(context.getLangOpts()), variable->getName());
+		stream << ";";
+		stream.flush();
+
+		// Unnamed types cannot be referred to.
+		for (const auto* unnamed : {"(anonymous", "(unnamed", "(lambda"})
+		{
+			if (declaration.find(unnamed) != std::string::npos)
+			{
+				return std::nullopt;
+			}
+		}
+
+		return declaration;
+	}
+
+	/**
+	 * Plans the split of the declarations of a given context written in the main file.\n
+	 * Namespaces and linkage specifications are planned recursively.
+	 *
+	 * @param declarationContext The translation unit, a namespace, or a linkage specification.
+	 * @param context The AST context of the variant.
+	 * @param plan The plan to which the edits are added.
+	 * @param inBracelessLinkage Set if the context is a linkage specification without braces,
+	 * e.g., `extern "C" int x;`.
+	 * @return False if the variant cannot be split without changing its meaning, true otherwise.
+	 */
+	static bool PlanDeclarations(const clang::DeclContext* declarationContext, clang::ASTContext& context,
+	                             SplitPlan& plan, const bool inBracelessLinkage = false)
+	{
+		const auto& sourceManager = context.getSourceManager();
+		const auto& languageOptions = context.getLangOpts();
+
+		// Variables declared together (`int a, b = 1;`) share the beginning and are replaced together.
+		std::vector<std::vector<const clang::VarDecl*>> variableGroups;
+		std::set<unsigned> keptDeclarations;
+
+		for (const auto* declaration : declarationContext->decls())
+		{
+			if (declaration->isImplicit() || declaration->getBeginLoc().isInvalid() || !sourceManager.isInMainFile(
+				declaration->getBeginLoc()))
+			{
+				continue;
+			}
+
+			const auto* function = llvm::dyn_cast<clang::FunctionDecl>(declaration);
+			const auto* variable = llvm::dyn_cast<clang::VarDecl>(declaration);
+
+			if (llvm::isa<clang::FileScopeAsmDecl>(declaration))
+			{
+				return false;
+			}
+
+			if (declaration->getBeginLoc().isMacroID() || declaration->getEndLoc().isMacroID())
+			{
+				// Declarations written in macros cannot be edited.
+				if ((function && function->isThisDeclarationADefinition() && !IsDuplicable(function, languageOptions))
+					|| (variable && variable->isThisDeclarationADefinition() != clang::VarDecl::DeclarationOnly))
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			if (const auto* namespaceDeclaration = llvm::dyn_cast<clang::NamespaceDecl>(declaration))
+			{
+				if (!PlanDeclarations(namespaceDeclaration, context, plan))
+				{
+					return false;
+				}
+			}
+			else if (const auto* linkage = llvm::dyn_cast<clang::LinkageSpecDecl>(declaration))
+			{
+				if (!PlanDeclarations(linkage, context, plan, !linkage->hasBraces()))
+				{
+					return false;
+				}
+			}
+			else if (function && function->isThisDeclarationADefinition())
+			{
+				if (!IsSplittable(function, languageOptions))
+				{
+					if (!IsDuplicable(function, languageOptions))
+					{
+						return false;
+					}
+
+					continue;
+				}
+
+				const auto bodyEnd = sourceManager.getFileOffset(
+					clang::Lexer::getLocForEndOfToken(function->getBody()->getEndLoc(), 0, sourceManager,
+					                                  languageOptions));
+
+				// Member functions are declared by their class, free functions keep their prototype.
+				if (llvm::isa<clang::CXXMethodDecl>(function))
+				{
+					plan.functionEdits.push_back({
+						sourceManager.getFileOffset(function->getBeginLoc()), bodyEnd, ""
+					});
+				}
+				else
+				{
+					plan.functionEdits.push_back({
+						sourceManager.getFileOffset(function->getBody()->getBeginLoc()), bodyEnd, ";"
+					});
+				}
+			}
+			else if (variable && variable->isThisDeclarationADefinition() != clang::VarDecl::DeclarationOnly && !
+				variable->isInline() && !variable->getDeclContext()->isDependentContext())
+			{
+				if (!variable->isExternallyVisible())
+				{
+					// Internal constants can be defined in each unit, other internal variables would not be shared.
+					const auto* initializer = variable->getInit();
+
+					if (!variable->getType().isConstQualified() || (initializer && !initializer->isConstantInitializer(
+						context, false)))
+					{
+						return false;
+					}
+
+					keptDeclarations.insert(sourceManager.getFileOffset(declaration->getBeginLoc()));
+					continue;
+				}
+
+				if (inBracelessLinkage)
+				{
+					return false;
+				}
+
+				if (!variableGroups.empty() && variableGroups.back().front()->getBeginLoc() == variable->getBeginLoc())
+				{
+					variableGroups.back().push_back(variable);
+				}
+				else
+				{
+					variableGroups.push_back({variable});
+				}
+			}
+			else
+			{
+				keptDeclarations.insert(sourceManager.getFileOffset(declaration->getBeginLoc()));
+			}
+		}
+
+		for (const auto& group : variableGroups)
+		{
+			const auto begin = sourceManager.getFileOffset(group.front()->getBeginLoc());
+
+			// The group also declares something else, e.g., `struct S { int x; } s;`.
+			if (keptDeclarations.count(begin) > 0)
+			{
+				return false;
+			}
+
+			const auto end = clang::Lexer::findLocationAfterToken(group.back()->getEndLoc(), clang::tok::semi,
+			                                                      sourceManager, languageOptions, false);
+
+			if (end.isInvalid())
+			{
+				return false;
+			}
+
+			auto replacement = std::string();
+
+			for (const auto* variable : group)
+			{
+				const auto declaration = DeclareVariable(variable, context);
+
+				if (!declaration.has_value())
+				{
+					return false;
+				}
+
+				replacement += *declaration;
+			}
+
+			plan.variableEdits.push_back({begin, sourceManager.getFileOffset(end), replacement});
+		}
+
+		return true;
+	}
+
+	/**
+	 * Applies non-overlapping edits to the source code.\n
+	 * The unit starts with a `#line` directive naming the reduced file and each replaced part is followed by another
+	 * one, so that the debug information refers to the variant's lines without padding the unit by the removed line
+	 * breaks. The units of functions that have not moved therefore keep their text when other functions change.
+	 *
+	 * @param code The source code of the variant.
+	 * @param edits The edits to be applied.
+	 * @param fileName The name of the reduced file used in the directives, see `GetUnitFileName`.
+	 * @return The edited source code.
+	 */
+	static std::string ApplyEdits(const std::string& code, std::vector<Edit> edits, const std::string& fileName)
+	{
+		std::sort(edits.begin(), edits.end(), [](const Edit& left, const Edit& right)
+		{
+			return left.begin < right.begin;
+		});
+
+		std::string result = "#line 1 \"" + fileName + "\"\n";
+		result.reserve(code.size());
+
+		unsigned position = 0;
+		unsigned line = 1;
+
+		for (const auto& edit : edits)
+		{
+			result.append(code, position, edit.begin - position);
+			result.append(edit.replacement);
+
+			line += static_cast<unsigned>(std::count(code.begin() + position, code.begin() + edit.end, '\n'));
+			position = edit.end;
+
+			// The directive has to start a line, the rest of the edited line continues on the directive's line.
+			result.append("\n#line " + std::to_string(line) + " \"" + fileName + "\"\n");
+		}
+
+		result.append(code, position, std::string::npos);
+
+		return result;
+	}
+
+	/**
+	 * Determines the file name used in the `#line` directives of the units of a variant.\n
+	 * Variants are named by their number followed by the name of the reduced file, e.g., `12_example.cpp`
+	 * (see `GlobalContext::GetVariantFileName`). The number is left out, otherwise the units of the same function
+	 * would differ in each variant.
+	 *
+	 * @param input The path to the variant.
+	 * @return The name of the variant without its number.
+	 */
+	static std::string GetUnitFileName(const std::string& input)
+	{
+		const auto fileName = std::filesystem::path(input).filename().string();
+		const auto separator = fileName.find('_');
+
+		if (separator == std::string::npos || separator == 0 || !std::all_of(
+			fileName.begin(), fileName.begin() + separator, [](const unsigned char c) { return std::isdigit(c); }))
+		{
+			return fileName;
+		}
+
+		return fileName.substr(separator + 1);
+	}
+
+	/**
+	 * Splits a variant into compilation units, see `SplitPlan`.\n
+	 * The `#line` directives of the units (see `ApplyEdits`) make the debug information of all units refer
+	 * to the lines of the variant under the name of the reduced file.
+	 *
+	 * @param input The path to the variant.
+	 * @param clangPath The path to the compiler, whose resource directory is used for parsing.
+	 * @return The source code of the units, the common one first. Empty if the variant cannot be split.
+	 */
+	static std::vector<std::string> SplitVariant(const std::string& input, const std::string& clangPath)
+	{
+		Instrumentation::ScopedPhase phase("split");
+
+		std::ifstream ifs(input);
+		const auto code = std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+		// Diagnostics are reported by the compilation itself.
+		clang::IgnoringDiagConsumer diagnosticConsumer;
+
+		const auto tree = clang::tooling::buildASTFromCodeWithArgs(code, {}, input, clangPath,
+		                                                           std::make_shared<clang::PCHContainerOperations>(),
+		                                                           clang::tooling::getClangStripDependencyFileAdjuster(),
+		                                                           clang::tooling::FileContentMappings(),
+		                                                           &diagnosticConsumer);
+
+		if (!tree || tree->getDiagnostics().hasErrorOccurred())
+		{
+			return {};
+		}
+
+		SplitPlan plan;
+
+		if (!PlanDeclarations(tree->getASTContext().getTranslationUnitDecl(), tree->getASTContext(), plan) || plan.
+			functionEdits.size() < 2)
+		{
+			return {};
+		}
+
+		const auto fileName = GetUnitFileName(input);
+
+		auto units = std::vector<std::string>{ApplyEdits(code, plan.functionEdits, fileName)};
+
+		for (size_t i = 0; i < plan.functionEdits.size(); i++)
+		{
+			auto edits = plan.variableEdits;
+
+			for (size_t j = 0; j < plan.functionEdits.size(); j++)
+			{
+				if (i != j)
+				{
+					edits.push_back(plan.functionEdits[j]);
+				}
+			}
+
+			units.push_back(ApplyEdits(code, edits, fileName));
+		}
+
+		return units;
+	}
+
+	/**
+	 * Compiles a variant function by function, reusing the object files of unchanged functions.\n
+	 * The variant is split into a common unit and a unit for each function (see `SplitPlan`). Each unit keeps
+	 * the declarations of the whole variant, so its source code covers the function's text as well as the signatures
+	 * and types it depends on. The objects are looked up by the unit's source code together with the compiler flags
+	 * and the debug information of the `--compile-profile`. Units that have already been compiled are not compiled
+	 * again, the rest is compiled in parallel and all objects are linked into the executable.\n
+	 * Variants that cannot be parsed or split without changing their meaning (e.g., those defining
+	 * non-constant static variables or defining a single function) are left to the usual compilation.
+	 *
+	 * @param input The path to the variant.
+	 * @param output The path to the executable that should be created.
+	 * @param language The programming language in which the variant is written.
+	 * @return The exit code of the compilation (see `Compile`), or nothing if the variant has not been split.
+	 */
+	std::optional<int> CompileIncrementally(const std::string& input, const std::string& output,
+	                                        const clang::Language language)
+	{
+		static auto cacheCleared = false;
+
+		// The compiled units are kept by their full text, a hash collision must not link a different function.
+		static auto compiledUnits = std::unordered_map<std::string, std::string>();
+		static size_t objectCount = 0;
+
+		const auto clangPath = llvm::sys::findProgramByName(language == clang::Language::CXX ? "clang++" : "clang");
+
+		if (!clangPath)
+		{
+			return std::nullopt;
+		}
+
+		const auto units = SplitVariant(input, *clangPath);
+
+		if (units.empty())
+		{
+			Instrumentation::Count("split/fallbacks");
+			Out::Verb() << "The variant " << input << " is compiled as a whole.\n";
+			return std::nullopt;
+		}
+
+		if (!cacheCleared)
+		{
+			std::error_code error;
+			std::filesystem::remove_all(ObjectCacheFolder, error);
+			std::filesystem::create_directories(ObjectCacheFolder);
+			compiledUnits.clear();
+			cacheCleared = true;
+		}
+
+		// The units are placed in a different directory, local headers are still found next to the variant.
+		const auto flags = std::vector<std::string>{
+			"-iquote", std::filesystem::path(input).parent_path().string()
+		};
+		const auto extension = LanguageToExtension(language);
+
+		// The cache outlives a single reduction when serving, the objects depend on the options of the compilation.
+		auto options = std::string(extension) + "\n" + GetDebugInfoFlag() + "\n";
+
+		for (const auto& flag : flags)
+		{
+			options += flag + "\n";
+		}
+
+		auto objects = std::vector<std::string>();
+		auto misses = std::vector<std::pair<std::string, std::string>>();
+		auto compilations = std::vector<std::future<int>>();
+
+		for (const auto& unit : units)
+		{
+			auto key = options + unit;
+
+			if (const auto it = compiledUnits.find(key); it != compiledUnits.end())
+			{
+				Instrumentation::Count("cache/functions/hits");
+				objects.push_back(it->second);
+				continue;
+			}
+
+			Instrumentation::Count("cache/functions/misses");
+
+			const auto name = std::string(ObjectCacheFolder) + std::to_string(objectCount++);
+			const auto object = name + ".o";
+			const auto source = name + extension;
+
+			objects.push_back(object);
+			misses.emplace_back(std::move(key), object);
+
+			std::ofstream(source) << unit;
+
+			compilations.push_back(Common::GetSharedThreadPool().Submit([source, object, language, &flags]()
+			{
+				return CompileToObject(source, object, language, flags);
+			}));
+		}
+
+		auto compiled = true;
+
+		for (size_t i = 0; i < compilations.size(); i++)
+		{
+			if (compilations[i].get() == 0)
+			{
+				compiledUnits.emplace(std::move(misses[i].first), misses[i].second);
+			}
+			else
+			{
+				compiled = false;
+			}
+		}
+
+		// The variant has been parsed without errors, a failing unit means that it has been split incorrectly.
+		if (!compiled)
+		{
+			Instrumentation::Count("split/fallbacks");
+			Out::Verb() << "The units of the variant " << input << " could not be compiled, compiling it as a whole.\n";
+			return std::nullopt;
+		}
+
+		Out::Verb() << "Linking " << objects.size() << " units of the variant " << input << ".\n";
+
+		return LinkObjects(objects, output, language, {});
+	}
+} // namespace Incremental
@@ -0,0 +1,822 @@
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstdlib>
+
+#include "../include/JitExecutor.h"
+
+#ifdef _WIN32
+
+namespace Execution
+{
+	JitResult RunInJit(const std::string& sourceFile, clang::Language language, int timeout,
+	                   std::vector<CompilationError>* errors)
+	{
+		JitResult result;
+		result.failure = "The JIT backend is not supported on Windows.";
+
+		return result;
+	}
+
+	JitTrace TraceInJit(const std::string& sourceFile, clang::Language language, int timeout, size_t stopLine)
+	{
+		JitTrace trace;
+		trace.run.failure = "The JIT backend is not supported on Windows.";
+
+		return trace;
+	}
+} // namespace Execution
+
+#else
+
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/DiagnosticOptions.h>
+#include <clang/CodeGen/CodeGenAction.h>
+#include <clang/Frontend/ChainedDiagnosticConsumer.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/CompilerInvocation.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Frontend/Utils.h>
+
+#include <llvm/DebugInfo/DWARF/DWARFContext.h>
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/TargetSelect.h>
+
+#include <algorithm>
+#include <atomic>
+#include <csetjmp>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "../include/Helper.h"
+#include "../include/Instrumentation.h"
+#include "../include/Options.h"
+#include "../include/Streams.h"
+
+namespace Execution
+{
+	/**
+	 * The report sent by the child after a crash.
+	 */
+	struct CrashReport
+	{
+		std::int32_t signal;
+		std::uint32_t line;
+		char fileName[256];
+	};
+
+	/**
+	 * Keeps the debug objects of the code loaded by the JIT, so that crashing addresses can be mapped to source lines.
+	 */
+	class DebugInfoListener final : public llvm::JITEventListener
+	{
+		std::vector<llvm::object::OwningBinary<llvm::object::ObjectFile>> objects_;
+		std::vector<std::unique_ptr<llvm::DWARFContext>> contexts_;
+
+	public:
+		void notifyObjectLoaded(ObjectKey key, const llvm::object::ObjectFile& object,
+		                        const llvm::RuntimeDyld::LoadedObjectInfo& info) override
+		{
+			// The debug object has the addresses of its sections set to where the JIT loaded them.
+			auto debugObject = info.getObjectForDebug(object);
+
+			if (debugObject.getBinary() == nullptr)
+			{
+				return;
+			}
+
+			contexts_.push_back(llvm::DWARFContext::create(*debugObject.getBinary()));
+			objects_.push_back(std::move(debugObject));
+		}
+
+		/**
+		 * Maps an address of the JIT-compiled code to a source line.
+		 *
+		 * @param address The address of an instruction.
+		 * @return The line information, its line is zero if the address is not a part of the JIT-compiled code.
+		 */
+		[[nodiscard]] llvm::DILineInfo FindLine(const std::uint64_t address) const
+		{
+			for (size_t i = 0; i < objects_.size(); i++)
+			{
+				// The debug object is relocatable, the address must be given together with its section.
+				for (const auto& section : objects_[i].getBinary()->sections())
+				{
+					if (section.isText() && address >= section.getAddress() && address < section.getAddress() +
+						section.getSize())
+					{
+						return contexts_[i]->getLineInfoForAddress({address, section.getIndex()});
+					}
+				}
+			}
+
+			return {};
+		}
+	};
+
+	/**
+	 * The name of the function called by the traced code whenever the executed line changes, see `InstrumentLines`.
+	 */
+	constexpr const char* TraceFunctionName = "__autopie_trace_line";
+
+	// The trace shared by the traced child with its parent - the number of traced events, the event of the last
+	// execution of the stop line, and the first event of each line (zero if the line has not been executed).
+	// The counters are atomic, the threads of the traced program record their lines concurrently.
+	using TraceCounter = std::atomic<std::uint64_t>;
+	static_assert(TraceCounter::is_always_lock_free, "The trace is shared between processes.");
+
+	static TraceCounter* traceBuffer = nullptr;
+	static size_t traceLineCount = 0;
+	static size_t traceStopLine = 0;
+
+	/**
+	 * Records the execution of a line, called by the traced code.
+	 */
+	static void TraceLine(const std::uint64_t line)
+	{
+		const auto event = traceBuffer[0].fetch_add(1, std::memory_order_relaxed) + 1;
+
+		if (line < traceLineCount && traceBuffer[2 + line].load(std::memory_order_relaxed) == 0)
+		{
+			auto unset = std::uint64_t{0};
+			traceBuffer[2 + line].compare_exchange_strong(unset, event, std::memory_order_relaxed);
+		}
+
+		if (line == traceStopLine)
+		{
+			// Another thread may have recorded a later execution in the meantime.
+			auto last = traceBuffer[1].load(std::memory_order_relaxed);
+
+			while (last < event && !traceBuffer[1].compare_exchange_weak(last, event, std::memory_order_relaxed))
+			{
+			}
+		}
+	}
+
+	/**
+	 * The C library functions ending the program or registering its exit handlers, together with the names of
+	 * their replacements in the child, see `RedirectExit`.
+	 */
+	constexpr std::pair<const char*, const char*> ExitFunctionNames[] = {
+		{"exit", "__autopie_exit"},
+		{"atexit", "__autopie_atexit"},
+		{"__cxa_atexit", "__autopie_cxa_atexit"}
+	};
+
+	/**
+	 * An exit handler registered by the JIT-compiled program, either by `atexit` or by `__cxa_atexit`.
+	 */
+	struct ExitHandler
+	{
+		void (*plain)(){nullptr};
+		void (*withArgument)(void*){nullptr};
+		void* argument{nullptr};
+	};
+
+	// The exit handlers of the program run in the child and the JIT running it.
+	static std::vector<ExitHandler> exitHandlers;
+	static llvm::orc::LLJIT* childJit = nullptr;
+
+	static int RegisterExitHandler(void (*handler)())
+	{
+		exitHandlers.push_back({handler, nullptr, nullptr});
+		return 0;
+	}
+
+	static int RegisterCxaExitHandler(void (*handler)(void*), void* argument, void* /*dsoHandle*/)
+	{
+		exitHandlers.push_back({nullptr, handler, argument});
+		return 0;
+	}
+
+	/**
+	 * Ends the child the way `exit` ends the compiled executable - runs the exit handlers of the program in reverse
+	 * order, its static destructors and flushes its streams. The child then terminates by `_exit`, so that
+	 * the exit handlers and static destructors of AutoPIE itself (e.g., of the output sink, whose thread does not
+	 * exist in the child) are never run.
+	 *
+	 * @param status The exit code of the program.
+	 */
+	[[noreturn]] static void ExitChild(const int status)
+	{
+		// Handlers may register further handlers or call `exit` again, the remaining handlers are run either way.
+		while (!exitHandlers.empty())
+		{
+			const auto handler = exitHandlers.back();
+			exitHandlers.pop_back();
+
+			if (handler.plain != nullptr)
+			{
+				handler.plain();
+			}
+			else
+			{
+				handler.withArgument(handler.argument);
+			}
+		}
+
+		if (childJit != nullptr)
+		{
+			const auto jit = childJit;
+			childJit = nullptr;
+			llvm::consumeError(jit->deinitialize(jit->getMainJITDylib()));
+		}
+
+		std::fflush(nullptr);
+		_exit(status);
+	}
+
+	/**
+	 * Renames the declarations of `ExitFunctionNames` in the module to their replacements, which are resolved to
+	 * `ExitChild` and to the handler registration of the child.
+	 *
+	 * @param module The module to be run.
+	 */
+	static void RedirectExit(llvm::Module& module)
+	{
+		for (const auto& [name, replacement] : ExitFunctionNames)
+		{
+			const auto function = module.getFunction(name);
+
+			if (function != nullptr && function->isDeclaration())
+			{
+				function->setName(replacement);
+			}
+		}
+	}
+
+	// The state of the crash handler of the child.
+	static sigjmp_buf crashJump;
+	static volatile sig_atomic_t crashSignal = 0;
+	static volatile std::uint64_t crashAddress = 0;
+	static char alternateStack[1 << 16];
+
+	/**
+	 * Records the crashing instruction and jumps back to `RunChild`, which maps it to a source line.
+	 */
+	static void HandleCrash(const int signal, siginfo_t* info, void* context)
+	{
+		const auto userContext = static_cast<ucontext_t*>(context);
+
+		crashSignal = signal;
+#if defined(__x86_64__)
+		crashAddress = static_cast<std::uint64_t>(userContext->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+		crashAddress = static_cast<std::uint64_t>(userContext->uc_mcontext.pc);
+#else
+		(void)userContext;
+#endif
+
+		siglongjmp(crashJump, 1);
+	}
+
+	/**
+	 * Collects the errors located in the compiled file, the in-process counterpart of the serialized diagnostics
+	 * read by `Compile`.
+	 */
+	class CompilationErrorCollector final : public clang::DiagnosticConsumer
+	{
+		std::string fileName_;
+		std::vector<CompilationError>& errors_;
+
+	public:
+		/**
+		 * @param sourceFile The path to the compiled source file.
+		 * @param errors The container to which the errors are added.
+		 */
+		CompilationErrorCollector(const std::string& sourceFile, std::vector<CompilationError>& errors) :
+			fileName_(llvm::sys::path::filename(sourceFile).str()), errors_(errors)
+		{
+		}
+
+		void HandleDiagnostic(const clang::DiagnosticsEngine::Level level, const clang::Diagnostic& info) override
+		{
+			DiagnosticConsumer::HandleDiagnostic(level, info);
+
+			if (level < clang::DiagnosticsEngine::Error || !info.getLocation().isValid() || !info.hasSourceManager())
+			{
+				return;
+			}
+
+			// Only the errors located in the compiled file itself can be mapped to its code units.
+			const auto location = info.getSourceManager().getPresumedLoc(info.getLocation());
+
+			if (location.isInvalid() || llvm::sys::path::filename(location.getFilename()) != fileName_)
+			{
+				return;
+			}
+
+			llvm::SmallString<128> message;
+			info.FormatDiagnostic(message);
+
+			errors_.push_back({location.getLine(), message.str().str()});
+		}
+	};
+
+	/**
+	 * Compiles a source file into an LLVM module in-process, using the same options as `Compile`.
+	 *
+	 * @param sourceFile The path to the source file.
+	 * @param language The programming language in which the source file is written.
+	 * @param context The context owning the module.
+	 * @param errors If set, the errors of a failed compilation are added to it.
+	 * @return The module, null if the source file could not be compiled.
+	 */
+	static std::unique_ptr<llvm::Module> EmitModule(const std::string& sourceFile, const clang::Language language,
+	                                                llvm::LLVMContext& context,
+	                                                std::vector<CompilationError>* errors = nullptr)
+	{
+		// The driver finds the headers (and the resource directory) the same way it does for `Compile`.
+		const auto clangPath = llvm::sys::findProgramByName(language == clang::Language::CXX ? "clang++" : "clang");
+
+		if (!clangPath)
+		{
+			return nullptr;
+		}
+
+		const auto arguments = std::vector<const char*>{
+			clangPath->c_str(), "-O0", GetDebugInfoFlag(), "-c", sourceFile.c_str()
+		};
+
+		// Diagnostics are buffered, see `RunCompilerDriver`.
+		std::string diagnostics;
+		llvm::raw_string_ostream diagnosticStream(diagnostics);
+
+		auto diagnosticOptions = llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions>(new clang::DiagnosticOptions());
+		clang::DiagnosticConsumer* printer = new clang::TextDiagnosticPrinter(diagnosticStream, diagnosticOptions.get());
+
+		if (errors != nullptr)
+		{
+			printer = new clang::ChainedDiagnosticConsumer(std::unique_ptr<clang::DiagnosticConsumer>(printer),
+			                                               std::make_unique<CompilationErrorCollector>(
+				                                               sourceFile, *errors));
+		}
+
+		auto diagnosticsEngine = clang::CompilerInstance::createDiagnostics(diagnosticOptions.get(), printer);
+
+		auto invocation = clang::createInvocationFromCommandLine(arguments, diagnosticsEngine);
+
+		if (!invocation)
+		{
+			Out::All() << diagnosticStream.str() << "\n";
+			return nullptr;
+		}
+
+		clang::CompilerInstance compiler;
+		compiler.setInvocation(std::move(invocation));
+		compiler.setDiagnostics(diagnosticsEngine.get());
+
+		clang::EmitLLVMOnlyAction action(&context);
+
+		const auto success = compiler.ExecuteAction(action);
+
+		Out::All() << diagnosticStream.str() << "\n";
+
+		return success ? action.takeModule() : nullptr;
+	}
+
+	/**
+	 * Inserts a call of the `TraceFunctionName` function before the first instruction of each line of the source file
+	 * in each basic block. The call gets the line as its argument.
+	 *
+	 * @param module The module compiled from the source file.
+	 * @param sourceFile The path to the source file, the code of other files (e.g., headers) is not traced.
+	 * @return The sorted lines with any code.
+	 */
+	static std::vector<size_t> InstrumentLines(llvm::Module& module, const std::string& sourceFile)
+	{
+		const auto sourceName = llvm::sys::path::filename(sourceFile);
+		auto& context = module.getContext();
+		const auto lineType = llvm::Type::getInt64Ty(context);
+		const auto traceFunction = module.getOrInsertFunction(TraceFunctionName, llvm::Type::getVoidTy(context),
+		                                                      lineType);
+
+		auto codeLines = std::vector<size_t>();
+
+		for (auto& function : module)
+		{
+			for (auto& block : function)
+			{
+				auto previousLine = 0u;
+
+				for (auto it = block.getFirstInsertionPt(); it != block.end(); ++it)
+				{
+					const auto& location = it->getDebugLoc();
+
+					if (llvm::isa<llvm::DbgInfoIntrinsic>(*it) || !location || location.getLine() == 0 ||
+						location.getLine() == previousLine || llvm::sys::path::filename(location->getFilename()) != sourceName)
+					{
+						continue;
+					}
+
+					previousLine = location.getLine();
+					codeLines.push_back(previousLine);
+
+					const auto lineArgument = llvm::ConstantInt::get(lineType, previousLine);
+					const auto call = llvm::CallInst::Create(traceFunction, {lineArgument}, "", &*it);
+					call->setDebugLoc(location);
+				}
+			}
+		}
+
+		std::sort(codeLines.begin(), codeLines.end());
+		codeLines.erase(std::unique(codeLines.begin(), codeLines.end()), codeLines.end());
+
+		return codeLines;
+	}
+
+	/**
+	 * The body of the child - JIT-compiles the module, runs its `main` with the `--arguments` and reports a crash.\n
+	 * Never returns.
+	 *
+	 * @param module The module to be run.
+	 * @param context The context owning the module.
+	 * @param sourceFile The name of the source file, passed as the first argument of `main`.
+	 * @param workingDirectory The directory in which `main` is run.
+	 * @param traced True if the module has been instrumented by `InstrumentLines`.
+	 * @param reportFd The file descriptor to which the crash report is written.
+	 */
+	[[noreturn]] static void RunChild(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context,
+	                                  const std::string& sourceFile, const char* workingDirectory, const bool traced,
+	                                  const int reportFd)
+	{
+		// The output of the tested program is discarded.
+		const auto null = open("/dev/null", O_RDWR);
+
+		if (null >= 0)
+		{
+			dup2(null, STDIN_FILENO);
+			dup2(null, STDOUT_FILENO);
+			dup2(null, STDERR_FILENO);
+		}
+
+		if (chdir(workingDirectory) != 0)
+		{
+			_exit(EXIT_FAILURE);
+		}
+
+		DebugInfoListener listener;
+
+		auto jit = llvm::orc::LLJITBuilder().setObjectLinkingLayerCreator(
+			[&listener](llvm::orc::ExecutionSession& session, const llvm::Triple&)
+			{
+				auto layer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(session, []()
+				{
+					return std::make_unique<llvm::SectionMemoryManager>();
+				});
+
+				layer->registerJITEventListener(listener);
+
+				return layer;
+			}).create();
+
+		if (!jit)
+		{
+			_exit(EXIT_FAILURE);
+		}
+
+		auto& mainLibrary = (*jit)->getMainJITDylib();
+
+		// The C (and C++) library is resolved from AutoPIE itself.
+		mainLibrary.addGenerator(llvm::cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+			(*jit)->getDataLayout().getGlobalPrefix())));
+
+		// The program ends through the child, see `ExitChild`.
+		RedirectExit(*module);
+
+		llvm::orc::SymbolMap childSymbols;
+		const auto addSymbol = [&childSymbols, &jit](const char* name, auto* function)
+		{
+			childSymbols[(*jit)->mangleAndIntern(name)] = llvm::JITEvaluatedSymbol(
+				llvm::pointerToJITTargetAddress(function), llvm::JITSymbolFlags::Exported);
+		};
+
+		addSymbol(ExitFunctionNames[0].second, &ExitChild);
+		addSymbol(ExitFunctionNames[1].second, &RegisterExitHandler);
+		addSymbol(ExitFunctionNames[2].second, &RegisterCxaExitHandler);
+
+		if (traced)
+		{
+			addSymbol(TraceFunctionName, &TraceLine);
+		}
+
+		if (mainLibrary.define(llvm::orc::absoluteSymbols(std::move(childSymbols))))
+		{
+			_exit(EXIT_FAILURE);
+		}
+
+		if ((*jit)->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context))))
+		{
+			_exit(EXIT_FAILURE);
+		}
+
+		auto mainSymbol = (*jit)->lookup("main");
+
+		if (!mainSymbol || (*jit)->initialize(mainLibrary))
+		{
+			_exit(EXIT_FAILURE);
+		}
+
+		const auto main = reinterpret_cast<int (*)(int, char**)>(static_cast<uintptr_t>(mainSymbol->getAddress()));
+
+		stack_t stack{};
+		stack.ss_sp = alternateStack;
+		stack.ss_size = sizeof alternateStack;
+		sigaltstack(&stack, nullptr);
+
+		struct sigaction action{};
+		action.sa_sigaction = HandleCrash;
+		action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+
+		for (const auto signal : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTRAP})
+		{
+			sigaction(signal, &action, nullptr);
+		}
+
+		// The arguments are passed the same way the LLDB launches the executable.
+		auto programName = std::string(llvm::sys::path::filename(sourceFile));
+		auto programArguments = std::string(Arguments);
+		char* argv[] = {programName.data(), programArguments.data(), nullptr};
+
+		childJit = jit->get();
+
+		if (sigsetjmp(crashJump, 1) == 0)
+		{
+			ExitChild(main(2, argv));
+		}
+
+		// The program crashed, the handler jumped back here.
+		const auto lineInfo = listener.FindLine(crashAddress);
+
+		CrashReport report{};
+		report.signal = crashSignal;
+		report.line = lineInfo.Line;
+
+		const auto fileName = llvm::sys::path::filename(lineInfo.FileName).str();
+		std::strncpy(report.fileName, fileName.c_str(), sizeof report.fileName - 1);
+
+		if (write(reportFd, &report, sizeof report) != static_cast<ssize_t>(sizeof report))
+		{
+			_exit(EXIT_FAILURE);
+		}
+
+		// Terminate by the signal, so that the parent sees the same status as with the compiled executable.
+		signal(crashSignal, SIG_DFL);
+		raise(crashSignal);
+		_exit(EXIT_FAILURE);
+	}
+
+	/**
+	 * Initializes the native target of the JIT once per process.
+	 */
+	static void InitializeTarget()
+	{
+		static std::once_flag targetInitialization;
+
+		std::call_once(targetInitialization, []()
+		{
+			llvm::InitializeNativeTarget();
+			llvm::InitializeNativeTargetAsmPrinter();
+			llvm::InitializeNativeTargetAsmParser();
+		});
+	}
+
+	/**
+	 * Runs the `main` of a module in the ORC JIT inside a forked child.\n
+	 * The child is killed if it does not finish in time. Crashes are mapped to source lines using the debug
+	 * information of the JIT-compiled code.
+	 *
+	 * @param module The module to be run.
+	 * @param context The context owning the module.
+	 * @param sourceFile The path to the source file of the module.
+	 * @param timeout The time limit of the run in seconds.
+	 * @param workingDirectory The directory in which `main` is run.
+	 * @param traced True if the module has been instrumented by `InstrumentLines`.
+	 * @return The outcome of the run, the module is marked as compiled. If the child could not be started,
+	 * the reason is set as the failure of the result.
+	 */
+	static JitResult RunModule(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context,
+	                           const std::string& sourceFile, const int timeout, const char* workingDirectory,
+	                           const bool traced)
+	{
+		JitResult result;
+		result.compiled = true;
+
+		Instrumentation::ScopedPhase executionPhase("execution");
+
+		int pipeFds[2];
+
+		if (pipe(pipeFds) != 0)
+		{
+			result.failure = std::string("The JIT could not create a pipe: ") + std::strerror(errno);
+			return result;
+		}
+
+		// The child holds only the forking thread. It never returns into AutoPIE and it always ends by `_exit`
+		// (see `ExitChild`), so it neither runs the static destructors of AutoPIE nor waits for its other threads.
+		const auto pid = fork();
+
+		if (pid == 0)
+		{
+			close(pipeFds[0]);
+			RunChild(std::move(module), std::move(context), sourceFile, workingDirectory, traced, pipeFds[1]);
+		}
+
+		close(pipeFds[1]);
+
+		if (pid < 0)
+		{
+			result.failure = std::string("The JIT could not fork: ") + std::strerror(errno);
+			close(pipeFds[0]);
+			return result;
+		}
+
+		// The report is followed by the end of the file once the child terminates.
+		std::string received;
+		pollfd descriptor{pipeFds[0], POLLIN, 0};
+
+		while (true)
+		{
+			const auto ready = poll(&descriptor, 1, timeout * 1000);
+
+			if (ready < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (ready <= 0)
+			{
+				Out::Verb() << "The run has not finished in " << timeout << " seconds, killing the process ...\n";
+				result.execution.timedOut = true;
+				kill(pid, SIGKILL);
+				break;
+			}
+
+			char buffer[sizeof(CrashReport)];
+			const auto done = read(pipeFds[0], buffer, sizeof buffer);
+
+			if (done <= 0)
+			{
+				break;
+			}
+
+			received.append(buffer, static_cast<size_t>(done));
+		}
+
+		close(pipeFds[0]);
+
+		int status = 0;
+		waitpid(pid, &status, 0);
+
+		if (WIFSIGNALED(status))
+		{
+			result.execution.signal = WTERMSIG(status);
+		}
+		else if (WIFEXITED(status))
+		{
+			result.execution.exitCode = WEXITSTATUS(status);
+		}
+
+		CrashReport report{};
+
+		if (received.size() == sizeof report)
+		{
+			std::memcpy(&report, received.data(), sizeof report);
+		}
+
+		if (report.line != 0 && report.signal == result.execution.signal)
+		{
+			result.execution.crashedInExecutable = true;
+			result.crashLine = report.line;
+			result.crashFile = report.fileName;
+		}
+
+		Instrumentation::Count("jit/runs");
+
+		return result;
+	}
+
+	/**
+	 * Compiles a source file into LLVM IR in-process and runs its `main` in the ORC JIT inside a forked child,
+	 * without linking an executable, see `RunModule`.
+	 *
+	 * @param sourceFile The path to the source file.
+	 * @param language The programming language in which the source file is written.
+	 * @param timeout The time limit of the run in seconds.
+	 * @param errors If set, the errors of a failed compilation are added to it, see `DependencyGraph::LearnFromErrors`.
+	 * @return The outcome of the compilation and the run.
+	 */
+	JitResult RunInJit(const std::string& sourceFile, const clang::Language language, const int timeout,
+	                   std::vector<CompilationError>* errors)
+	{
+		InitializeTarget();
+
+		Instrumentation::ScopedPhase compilationPhase("compile");
+
+		auto context = std::make_unique<llvm::LLVMContext>();
+		auto module = EmitModule(sourceFile, language, *context, errors);
+
+		compilationPhase.Stop();
+
+		if (!module)
+		{
+			return JitResult();
+		}
+
+		return RunModule(std::move(module), std::move(context), sourceFile, timeout, TempFolder, false);
+	}
+
+	/**
+	 * Compiles a source file into LLVM IR in-process, instruments each of its lines and runs its `main` in the ORC
+	 * JIT inside a forked child, see `InstrumentLines` and `RunModule`.\n
+	 * The lines executed by the child are recorded in memory shared with AutoPIE, so that the trace survives
+	 * a crash. Only the lines first executed before the last execution of the stop line are reported, the run
+	 * is not cut short, since the error may occur only after the stop line has been executed several times.
+	 *
+	 * @param sourceFile The path to the source file, the run takes place in the current directory.
+	 * @param language The programming language in which the source file is written.
+	 * @param timeout The time limit of the run in seconds.
+	 * @param stopLine The line up to which the lines are traced, usually the error location.
+	 * @return The outcome of the run and the executed lines.
+	 */
+	JitTrace TraceInJit(const std::string& sourceFile, const clang::Language language, const int timeout,
+	                    const size_t stopLine)
+	{
+		InitializeTarget();
+
+		JitTrace trace;
+
+		Instrumentation::ScopedPhase compilationPhase("compile");
+
+		auto context = std::make_unique<llvm::LLVMContext>();
+		auto module = EmitModule(sourceFile, language, *context);
+
+		if (!module)
+		{
+			return trace;
+		}
+
+		trace.codeLines = InstrumentLines(*module, sourceFile);
+
+		compilationPhase.Stop();
+
+		traceLineCount = trace.codeLines.empty() ? 0 : trace.codeLines.back() + 1;
+		traceStopLine = stopLine;
+
+		const auto bufferSize = (2 + traceLineCount) * sizeof(TraceCounter);
+		const auto buffer = mmap(nullptr, bufferSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+		if (buffer == MAP_FAILED)
+		{
+			trace.run.compiled = true;
+			trace.run.failure = std::string("The JIT could not map the trace: ") + std::strerror(errno);
+			return trace;
+		}
+
+		// The mapping is zero-filled, no line has been executed yet.
+		traceBuffer = static_cast<TraceCounter*>(buffer);
+
+		trace.run = RunModule(std::move(module), std::move(context), sourceFile, timeout, ".", true);
+
+		// The child has terminated, its writes are visible.
+		const auto stopEvent = traceBuffer[1].load(std::memory_order_relaxed);
+		trace.reachedStopLine = stopEvent != 0;
+
+		for (auto line : trace.codeLines)
+		{
+			const auto firstEvent = traceBuffer[2 + line].load(std::memory_order_relaxed);
+
+			if (firstEvent != 0 && firstEvent <= stopEvent)
+			{
+				trace.executedLines.push_back(line);
+			}
+		}
+
+		munmap(buffer, bufferSize);
+		traceBuffer = nullptr;
+
+		Instrumentation::Count("jit/traced-lines", trace.executedLines.size());
+
+		return trace;
+	}
+} // namespace Execution
+
+#endif
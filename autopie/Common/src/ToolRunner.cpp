@@ -0,0 +1,146 @@
+#include <clang/Tooling/Tooling.h>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/VirtualFileSystem.h>
+
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "../include/Streams.h"
+#include "../include/ThreadPool.h"
+#include "../include/ToolRunner.h"
+
+namespace Common
+{
+	/**
+	 * Keeps the results of `stat` calls made by tools running in parallel.\n
+	 * Header-heavy inputs make every translation unit look up the same headers and include directories,
+	 * the cache lets each of them hit the disk only once per parallel run.
+	 */
+	class SharedStatCache
+	{
+		std::mutex mutex_;
+		std::unordered_map<std::string, llvm::ErrorOr<llvm::vfs::Status>> statuses_;
+
+	public:
+
+		std::optional<llvm::ErrorOr<llvm::vfs::Status>> Find(const std::string& path)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			const auto it = statuses_.find(path);
+
+			if (it == statuses_.end())
+			{
+				return std::nullopt;
+			}
+
+			return it->second;
+		}
+
+		void Insert(const std::string& path, const llvm::ErrorOr<llvm::vfs::Status>& status)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			statuses_.emplace(path, status);
+		}
+	};
+
+	/**
+	 * A file system answering `status` queries from a shared cache.\n
+	 * Each tool gets its own instance on top of its own physical file system, so that the working directory
+	 * of one tool (set from its compile command) does not affect the others or the process itself.
+	 */
+	class StatCachingFileSystem final : public llvm::vfs::ProxyFileSystem
+	{
+		std::shared_ptr<SharedStatCache> cache_;
+
+	public:
+
+		StatCachingFileSystem(llvm::IntrusiveRefCntPtr<FileSystem> fileSystem,
+		                      std::shared_ptr<SharedStatCache> cache) : ProxyFileSystem(std::move(fileSystem)),
+		                                                                cache_(std::move(cache))
+		{
+		}
+
+		llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override
+		{
+			llvm::SmallString<256> absolutePath;
+			path.toVector(absolutePath);
+
+			if (makeAbsolute(absolutePath))
+			{
+				return ProxyFileSystem::status(path);
+			}
+
+			const auto key = absolutePath.str().str();
+
+			if (auto cached = cache_->Find(key))
+			{
+				if (*cached)
+				{
+					// Callers expect the status to carry the name they have asked for.
+					return llvm::vfs::Status::copyWithNewName(**cached, path);
+				}
+
+				return *cached;
+			}
+
+			auto result = ProxyFileSystem::status(path);
+			cache_->Insert(key, result);
+
+			return result;
+		}
+	};
+
+	/**
+	 * Runs the given jobs concurrently on the shared thread pool.\n
+	 * Each job is run by its own `ClangTool`, all tools share a single stat cache.
+	 * The progress is reported through the `Out` streams, one whole line at a time.
+	 *
+	 * @param jobs The jobs to be run, their factories are used by the worker threads.
+	 * @param adjuster The arguments adjuster applied to all tools.
+	 * @return The exit codes of the tools, in the order of the jobs.
+	 */
+	std::vector<int> RunToolsInParallel(std::vector<ToolJob>& jobs, const clang::tooling::ArgumentsAdjuster& adjuster)
+	{
+		auto cache = std::make_shared<SharedStatCache>();
+		auto results = std::vector<std::future<int>>();
+		size_t finishedJobs = 0;
+
+		for (auto& job : jobs)
+		{
+			results.push_back(GetSharedThreadPool().Submit([&job, &jobs, &adjuster, &cache, &finishedJobs]()
+			{
+				const auto fileSystem = llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(
+					new StatCachingFileSystem(
+						llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(
+							llvm::vfs::createPhysicalFileSystem().release()), cache));
+
+				clang::tooling::ClangTool tool(job.compilations, job.filePath,
+				                               std::make_shared<clang::PCHContainerOperations>(), fileSystem);
+				tool.appendArgumentsAdjuster(adjuster);
+
+				const auto result = tool.run(job.factory.get());
+
+				const auto lock = Out::Lock();
+				finishedJobs++;
+
+				Out::All() << "[" << finishedJobs << "/" << jobs.size() << "] " << job.filePath <<
+					(result == 0 ? "" : " (failed)") << "\n";
+
+				return result;
+			}));
+		}
+
+		auto exitCodes = std::vector<int>();
+
+		for (auto& result : results)
+		{
+			exitCodes.push_back(result.get());
+		}
+
+		return exitCodes;
+	}
+} // namespace Common
@@ -16,6 +16,9 @@ namespace Delta
 	std::unique_ptr<clang::tooling::FrontendActionFactory> DeltaDebuggingFrontendActionFactory(
 		GlobalContext& context, int iteration, int partitionCount, DeltaIterationResults& result);
 
+	std::unique_ptr<clang::tooling::FrontendActionFactory> ProjectAnalysisFrontendActionFactory(
+		GlobalContext& context, TranslationUnit& unit);
+
 	/**
 	 * Specifies the frontend action for running the Delta debugging algorithm.\n
 	 * Currently creates a unifying consumer.
@@ -44,6 +47,29 @@ namespace Delta
 				std::make_unique<DeltaDebuggingConsumer>(&ci, globalContext_, iteration_, partitionCount_, result_));
 		}
 	};
+
+	/**
+	 * Specifies the frontend action for analyzing a translation unit of a project.\n
+	 * Currently creates the project analysis consumer.
+	 */
+	class ProjectAnalysisAction final : public clang::ASTFrontendAction
+	{
+		GlobalContext& globalContext_;
+		TranslationUnit& unit_;
+
+	public:
+
+		ProjectAnalysisAction(GlobalContext& context, TranslationUnit& unit) : globalContext_(context), unit_(unit)
+		{
+		}
+
+		std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& ci, llvm::StringRef /*file*/)
+		override
+		{
+			return std::unique_ptr<clang::ASTConsumer>(
+				std::make_unique<ProjectAnalysisConsumer>(&ci, globalContext_, unit_));
+		}
+	};
 } // namespace Delta
 
 #endif
@@ -3,6 +3,9 @@
 #pragma once
 
 #include <clang/AST/ASTConsumer.h>
+#include <clang/Frontend/CompilerInstance.h>
+
+#include <numeric>
 
 #include "../../Common/include/Consumers.h"
 #include "../../Common/include/Context.h"
@@ -12,12 +15,47 @@
 
 namespace Delta
 {
+	/**
+	 * Maps a single translation unit of a project before the reduction starts.\n
+	 * The results (the unit's language, its code unit count and potential error lines) are saved to the unit.
+	 */
+	class ProjectAnalysisConsumer final : public clang::ASTConsumer
+	{
+		DependencyMappingASTConsumer mappingConsumer_;
+		TranslationUnit& unit_;
+
+	public:
+		ProjectAnalysisConsumer(clang::CompilerInstance* ci, GlobalContext& context,
+		                        TranslationUnit& unit) : mappingConsumer_(ci, context, 0, unit.errorLine), unit_(unit)
+		{
+			unit_.language = ci->getFrontendOpts().Inputs[0].getKind().getLanguage();
+		}
+
+		void HandleTranslationUnit(clang::ASTContext& context) override
+		{
+			mappingConsumer_.HandleTranslationUnit(context);
+
+			unit_.codeUnitCount = mappingConsumer_.GetCodeUnitsCount();
+			unit_.errorLines = mappingConsumer_.GetPotentialErrorLines();
+		}
+	};
+
 	/**
 	 * Unifies other consumers and uses them to describe the Delta debugging logic.\n
 	 * Single `HandleTranslationUnit` manages one run of the Delta debugging algorithm.
 	 */
 	class DeltaDebuggingConsumer final : public clang::ASTConsumer
 	{
+		/**
+		 * The probability of a code unit being necessary before any test of ProbDD has been done.
+		 */
+		static constexpr double InitialKeepProbability = 0.1;
+
+		/**
+		 * Units of ProbDD with a probability above this threshold are considered necessary.
+		 */
+		static constexpr double KeptThreshold = 1 - 1e-9;
+
 		DependencyMappingASTConsumer mappingConsumer_;
 		VariantPrintingASTConsumer printingConsumer_;
 		int iteration_;
@@ -26,24 +64,118 @@ namespace Delta
 		GlobalContext& globalContext_;
 		DeltaIterationResults& result_;
 
+		/**
+		 * Lists all code units of the current test case, the units split by flat ddmin.
+		 *
+		 * @param codeUnitCount The number of code units in the current test case.
+		 * @return The traversal order numbers of all code units.
+		 */
+		static std::vector<int> GetAllUnits(const int codeUnitCount)
+		{
+			auto units = std::vector<int>(codeUnitCount);
+			std::iota(units.begin(), units.end(), 0);
+
+			return units;
+		}
+
+		/**
+		 * Lists the code units in the level of the statement tree that is currently being minimized by HDD.\n
+		 * All units in shallower levels have already been minimized and are kept.
+		 *
+		 * @param dependencyGraph The graph of the current test case.
+		 * @param codeUnitCount The number of code units in the current test case.
+		 * @return The traversal order numbers of the units in the current level.
+		 */
+		[[nodiscard]] std::vector<int> GetLevelUnits(const DependencyGraph& dependencyGraph,
+		                                             const int codeUnitCount) const
+		{
+			const auto depths = dependencyGraph.GetStatementDepths(codeUnitCount);
+			auto units = std::vector<int>();
+
+			for (auto i = 0; i < codeUnitCount; i++)
+			{
+				if (depths[i] == globalContext_.deltaContext.hierarchyLevel)
+				{
+					units.push_back(i);
+				}
+			}
+
+			return units;
+		}
+
+		/**
+		 * Creates a bit mask of a variant in which the given units are removed.\n
+		 * In HDD and ProbDD, the descendants of the removed units are removed as well, since they cannot be kept
+		 * without their parents.
+		 *
+		 * @param removedUnits The traversal order numbers of the units that should be removed.
+		 * @param dependencyGraph The graph of the current test case.
+		 * @param codeUnitCount The number of code units in the current test case.
+		 * @return The bit mask of the variant.
+		 */
+		static BitMask CreateVariantMask(const std::vector<int>& removedUnits, DependencyGraph& dependencyGraph,
+		                                 const int codeUnitCount)
+		{
+			auto bitMask = BitMask(codeUnitCount, true);
+
+			for (auto unit : removedUnits)
+			{
+				bitMask[unit] = false;
+
+				if (Strategy != ReductionStrategy::DDMin)
+				{
+					for (auto dependency : dependencyGraph.GetDependentNodes(unit))
+					{
+						if (dependency < codeUnitCount)
+						{
+							bitMask[dependency] = false;
+						}
+					}
+				}
+			}
+
+			return bitMask;
+		}
+
 		/**
 		 * Validates the current bit mask by generating source code, compiling it and
 		 * executing it.
 		 *
 		 * @param context ASTContext of the current traversal.
 		 * @param bitmask The bit mask on which the source code variant should be based.
-		 * @param dependencyGraph The graph for heuristics and printing-safety.
+		 * @param dependencyGraph The graph for heuristics and printing-safety. With `--learn-dependencies`, the
+		 * dependencies learned from the errors of the variant are added to it.
+		 * @param tested If set, it is set to whether the variant has been generated and validated, i.e., it has not
+		 * been rejected by the dependencies beforehand.
 		 * @return True if the variant represented by the given bit mask was correct,
 		 * false otherwise.
 		 */
 		bool IsFailureInducingSubset(clang::ASTContext& context, const BitMask& bitmask,
-		                             DependencyGraph& dependencyGraph) const
+		                             DependencyGraph& dependencyGraph, bool* tested = nullptr) const
 		{
+			if (tested != nullptr)
+			{
+				*tested = false;
+			}
+
 			// Check whether the bit mask is worth generating into source code.
-			if (IsValid(bitmask, dependencyGraph, false).first)
+			if (dependencyGraph.ViolatesLearnedDependencies(bitmask))
+			{
+				Instrumentation::Count("rejected/learned");
+			}
+			else if (!IsValid(bitmask, dependencyGraph, false).first)
+			{
+				Instrumentation::Count("rejected/dependencies");
+			}
+			else
 			{
 				globalContext_.stats.totalIterations++;
 
+				if (tested != nullptr)
+				{
+					*tested = true;
+				}
+
 				try
 				{
 					if (std::filesystem::exists(fileName_))
@@ -53,8 +185,20 @@ namespace Delta
 
 					// Convert the bit mask into source code, update the adjusted locations.
 					printingConsumer_.HandleTranslationUnit(context, fileName_, bitmask);
-					globalContext_.variantAdjustedErrorLocations[iteration_] = printingConsumer_.
-						GetAdjustedErrorLines();
+
+					const auto& project = globalContext_.deltaContext.project;
+
+					if (project.IsEnabled() && project.activeUnit != project.criterionUnit)
+					{
+						// The error occurs in another translation unit whose lines remain untouched.
+						globalContext_.variantAdjustedErrorLocations[iteration_] = project.units[project.criterionUnit].
+							errorLines;
+					}
+					else
+					{
+						globalContext_.variantAdjustedErrorLocations[iteration_] = printingConsumer_.
+							GetAdjustedErrorLines();
+					}
 
 					// Compile and execute the generated source code.
 					if (ValidateVariant(globalContext_, std::filesystem::directory_entry(fileName_)))
@@ -62,6 +206,14 @@ namespace Delta
 						Out::All() << "Iteration " << iteration_ << ": smaller subset found.\n";
 						return true;
 					}
+
+					if (LearnDependencies)
+					{
+						auto& deltaContext = globalContext_.deltaContext;
+						auto& learned = deltaContext.learnedDependencies[deltaContext.project.activeUnit];
+
+						dependencyGraph.LearnFromErrors(bitmask, globalContext_.compilationErrors, &learned);
+					}
 				}
 				catch (...)
 				{
@@ -72,27 +224,239 @@ namespace Delta
 			return false;
 		}
 
+		/**
+		 * Runs the iteration body of the probabilistic Delta debugging algorithm (ProbDD).\n
+		 * Each code unit has a probability of being necessary for the error. The units with the lowest
+		 * probabilities are removed together, the size of the removed set maximizes the expected number
+		 * of removed units. If the variant fails (i.e., the desired outcome), it becomes the new test case.
+		 * Otherwise, the probabilities of the units in the set are raised and another set is tried.
+		 * Units whose probability reaches one are kept for good. Variants rejected by the dependencies without being
+		 * validated leave the probabilities untouched, a smaller set is tried instead.
+		 *
+		 * @param context The AST context.
+		 * @param dependencyGraph The graph of the current test case.
+		 * @param codeUnitCount The number of code units in the current test case.
+		 */
+		void HandleProbabilisticIteration(clang::ASTContext& context, DependencyGraph& dependencyGraph,
+		                                  const int codeUnitCount) const
+		{
+			auto& probabilities = globalContext_.deltaContext.keepProbabilities;
+
+			if (probabilities.size() != static_cast<size_t>(codeUnitCount))
+			{
+				// The test case has not been produced by the previous iteration, nothing is known about its units.
+				probabilities.assign(codeUnitCount, InitialKeepProbability);
+			}
+
+			// Units whose removal would also remove the criterion must be kept.
+			for (auto i = 0; i < codeUnitCount; i++)
+			{
+				if (dependencyGraph.IsInCriterion(i))
+				{
+					probabilities[i] = 1;
+					continue;
+				}
+
+				for (auto dependency : dependencyGraph.GetDependentNodes(i))
+				{
+					if (dependencyGraph.IsInCriterion(dependency))
+					{
+						probabilities[i] = 1;
+						break;
+					}
+				}
+			}
+
+			// The maximum size of the removed set, lowered whenever a variant is rejected without being validated.
+			auto removalLimit = static_cast<size_t>(codeUnitCount);
+
+			while (true)
+			{
+				auto candidates = std::vector<int>();
+
+				for (auto i = 0; i < codeUnitCount; i++)
+				{
+					if (probabilities[i] < KeptThreshold)
+					{
+						candidates.push_back(i);
+					}
+				}
+
+				if (candidates.empty())
+				{
+					Out::Verb() << "All remaining code units are necessary.\n";
+
+					result_ = DeltaIterationResults::Unsplitable;
+					return;
+				}
+
+				std::stable_sort(candidates.begin(), candidates.end(), [&probabilities](const int a, const int b)
+				{
+					return probabilities[a] < probabilities[b];
+				});
+
+				// Find the number of the least probable units whose removal has the best expected gain.
+				auto removalCount = 1;
+				auto bestGain = 0.0;
+				auto survivalProbability = 1.0;
+
+				for (size_t i = 0; i < candidates.size() && i < removalLimit; i++)
+				{
+					survivalProbability *= 1 - probabilities[candidates[i]];
+
+					const auto gain = static_cast<double>(i + 1) * survivalProbability;
+
+					if (gain > bestGain)
+					{
+						bestGain = gain;
+						removalCount = static_cast<int>(i + 1);
+					}
+				}
+
+				const auto removedUnits = std::vector<int>(candidates.begin(), candidates.begin() + removalCount);
+				const auto bitMask = CreateVariantMask(removedUnits, dependencyGraph, codeUnitCount);
+
+				Out::Verb() << "Removing " << removalCount << " of " << candidates.size() <<
+					" candidate code units, expected gain: " << bestGain << ".\n";
+
+				auto tested = false;
+
+				if (IsFailureInducingSubset(context, bitMask, dependencyGraph, &tested))
+				{
+					// Carry the probabilities of the remaining units over to the next iteration.
+					auto remainingProbabilities = std::vector<double>();
+
+					for (auto i = 0; i < codeUnitCount; i++)
+					{
+						if (bitMask[i])
+						{
+							remainingProbabilities.push_back(probabilities[i]);
+						}
+					}
+
+					probabilities = std::move(remainingProbabilities);
+
+					result_ = DeltaIterationResults::FailingComplement;
+					return;
+				}
+
+				if (!tested)
+				{
+					// The variant has not been run, it tells nothing about whether the units are necessary.
+					Instrumentation::Count("probabilistic/untested");
+
+					if (removalCount > 1)
+					{
+						removalLimit = static_cast<size_t>(removalCount) - 1;
+					}
+					else
+					{
+						// The unit cannot be removed on its own, it stays in the test case.
+						probabilities[removedUnits.front()] = 1;
+						removalLimit = static_cast<size_t>(codeUnitCount);
+					}
+
+					continue;
+				}
+
+				removalLimit = static_cast<size_t>(codeUnitCount);
+
+				// At least one of the units is necessary, update the probabilities accordingly.
+				const auto failureProbability = 1 - GetSurvivalProbability(removedUnits);
+
+				for (auto unit : removedUnits)
+				{
+					probabilities[unit] = removalCount == 1
+						                      ? 1
+						                      : std::min(1.0, probabilities[unit] / failureProbability);
+				}
+			}
+		}
+
+		/**
+		 * Computes the probability that none of the given units is necessary.
+		 *
+		 * @param units The traversal order numbers of the units.
+		 * @return The product of the probabilities of the units being unnecessary.
+		 */
+		[[nodiscard]] double GetSurvivalProbability(const std::vector<int>& units) const
+		{
+			const auto& probabilities = globalContext_.deltaContext.keepProbabilities;
+			auto survivalProbability = 1.0;
+
+			for (auto unit : units)
+			{
+				survivalProbability *= 1 - probabilities[unit];
+			}
+
+			return survivalProbability;
+		}
+
+		/**
+		 * Tries removing all top-level declarations unreachable from the criterion in a single variant.\n
+		 * The declarations are found statically, thus the variant is validated before it becomes the new test case.
+		 *
+		 * @param context The AST context.
+		 * @param dependencyGraph The graph of the current test case.
+		 * @param codeUnitCount The number of code units in the current test case.
+		 * @return True if the variant without the unreachable declarations still fails, false otherwise.
+		 */
+		bool TryPruneUnreachable(clang::ASTContext& context, DependencyGraph& dependencyGraph,
+		                         const int codeUnitCount) const
+		{
+			auto unreachable = std::vector<int>();
+
+			{
+				Instrumentation::ScopedPhase pruning("pruning");
+				unreachable = dependencyGraph.GetUnreachableDeclarations(codeUnitCount);
+			}
+
+			if (unreachable.empty())
+			{
+				Out::Verb() << "No declarations are unreachable from the criterion.\n";
+				return false;
+			}
+
+			auto bitMask = BitMask(codeUnitCount, true);
+
+			for (auto declaration : unreachable)
+			{
+				bitMask[declaration] = false;
+
+				for (auto dependency : dependencyGraph.GetStatementDependentNodes(declaration))
+				{
+					if (dependency < codeUnitCount)
+					{
+						bitMask[dependency] = false;
+					}
+				}
+			}
+
+			Out::All() << "Iteration " << iteration_ << ": removing " << unreachable.size() <<
+				" declarations unreachable from the criterion.\n";
+
+			if (!IsFailureInducingSubset(context, bitMask, dependencyGraph))
+			{
+				Out::All() << "The unreachable declarations are needed for the error, continuing without pruning.\n";
+				return false;
+			}
+
+			Instrumentation::Count("pruned/declarations", unreachable.size());
+			return true;
+		}
+
 	public:
 		DeltaDebuggingConsumer(clang::CompilerInstance* ci, GlobalContext& context, const int iteration,
 		                       const int partitionCount, DeltaIterationResults& result) : mappingConsumer_(ci, context,
 		                                                                                                   iteration),
 		                                                                                  printingConsumer_(
-			                                                                                  ci, context
-			                                                                                      .parsedInput.
-			                                                                                      errorLocation.
-			                                                                                      lineNumber),
+			                                                                                  ci, context.GetErrorLine()),
 		                                                                                  iteration_(iteration),
 		                                                                                  partitionCount_(
 			                                                                                  partitionCount),
 		                                                                                  fileName_(
-			                                                                                  TempFolder + std::
-			                                                                                  to_string(iteration_) +
-			                                                                                  "_" + GetFileName(
-				                                                                                  context.parsedInput.
-				                                                                                          errorLocation.
-				                                                                                          filePath) +
-			                                                                                  LanguageToExtension(
-				                                                                                  context.language)),
+			                                                                                  context.GetVariantFileName(
+				                                                                                  iteration)),
 		                                                                                  globalContext_(context),
 		                                                                                  result_(result)
 
@@ -110,7 +474,9 @@ namespace Delta
 		 * 5. Loop over the second container and test analogically.\n
 		 * 6. If a variant fails, decrement granularity and set the file to that variant \n
 		 * 7. If nothing fails, multiply granularity by 2.\n
-		 * Granularity is set elsewhere, the function only propagates the result of the iteration.
+		 * Granularity is set elsewhere, the function only propagates the result of the iteration.\n
+		 * In HDD, only the code units in the current level of the statement tree are split, the removal of a unit
+		 * removes its whole subtree. Once the level cannot be split further, the next level is minimized.
 		 * @param context The AST context.
 		 */
 		void HandleTranslationUnit(clang::ASTContext& context) override
@@ -122,30 +488,98 @@ namespace Delta
 			globalContext_.deltaContext.latestCodeUnitCount = numberOfCodeUnits;
 			globalContext_.variantAdjustedErrorLocations.clear();
 
+			auto& project = globalContext_.deltaContext.project;
+
+			if (project.IsEnabled())
+			{
+				project.ActiveUnit().codeUnitCount = numberOfCodeUnits;
+
+				if (project.activeUnit == project.criterionUnit)
+				{
+					project.ActiveUnit().errorLines = mappingConsumer_.GetPotentialErrorLines();
+				}
+			}
+
 			printingConsumer_.SetData(mappingConsumer_.GetSkippedNodes(), mappingConsumer_.GetDependencyGraph(),
 			                          mappingConsumer_.GetPotentialErrorLines());
 
 			auto dependencies = mappingConsumer_.GetDependencyGraph();
 
+			if (LearnDependencies)
+			{
+				const auto restored = dependencies.RestoreLearnedDependencies(
+					globalContext_.deltaContext.learnedDependencies[project.activeUnit]);
+
+				Out::Verb() << "Restored " << restored << " dependencies learned in the previous iterations.\n";
+			}
+
+			if (globalContext_.deltaContext.pruneUnreachable)
+			{
+				// The pre-pass runs once, the following iterations work on its result.
+				globalContext_.deltaContext.pruneUnreachable = false;
+
+				if (TryPruneUnreachable(context, dependencies, numberOfCodeUnits))
+				{
+					result_ = DeltaIterationResults::Pruned;
+					return;
+				}
+			}
+
+			if (Strategy == ReductionStrategy::ProbDD)
+			{
+				Out::Verb() << "Current iteration: " << iteration_ << ".\n";
+				Out::Verb() << "Current code unit count: " << numberOfCodeUnits << ".\n";
+
+				HandleProbabilisticIteration(context, dependencies, numberOfCodeUnits);
+				return;
+			}
+
+			const auto hierarchical = Strategy == ReductionStrategy::HDD;
+
+			// Flat ddmin splits all code units, HDD only those in the current level of the statement tree.
+			const auto units = hierarchical
+				                   ? GetLevelUnits(dependencies, numberOfCodeUnits)
+				                   : GetAllUnits(numberOfCodeUnits);
+			const auto numberOfUnits = static_cast<int>(units.size());
+
+			globalContext_.deltaContext.latestUnitCount = numberOfUnits;
+
 			Out::Verb() << "Current iteration: " << iteration_ << ".\n";
 			Out::Verb() << "Current code unit count: " << numberOfCodeUnits << ".\n";
 			Out::Verb() << "Current partition count: " << partitionCount_ << ".\n";
 
-			if (partitionCount_ > numberOfCodeUnits)
+			if (hierarchical)
+			{
+				Out::Verb() << "Current level: " << globalContext_.deltaContext.hierarchyLevel << " with " <<
+					numberOfUnits << " code units.\n";
+
+				if (numberOfUnits == 0)
+				{
+					// Levels are contiguous, there are no deeper levels either.
+					Out::Verb() << "The statement tree has no more levels.\n";
+
+					result_ = DeltaIterationResults::Unsplitable;
+					return;
+				}
+			}
+
+			if (partitionCount_ > numberOfUnits)
 			{
 				// Cannot be split further.
-				Out::Verb() << "The current test case cannot be split further.\n";
+				Out::Verb() << "The current " << (hierarchical ? "level" : "test case") << " cannot be split further.\n";
 
-				result_ = DeltaIterationResults::Unsplitable;
+				result_ = hierarchical ? DeltaIterationResults::LevelMinimized : DeltaIterationResults::Unsplitable;
 				return;
 			}
 
+			Instrumentation::ScopedPhase binning("binning");
+
 			std::vector<BitMask> partitions;
 			std::vector<BitMask> complements;
-			const auto partitionSize = numberOfCodeUnits / partitionCount_;
+			const auto partitionSize = numberOfUnits / partitionCount_;
 
 			// Split into `n` partition and their complements.
-			Out::Verb() << "Splitting " << numberOfCodeUnits << " code units into " << partitionCount_
+			Out::Verb() << "Splitting " << numberOfUnits << " code units into " << partitionCount_
 				<< " partitions of size " << partitionSize << " units...\n";
 
 			// Create even-sized splittings.
@@ -156,39 +590,32 @@ namespace Delta
 				ranges[i] = partitionSize;
 			}
 
-			for (auto i = 0; i < numberOfCodeUnits % partitionCount_; i++)
+			for (auto i = 0; i < numberOfUnits % partitionCount_; i++)
 			{
 				ranges[i]++;
 			}
 
-			// Assign bits into partitions.
+			// Assign units into partitions, a partition keeps its own units, a complement removes them.
 			auto sum = 0;
 			for (auto i = 0; i < partitionCount_; i++)
 			{
-				auto partition = BitMask(numberOfCodeUnits);
-				auto complement = BitMask(numberOfCodeUnits);
+				std::vector<int> inside(units.begin() + sum, units.begin() + sum + ranges[i]);
+				std::vector<int> outside(units.begin(), units.begin() + sum);
+				outside.insert(outside.end(), units.begin() + sum + ranges[i], units.end());
 
-				// Determine whether each code unit belongs to the current partition.
-				for (auto j = 0; j < numberOfCodeUnits; j++)
+				sum += ranges[i];
+
+				// A partition containing all units is the current test case, there is no need to test it.
+				if (!outside.empty())
 				{
-					if (sum <= j && j < sum + ranges[i])
-					{
-						partition[j] = true;
-						complement[j] = false;
-					}
-					else
-					{
-						partition[j] = false;
-						complement[j] = true;
-					}
+					partitions.emplace_back(CreateVariantMask(outside, dependencies, numberOfCodeUnits));
 				}
 
-				sum += ranges[i];
-
-				partitions.emplace_back(partition);
-				complements.emplace_back(complement);
+				complements.emplace_back(CreateVariantMask(inside, dependencies, numberOfCodeUnits));
 			}
 
+			binning.Stop();
+
 			Out::Verb() << "Splitting done.\n";
 			Out::Verb() << "Validating " << partitions.size() << " partitions...\n";
 
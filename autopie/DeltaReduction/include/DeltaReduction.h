@@ -0,0 +1,18 @@
+#ifndef DELTA_REDUCTION_H
+#define DELTA_REDUCTION_H
+#pragma once
+
+namespace Delta
+{
+	/**
+	 * Generates a locally minimal program variant by running Delta debugging.\n
+	 * Used as the entry point of both the `DeltaReduction` binary and the `delta` stage of the `autopie` driver.
+	 *
+	 * @param argc The number of command-line arguments.
+	 * @param argv The command-line arguments, including the program name.
+	 * @return The exit code of the run.
+	 */
+	int RunDeltaReduction(int argc, const char** argv);
+}
+
+#endif
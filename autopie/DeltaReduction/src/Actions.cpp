@@ -46,4 +46,37 @@ namespace Delta
 		return std::unique_ptr<clang::tooling::FrontendActionFactory>(
 			std::make_unique<DeltaDebuggingFrontendActionFactory>(context, iteration, partitionCount, result));
 	}
+
+	/**
+	 * Creates a `ProjectAnalysisFrontendActionFactory` with given members for data transfers.\n
+	 * Any `ProjectAnalysisAction`s created by the factory then save their results to the given unit.
+	 *
+	 * @param context A reference to the global context which should be passed onto created instances.
+	 * @param unit The translation unit of the project which should be analyzed.
+	 * @return A `ProjectAnalysisFrontendActionFactory` instance with the given members.
+	 */
+	std::unique_ptr<clang::tooling::FrontendActionFactory> ProjectAnalysisFrontendActionFactory(
+		GlobalContext& context, TranslationUnit& unit)
+	{
+		class ProjectAnalysisFrontendActionFactory : public clang::tooling::FrontendActionFactory
+		{
+			GlobalContext& context_;
+			TranslationUnit& unit_;
+
+		public:
+
+			ProjectAnalysisFrontendActionFactory(GlobalContext& context, TranslationUnit& unit) : context_(context),
+				unit_(unit)
+			{
+			}
+
+			std::unique_ptr<clang::FrontendAction> create() override
+			{
+				return std::make_unique<ProjectAnalysisAction>(context_, unit_);
+			}
+		};
+
+		return std::unique_ptr<clang::tooling::FrontendActionFactory>(
+			std::make_unique<ProjectAnalysisFrontendActionFactory>(context, unit));
+	}
 } // namespace Delta
@@ -3,105 +3,101 @@
 #include <llvm/Support/CommandLine.h>
 
 #include <clang/Tooling/CommonOptionsParser.h>
+#include <clang/Tooling/CompilationDatabase.h>
 #include <clang/Tooling/Tooling.h>
 
 #include <filesystem>
+#include <future>
 
 #include "../../Common/include/Context.h"
 #include "../../Common/include/Helper.h"
 #include "../../Common/include/Options.h"
 #include "../../Common/include/Streams.h"
+#include "../../Common/include/ThreadPool.h"
+#include "../../Common/include/ToolRunner.h"
 #include "../include/Actions.h"
+#include "../include/DeltaReduction.h"
 
 using namespace llvm;
 using namespace Common;
 
 /**
- * Generates a locally minimal program variant by running Delta debugging.
- * 
- * Call:\n
- * > DeltaReduction.exe [line with error] [error description message] [runtime arguments] <source path> --
- * e.g. DeltaReduction.exe --loc-line=17 --error-message="segmentation fault" --arguments="arg1 arg2" example.cpp --
+ * End the search after a given number of iterations.\n
+ * No point in repeating the mistakes of the naive search...
+ */
+static const auto CutOffLimit = 0xffff;
+
+/**
+ * Records an accepted variant of the translation unit that is currently being reduced in project mode.\n
+ * The variant's object file is linked in from now on. If the unit contains the error, its error lines
+ * are moved to their adjusted locations.
+ *
+ * @param context The global context containing the project.
+ * @param testCase The path to the accepted variant.
+ * @param iteration The iteration in which the variant was accepted.
  */
-int main(int argc, const char** argv)
+static void UpdateActiveUnit(GlobalContext& context, const std::string& testCase, const int iteration)
 {
-	// Parse the command-line args passed to the tool.
-	clang::tooling::CommonOptionsParser op(argc, argv, AutoPieArgs);
+	auto& project = context.deltaContext.project;
+	auto& unit = project.ActiveUnit();
 
-	if (op.getSourcePathList().size() > 1)
+	unit.currentTestCase = testCase;
+
+	if (const auto object = project.variantObjects.find(testCase); object != project.variantObjects.end())
 	{
-		errs() << "Only a single source file is supported.\n";
-		return EXIT_FAILURE;
+		unit.currentObject = object->second;
 	}
 
-	auto parsedInput = InputData(static_cast<std::basic_string<char>>(ErrorMessage),
-	                             Location(op.getSourcePathList()[0], LineNumber), ReductionRatio,
-	                             DumpDot);
-
-	// Prompt the user to clear the temp directory.
-	if (!ClearTempDirectory())
+	if (project.activeUnit == project.criterionUnit && !context.variantAdjustedErrorLocations[iteration].empty())
 	{
-		errs() << "Terminating...\n";
-		return EXIT_FAILURE;
+		unit.errorLines = context.variantAdjustedErrorLocations[iteration];
+		unit.errorLine = unit.errorLines.front();
 	}
+}
 
-	const auto epochCount = 5;
+/**
+ * Runs the minimizing Delta debugging algorithm on a single file until the file cannot be split further.\n
+ * Each iteration parses the current test case, tests its partitions and complements and decides the next step.
+ *
+ * @param compilations The compilation database used for parsing the test cases.
+ * @param includes The adjuster adding the standard include paths.
+ * @param context The global context of the reduction.
+ * @param currentTestCase The path to the file that should be reduced.
+ * @param iteration The number of the last iteration, updated by the performed iterations.
+ * @return The path to the locally minimal variant, the input path if no smaller variant has been found.
+ */
+static std::string RunDeltaDebugging(const clang::tooling::CompilationDatabase& compilations,
+                                     const clang::tooling::ArgumentsAdjuster& includes, GlobalContext& context,
+                                     std::string currentTestCase, int& iteration)
+{
+	// HDD starts each level by trying to remove the whole level at once.
+	const auto hierarchical = Strategy == ReductionStrategy::HDD;
+	auto partitionCount = hierarchical ? 1 : 2;
 
-	auto context = GlobalContext(parsedInput, *op.getSourcePathList().begin(), epochCount);
-	clang::tooling::ClangTool tool(op.getCompilations(), context.parsedInput.errorLocation.filePath);
+	auto done = false;
+	auto first = true;
 
-	// Include paths are not always recognized, especially for standard/system includes.
-	// This Adjuster helps with that.
-	auto includes = clang::tooling::getInsertArgumentAdjuster("-I/usr/local/lib/clang/11.0.0/include/");
-	tool.appendArgumentsAdjuster(includes);
+	auto& checkpoint = context.checkpoint;
 
-	auto inputLanguage = clang::Language::Unknown;
-	// Run a language check inside a separate scope so that all built ASTs get freed at the end.
+	if (checkpoint.resumed && checkpoint.currentTestCase == currentTestCase)
 	{
-		Out::Verb() << "Checking the language...\n";
-
-		std::vector<std::unique_ptr<clang::ASTUnit>> trees;
-		tool.buildASTs(trees);
-
-		if (trees.size() != 1)
-		{
-			errs() << "Although only one AST was expected, " << trees.size() << " ASTs have been built.\n";
-			return EXIT_FAILURE;
-		}
-
-		inputLanguage = (*trees.begin())->getInputKind().getLanguage();
-
-		Out::Verb() << "File: " << (*trees.begin())->getOriginalSourceFileName() << ", language: " <<
-			LanguageToString(inputLanguage) << "\n";
+		// The level and the probabilities have been loaded with the checkpoint.
+		partitionCount = checkpoint.partitionCount;
+		first = false;
+		context.deltaContext.pruneUnreachable = false;
 	}
-
-	assert(inputLanguage != clang::Language::Unknown);
-
-	context.language = inputLanguage;
-
-	// Check whether the given line is in the file and pretty print it to the standard output.
-	if (!CheckLocationValidity(parsedInput.errorLocation.filePath, parsedInput.errorLocation.lineNumber))
+	else
 	{
-		errs() << "The specified error location is invalid!\nSource path: " << parsedInput.errorLocation.filePath
-			<< ", line: " << parsedInput.errorLocation.lineNumber << " could not be found.\n";
+		context.deltaContext.hierarchyLevel = 0;
+		context.deltaContext.keepProbabilities.clear();
+		context.deltaContext.pruneUnreachable = PruneUnreachable;
 	}
 
-	LLDBSentry sentry;
-
-	auto iteration = 0;
-	// End the search after a given number of iterations.
-	// No point in repeating the mistakes of the naive search...
-	const auto cutOffLimit = 0xffff;
-
-	auto partitionCount = 2;
-	auto currentTestCase = context.parsedInput.errorLocation.filePath;
-
-	auto done = false;
-	auto first = true;
+	checkpoint.resumed = false;
 
 	// Iterate until convergence (or until patience runs out) and call the iteration handler.
 	// Collect the results of the iteration and determine the next step.
-	while (!done && iteration < cutOffLimit)
+	while (!done && iteration < CutOffLimit)
 	{
 		iteration++;
 
@@ -112,12 +108,13 @@ int main(int argc, const char** argv)
 
 		DeltaIterationResults iterationResult;
 
-		clang::tooling::ClangTool newTool(op.getCompilations(), currentTestCase);
+		clang::tooling::ClangTool newTool(compilations, currentTestCase);
 		newTool.appendArgumentsAdjuster(includes);
 
 		// Run all Clang AST related actions.
-		auto result = newTool.run(
-			Delta::DeltaDebuggingFrontendActionFactory(context, iteration, partitionCount, iterationResult).get());
+		auto result = RunOnSharedAST(newTool, compilations, currentTestCase,
+		                             Delta::DeltaDebuggingFrontendActionFactory(
+			                             context, iteration, partitionCount, iterationResult).get());
 
 		if (result != 0)
 		{
@@ -128,7 +125,7 @@ int main(int argc, const char** argv)
 		if (first)
 		{
 			double k = context.deltaContext.latestCodeUnitCount;
-			context.stats.expectedIterations = k * k + 3 * k;
+			context.stats.expectedIterations += k * k + 3 * k;
 			first = false;
 		}
 
@@ -137,35 +134,447 @@ int main(int argc, const char** argv)
 		{
 		case DeltaIterationResults::FailingPartition:
 			partitionCount = 2;
-			currentTestCase = TempFolder + std::to_string(iteration) + "_" + GetFileName(
-				context.parsedInput.errorLocation.filePath) + LanguageToExtension(context.language);
+			currentTestCase = context.GetVariantFileName(iteration);
 			break;
 		case DeltaIterationResults::FailingComplement:
-			partitionCount -= 1;
-			currentTestCase = TempFolder + std::to_string(iteration) + "_" + GetFileName(
-				context.parsedInput.errorLocation.filePath) + LanguageToExtension(context.language);
+			partitionCount = hierarchical ? std::max(partitionCount - 1, 1) : partitionCount - 1;
+			currentTestCase = context.GetVariantFileName(iteration);
 			break;
 		case DeltaIterationResults::Passing:
-			if (partitionCount * 2 < context.deltaContext.latestCodeUnitCount || partitionCount == context
-			                                                                                       .deltaContext.
-			                                                                                       latestCodeUnitCount)
+			if (partitionCount * 2 < context.deltaContext.latestUnitCount || partitionCount == context
+			                                                                                   .deltaContext.
+			                                                                                   latestUnitCount)
 			{
 				partitionCount *= 2;
 			}
 			else
 			{
-				partitionCount = context.deltaContext.latestCodeUnitCount;
+				partitionCount = context.deltaContext.latestUnitCount;
 			}
 			break;
+		case DeltaIterationResults::Pruned:
+			// The granularity is kept, the pruned test case is split the same way the original would be.
+			currentTestCase = context.GetVariantFileName(iteration);
+			break;
+		case DeltaIterationResults::LevelMinimized:
+			context.deltaContext.hierarchyLevel++;
+			partitionCount = 1;
+
+			Out::Verb() << "Moving to level " << context.deltaContext.hierarchyLevel << " of the statement tree.\n";
+			break;
 		case DeltaIterationResults::Unsplitable:
 			done = true;
 			break;
 		default:
 			throw std::invalid_argument("Invalid iteration result.");
 		}
+
+		if (context.deltaContext.project.IsEnabled() && (iterationResult == DeltaIterationResults::FailingPartition ||
+			iterationResult == DeltaIterationResults::FailingComplement || iterationResult ==
+			DeltaIterationResults::Pruned))
+		{
+			UpdateActiveUnit(context, currentTestCase, iteration);
+		}
+
+		checkpoint.iteration = iteration;
+		checkpoint.currentTestCase = currentTestCase;
+		checkpoint.partitionCount = partitionCount;
+		SaveCheckpoint(context, "delta");
+	}
+
+	return currentTestCase;
+}
+
+/**
+ * Lists the source files of a project - the source paths or, if there is a single source path, the given path
+ * followed by the other files of the compilation database.
+ *
+ * @param op The parsed command line.
+ * @return The paths to the translation units of the project.
+ */
+static std::vector<std::string> GetProjectFiles(clang::tooling::CommonOptionsParser& op)
+{
+	auto files = op.getSourcePathList();
+
+	if (files.size() == 1)
+	{
+		// Keep the given path as it was written, the database adds the other units of the project.
+		for (const auto& file : op.getCompilations().getAllFiles())
+		{
+			std::error_code errorCode;
+
+			if (!std::filesystem::equivalent(file, files.front(), errorCode))
+			{
+				files.push_back(file);
+			}
+		}
+	}
+
+	return files;
+}
+
+/**
+ * Creates the translation units of a project, analyzes them and compiles their original objects.\n
+ * The units are taken from `GetProjectFiles`. Units are analyzed in parallel, each on its own `ClangTool`.
+ *
+ * @param op The parsed command line.
+ * @param includes The adjuster adding the standard include paths.
+ * @param context The global context whose project should be set up.
+ * @return True if all units could be analyzed and compiled, false otherwise.
+ */
+static bool SetUpProject(clang::tooling::CommonOptionsParser& op, const clang::tooling::ArgumentsAdjuster& includes,
+                         GlobalContext& context)
+{
+	auto& project = context.deltaContext.project;
+	auto& compilations = op.getCompilations();
+
+	const auto files = GetProjectFiles(op);
+	const auto criterionFile = LocationFile.empty() ? op.getSourcePathList()[0] : std::string(LocationFile);
+
+	for (const auto& file : files)
+	{
+		const auto commands = compilations.getCompileCommands(file);
+
+		if (commands.empty())
+		{
+			errs() << "No compile command has been found for " << file << ".\n";
+			return false;
+		}
+
+		auto unit = Delta::TranslationUnit();
+		unit.originalPath = file;
+		unit.currentTestCase = file;
+		unit.name = std::to_string(project.units.size()) + "-" + GetFileName(file);
+		unit.compileFlags = GetStandaloneCompileFlags(commands.front());
+
+		std::error_code errorCode;
+
+		if (std::filesystem::equivalent(file, criterionFile, errorCode))
+		{
+			project.criterionUnit = project.units.size();
+			unit.errorLine = context.parsedInput.errorLocation.lineNumber;
+		}
+
+		project.units.push_back(std::move(unit));
+	}
+
+	if (project.units[project.criterionUnit].errorLine == 0)
+	{
+		errs() << "The file " << criterionFile << " is not a part of the project.\n";
+		return false;
+	}
+
+	for (const auto& flag : SplitToWords(LinkFlags, ' '))
+	{
+		if (!flag.empty())
+		{
+			project.linkFlags.push_back(flag);
+		}
+	}
+
+	Out::All() << "Analyzing " << project.units.size() << " translation units...\n";
+
+	// Variants are parsed from the working directory, the original directories are kept in the flags.
+	const auto workingDirectory = std::filesystem::current_path().string();
+	auto unitCompilations = std::vector<std::unique_ptr<clang::tooling::FixedCompilationDatabase>>();
+	auto jobs = std::vector<ToolJob>();
+
+	for (auto& unit : project.units)
+	{
+		unitCompilations.push_back(
+			std::make_unique<clang::tooling::FixedCompilationDatabase>(workingDirectory, unit.compileFlags));
+		jobs.emplace_back(*unitCompilations.back(), unit.originalPath,
+		                  Delta::ProjectAnalysisFrontendActionFactory(context, unit));
+	}
+
+	const auto analyses = RunToolsInParallel(jobs, includes);
+
+	auto valid = true;
+
+	for (size_t i = 0; i < analyses.size(); i++)
+	{
+		if (analyses[i] != 0 || project.units[i].language == clang::Language::Unknown)
+		{
+			errs() << "The translation unit " << project.units[i].originalPath << " could not be analyzed.\n";
+			valid = false;
+		}
+	}
+
+	if (!valid)
+	{
+		return false;
+	}
+
+	// Compile the original objects, later iterations only compile the unit being reduced.
+	auto objectCompilations = std::vector<std::future<int>>();
+
+	for (auto& unit : project.units)
+	{
+		Out::Verb() << "Unit " << unit.name << ": " << unit.codeUnitCount << " code units, language: " <<
+			LanguageToString(unit.language) << "\n";
+
+		unit.currentObject = TempFolder + std::string("0_") + unit.name + ".o";
+
+		objectCompilations.push_back(GetSharedThreadPool().Submit([&unit]()
+		{
+			return CompileToObject(unit.originalPath, unit.currentObject, unit.language, unit.compileFlags);
+		}));
+	}
+
+	for (size_t i = 0; i < objectCompilations.size(); i++)
+	{
+		if (objectCompilations[i].get() != 0)
+		{
+			errs() << "The translation unit " << project.units[i].originalPath << " could not be compiled.\n";
+			valid = false;
+		}
+	}
+
+	if (!valid)
+	{
+		return false;
+	}
+
+	context.stats.inputSizeInBytes = 0;
+
+	for (const auto& unit : project.units)
+	{
+		context.stats.inputSizeInBytes += std::filesystem::file_size(unit.originalPath);
+	}
+
+	return true;
+}
+
+/**
+ * Reduces all translation units of a project jointly.\n
+ * Units are reduced one after another by the Delta debugging algorithm, the rest of the project is linked in
+ * using the current object files. Rounds over all units are repeated until no unit changes, since a reduction
+ * of one unit may allow further reductions in another.
+ *
+ * @param op The parsed command line.
+ * @param includes The adjuster adding the standard include paths.
+ * @param context The global context of the reduction.
+ * @return The exit code of the reduction.
+ */
+static int RunProjectReduction(clang::tooling::CommonOptionsParser& op,
+                               const clang::tooling::ArgumentsAdjuster& includes, GlobalContext& context)
+{
+	if (!SetUpProject(op, includes, context))
+	{
+		errs() << "Terminating...\n";
+		return EXIT_FAILURE;
+	}
+
+	auto& project = context.deltaContext.project;
+	const auto workingDirectory = std::filesystem::current_path().string();
+
+	auto iteration = 0;
+	auto changed = true;
+
+	auto& checkpoint = context.checkpoint;
+	auto resumedRound = checkpoint.resumed;
+	size_t firstUnit = 0;
+
+	if (checkpoint.resumed)
+	{
+		if (checkpoint.units.size() != project.units.size())
+		{
+			errs() << "The checkpoint does not match the project.\nTerminating...\n";
+			return EXIT_FAILURE;
+		}
+
+		// Continue with the saved test cases of all units.
+		for (size_t i = 0; i < project.units.size(); i++)
+		{
+			project.units[i].currentTestCase = checkpoint.units[i].currentTestCase;
+			project.units[i].currentObject = checkpoint.units[i].currentObject;
+			project.units[i].codeUnitCount = checkpoint.units[i].codeUnitCount;
+			project.units[i].errorLine = checkpoint.units[i].errorLine;
+			project.units[i].errorLines = checkpoint.units[i].errorLines;
+		}
+
+		iteration = checkpoint.iteration;
+		firstUnit = checkpoint.activeUnit;
+	}
+
+	while (changed && iteration < CutOffLimit)
+	{
+		changed = false;
+
+		for (auto i = firstUnit; i < project.units.size() && iteration < CutOffLimit; i++)
+		{
+			project.activeUnit = i;
+			checkpoint.activeUnit = i;
+			auto& unit = project.ActiveUnit();
+
+			if (unit.codeUnitCount == 0)
+			{
+				continue;
+			}
+
+			Out::All() << "Reducing the translation unit " << unit.originalPath << "...\n";
+
+			context.language = unit.language;
+
+			const clang::tooling::FixedCompilationDatabase unitCompilations(workingDirectory, unit.compileFlags);
+			const auto previousTestCase = unit.currentTestCase;
+
+			RunDeltaDebugging(unitCompilations, includes, context, unit.currentTestCase, iteration);
+
+			if (unit.currentTestCase != previousTestCase)
+			{
+				changed = true;
+			}
+		}
+
+		// The units reduced before the checkpoint might have changed in the resumed round.
+		changed = changed || resumedRound;
+		resumedRound = false;
+		firstUnit = 0;
+	}
+
+	Out::All() << "Finished. Done " << iteration << " DD iterations.\n";
+	RemoveCheckpoint();
+
+	// Save the results no matter the outcome.
+	auto reduced = false;
+	context.stats.outputSizeInBytes = 0;
+
+	for (auto& unit : project.units)
+	{
+		const auto newFileName = TempFolder + std::string("autoPieOut_") + unit.name + LanguageToExtension(
+			unit.language);
+
+		Out::All() << "Translation unit " << unit.originalPath << ": " << unit.currentTestCase << "\n";
+		Out::All() << "Changing the file path to '" << newFileName << "'.\n";
+
+		if (unit.currentTestCase != unit.originalPath)
+		{
+			std::filesystem::rename(unit.currentTestCase, newFileName);
+			reduced = true;
+		}
+		else
+		{
+			std::filesystem::copy_file(unit.originalPath, newFileName,
+			                           std::filesystem::copy_options::overwrite_existing);
+		}
+
+		PrintResult(newFileName);
+
+		context.stats.outputSizeInBytes += std::filesystem::file_size(newFileName);
+	}
+
+	DisplayStats(context.stats);
+
+	if (reduced)
+	{
+		return EXIT_SUCCESS;
 	}
 
+	Out::All() << "A smaller error-inducing project could not be found.\n";
+
+	return EXIT_FAILURE;
+}
+
+/**
+ * Generates a locally minimal program variant by running Delta debugging.\n
+ * Serves as the body of the `DeltaReduction` binary and of the `delta` stage of the `autopie` driver.\n
+ * If multiple source files are given or the `--project` option is used, all translation units are reduced
+ * jointly and linked together for validation.
+ *
+ * Call:\n
+ * > DeltaReduction.exe [line with error] [error description message] [runtime arguments] <source path> --
+ * e.g. DeltaReduction.exe --loc-line=17 --error-message="segmentation fault" --arguments="arg1 arg2" example.cpp --\n
+ * > DeltaReduction.exe --project -p <build path> [line with error] [file with error] [error description message] <source path>
+ * e.g. DeltaReduction.exe --project -p build --loc-line=17 --loc-file=src/crash.c --error-message="segmentation fault" src/main.c
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments, including the program name.
+ * @return The exit code of the reduction.
+ */
+int Delta::RunDeltaReduction(int argc, const char** argv)
+{
+	// Parse the command-line args passed to the tool.
+	auto op = ParseCommandLine(argc, argv);
+
+	if (!op)
+	{
+		return EXIT_FAILURE;
+	}
+
+	const auto projectMode = ProjectMode || op->getSourcePathList().size() > 1;
+	const auto errorFile = projectMode && !LocationFile.empty()
+		                       ? std::string(LocationFile)
+		                       : op->getSourcePathList()[0];
+
+	auto parsedInput = InputData(static_cast<std::basic_string<char>>(ErrorMessage),
+	                             Location(errorFile, LineNumber), ReductionRatio, DumpDot);
+
+	const auto epochCount = 5;
+
+	Statistics::StartRun();
+
+	auto context = GlobalContext(parsedInput, errorFile, epochCount);
+
+	if (projectMode)
+	{
+		context.checkpoint.inputFiles = GetProjectFiles(*op);
+	}
+
+	if (Resume && !LoadCheckpoint(context, "delta"))
+	{
+		errs() << "Terminating...\n";
+		return EXIT_FAILURE;
+	}
+
+	// Prompt the user to clear the temp directory. A resumed reduction continues with the test cases saved in it.
+	if (!context.checkpoint.resumed && !ClearTempDirectory())
+	{
+		errs() << "Terminating...\n";
+		return EXIT_FAILURE;
+	}
+
+	// Include paths are not always recognized, especially for standard/system includes.
+	// This Adjuster helps with that.
+	auto includes = clang::tooling::getInsertArgumentAdjuster("-I/usr/local/lib/clang/11.0.0/include/");
+
+	// Check whether the given line is in the file and pretty print it to the standard output.
+	if (!CheckLocationValidity(parsedInput.errorLocation.filePath, parsedInput.errorLocation.lineNumber))
+	{
+		errs() << "The specified error location is invalid!\nSource path: " << parsedInput.errorLocation.filePath
+			<< ", line: " << parsedInput.errorLocation.lineNumber << " could not be found.\n";
+	}
+
+	LLDBSentry sentry;
+
+	if (projectMode)
+	{
+		return RunProjectReduction(*op, includes, context);
+	}
+
+	clang::tooling::ClangTool tool(op->getCompilations(), context.parsedInput.errorLocation.filePath);
+	tool.appendArgumentsAdjuster(includes);
+
+	const auto inputLanguage = DetermineInputLanguage(tool, op->getCompilations(),
+	                                                  context.parsedInput.errorLocation.filePath);
+
+	if (inputLanguage == clang::Language::Unknown)
+	{
+		return EXIT_FAILURE;
+	}
+
+	context.language = inputLanguage;
+
+	auto iteration = context.checkpoint.resumed ? context.checkpoint.iteration : 0;
+	const auto startingTestCase = context.checkpoint.resumed
+		                              ? context.checkpoint.currentTestCase
+		                              : context.parsedInput.errorLocation.filePath;
+
+	const auto currentTestCase = RunDeltaDebugging(op->getCompilations(), includes, context, startingTestCase,
+	                                               iteration);
+
 	Out::All() << "Finished. Done " << iteration << " DD iterations.\n";
+	RemoveCheckpoint();
 
 	// Save the result no matter the outcome.
 	const auto newFileName = TempFolder + std::string("autoPieOut") + LanguageToExtension(context.language);
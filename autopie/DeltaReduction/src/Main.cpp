@@ -0,0 +1,13 @@
+#include "../../Common/include/Streams.h"
+#include "../include/DeltaReduction.h"
+
+/**
+ * Runs the delta reduction as a standalone program.
+ */
+int main(int argc, const char** argv)
+{
+	const auto result = Delta::RunDeltaReduction(argc, argv);
+	Out::Flush();
+
+	return result;
+}
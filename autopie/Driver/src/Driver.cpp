@@ -0,0 +1,244 @@
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../../Common/include/Helper.h"
+#include "../../Common/include/Streams.h"
+#include "../../DeltaReduction/include/DeltaReduction.h"
+#include "../../NaiveReduction/include/NaiveReduction.h"
+#include "../../SliceExtractor/include/SliceExtractor.h"
+#include "../../VariableExtractor/include/VariableExtractor.h"
+
+#define _SILENCE_ALL_CXX17_DEPRECATION_WARNINGS
+
+using namespace llvm;
+
+/**
+ * Contains the long-lived `autopie` driver which runs all AutoPIE components inside a single process.
+ */
+namespace Driver
+{
+	using StageEntry = int (*)(int, const char**);
+
+	/**
+	 * The prefix of the line printed to the standard output after each request served in the `--serve` mode.\n
+	 * The line is followed by the exit code of the stage, e.g., `@@autopie-done 0`.
+	 */
+	inline const char* DoneMarker = "@@autopie-done";
+
+	/**
+	 * Maps the names of stages, as used on the command line and in requests, to their entry points.
+	 */
+	const std::map<std::string, StageEntry> Stages = {
+		{"naive", Naive::RunNaiveReduction},
+		{"delta", Delta::RunDeltaReduction},
+		{"slice", SliceExtractor::RunSliceExtractor},
+		{"static-slice", SliceExtractor::RunStaticSlicer},
+		{"dynamic-slice", SliceExtractor::RunDynamicSlicer},
+		{"variables", VariableExtractor::RunVariableExtractor}
+	};
+
+	/**
+	 * Runs a single stage in the current process.\n
+	 * The first argument is the name of the stage, the rest is passed to the stage as its command line.
+	 *
+	 * @param arguments The stage name followed by its arguments.
+	 * @return The exit code of the stage.
+	 */
+	int RunStage(const std::vector<std::string>& arguments)
+	{
+		if (arguments.empty())
+		{
+			errs() << "No stage has been specified.\n";
+			return EXIT_FAILURE;
+		}
+
+		const auto stage = Stages.find(arguments[0]);
+
+		if (stage == Stages.end())
+		{
+			errs() << "Unknown stage '" << arguments[0] << "'.\n";
+			return EXIT_FAILURE;
+		}
+
+		// The stage sees its own name as the program name so that its help message and errors make sense.
+		const auto programName = "autopie " + arguments[0];
+
+		std::vector<const char*> argv;
+		argv.push_back(programName.c_str());
+
+		for (auto i = 1; i < arguments.size(); i++)
+		{
+			argv.push_back(arguments[i].c_str());
+		}
+
+		try
+		{
+			return stage->second(static_cast<int>(argv.size()), argv.data());
+		}
+		catch (std::exception& e)
+		{
+			errs() << "The stage '" << arguments[0] << "' has failed: " << e.what() << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	/**
+	 * Prints the help or the version message if the stage options of a request ask for it.\n
+	 * The command-line parser terminates the process after printing these messages, which would end the session.
+	 *
+	 * @param arguments The stage name followed by its arguments.
+	 * @return True if a message has been printed instead of running the stage, false otherwise.
+	 */
+	bool PrintInformation(const std::vector<std::string>& arguments)
+	{
+		// The arguments following `--` are passed to the compiler.
+		const auto end = std::find(arguments.begin(), arguments.end(), "--");
+
+		for (auto it = arguments.begin(); it != end; ++it)
+		{
+			if (it->empty() || it->front() != '-')
+			{
+				continue;
+			}
+
+			const auto option = llvm::StringRef(*it).ltrim('-');
+
+			if (option == "help" || option == "help-list")
+			{
+				cl::PrintHelpMessage(false, false);
+				return true;
+			}
+
+			if (option == "help-hidden" || option == "help-list-hidden")
+			{
+				cl::PrintHelpMessage(false, true);
+				return true;
+			}
+
+			if (option == "version")
+			{
+				cl::PrintVersionMessage();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * Serves stage requests read from the standard input until it is closed.\n
+	 * Each line is expected to hold a JSON array of strings - the stage name followed by its arguments,
+	 * e.g., `["delta", "--loc-line=17", "example.cpp", "--"]`. After the stage finishes, the marker line
+	 * with its exit code is printed so that the client knows where the output of the request ends.
+	 *
+	 * @return The exit code of the driver.
+	 */
+	int Serve()
+	{
+		std::string request;
+
+		while (std::getline(std::cin, request))
+		{
+			if (request.empty())
+			{
+				continue;
+			}
+
+			std::vector<std::string> arguments;
+			auto exitCode = EXIT_FAILURE;
+
+			auto parsed = json::parse(request);
+
+			if (!parsed)
+			{
+				errs() << "The request could not be parsed: " << toString(parsed.takeError()) << "\n";
+			}
+			else if (const auto array = parsed->getAsArray())
+			{
+				auto valid = true;
+
+				for (const auto& value : *array)
+				{
+					if (const auto argument = value.getAsString())
+					{
+						arguments.push_back(argument->str());
+					}
+					else
+					{
+						valid = false;
+					}
+				}
+
+				if (valid && PrintInformation(arguments))
+				{
+					exitCode = EXIT_SUCCESS;
+				}
+				else if (valid)
+				{
+					exitCode = RunStage(arguments);
+				}
+				else
+				{
+					errs() << "The request must contain only strings.\n";
+				}
+			}
+			else
+			{
+				errs() << "The request must be a JSON array.\n";
+			}
+
+			Out::Flush();
+			outs().flush();
+			errs().flush();
+			std::cout << DoneMarker << " " << exitCode << std::endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+}
+
+/**
+ * Runs AutoPIE components inside a single long-lived process.\n
+ * The LLDB debugger is initialized only once for all stages and the AST of an input file is shared between
+ * consecutive stages working on the unchanged file, see `RunOnSharedAST`.
+ *
+ * Call:\n
+ * > autopie <stage> [stage options] <source path> --\n
+ * > autopie --serve
+ *
+ * e.g. autopie delta --loc-line=17 --error-message="segmentation fault" example.cpp --
+ *
+ * Stages: `naive`, `delta`, `slice`, `static-slice`, `dynamic-slice`, `variables`.
+ */
+int main(int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		errs() << "Usage: autopie <stage> [stage options] <source path> --\n"
+			<< "       autopie --serve\n"
+			<< "Stages: naive, delta, slice, static-slice, dynamic-slice, variables\n";
+		return EXIT_FAILURE;
+	}
+
+	// Keep the debugger alive for the whole session, stages reuse it through their nested sentries.
+	LLDBSentry sentry;
+
+	if (std::string(argv[1]) == "--serve")
+	{
+		return Driver::Serve();
+	}
+
+	const auto result = Driver::RunStage(std::vector<std::string>(argv + 1, argv + argc));
+
+	// The output is written by a background thread, an unfinished line would be lost at the exit.
+	Out::Flush();
+
+	return result;
+}
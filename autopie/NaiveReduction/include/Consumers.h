@@ -4,7 +4,9 @@
 
 #include <clang/AST/ASTConsumer.h>
 
+#include <exception>
 #include <future>
+#include <optional>
 #include <utility>
 
 #include "../../Common/include/Consumers.h"
@@ -12,11 +14,26 @@
 #include "../../Common/include/DependencyGraph.h"
 #include "../../Common/include/Helper.h"
 #include "../../Common/include/Streams.h"
+#include "../../Common/include/ThreadPool.h"
 #include "../../Common/include/Visitors.h"
 
 namespace Naive
 {
-	inline std::mutex streamMutex; ///< Locks the output stream in order for messages to appear correctly.
+	/**
+	 * The number of chunks of the binning per worker thread. More chunks balance the load better.
+	 */
+	constexpr size_t ChunksPerWorker = 16;
+
+	/**
+	 * The minimal number of bit masks in a chunk of the binning, smaller chunks are not worth the scheduling.
+	 */
+	constexpr size_t MinimalChunkSize = 256;
+
+	/**
+	 * The minimal number of bit masks each bin may keep in the memory under `--max-memory`. Smaller limits are
+	 * rejected, the bins would be spilled in segments not worth a file.
+	 */
+	constexpr size_t MinimalSpillSize = 4096;
 
 	/**
 	 * Unifies other consumers and uses them to describe the naive variant-generating logic.\n
@@ -47,9 +64,12 @@ namespace Naive
 		 *
 		 * @param context ASTContext of the current traversal.
 		 * @param bitMasks A container of bit masks to be iterated, for which variants will be generated.
+		 * The bit masks are decoded one at a time.
 		 */
-		void GenerateVariantsForABin(clang::ASTContext& context, const std::vector<BitMask>& bitMasks) const
+		void GenerateVariantsForABin(clang::ASTContext& context, const BitMaskBin& bitMasks) const
 		{
+			globalContext_.variantBitMasks.clear();
+
 			auto variantsCount = 0;
 			for (auto& bitMask : bitMasks)
 			{
@@ -62,7 +82,10 @@ namespace Naive
 					Out::All() << "Done " << variantsCount << " variants.\n";
 				}
 
-				Out::Verb() << "Processing valid bitmask " << Stringify(bitMask) << "\n";
+				Out::Verb([&](auto& out)
+				{
+					out << "Processing valid bitmask " << Stringify(bitMask) << "\n";
+				});
 
 				// If we have done something incorrectly - wrong Rewriter buffer overrides,
 				// null nodes dereferences, ..., LibTooling will thrown an appropriate error.
@@ -76,6 +99,11 @@ namespace Naive
 
 					globalContext_.variantAdjustedErrorLocations[variantsCount] = printingConsumer_.
 						GetAdjustedErrorLines();
+
+					if (LearnDependencies)
+					{
+						globalContext_.variantBitMasks[variantsCount] = bitMask;
+					}
 				}
 				catch (...)
 				{
@@ -87,6 +115,206 @@ namespace Naive
 			Out::All() << "Finished. Done " << variantsCount << " variants.\n";
 		}
 
+		/**
+		 * Prints and compiles the mutant schema of the input file, see `VariantPrintingASTConsumer::HandleSchema`.
+		 *
+		 * @param context ASTContext of the current traversal.
+		 * @param numberOfCodeUnits The number of code units.
+		 * @param guardedNodes The nodes guarded in the schema, set by the call.
+		 * @return The path to the executable of the schema, empty if the schema could not be compiled.
+		 */
+		std::string CompileSchema(clang::ASTContext& context, const int numberOfCodeUnits, BitMask& guardedNodes) const
+		{
+			const auto fileName = TempFolder + std::string("schema_") + GetFileName(
+				globalContext_.parsedInput.errorLocation.filePath) + LanguageToExtension(globalContext_.language);
+
+			guardedNodes = printingConsumer_.HandleSchema(context, fileName, numberOfCodeUnits);
+
+			Out::All() << "The mutant schema guards " << std::count(guardedNodes.begin(), guardedNodes.end(), true) <<
+				" out of " << numberOfCodeUnits << " code units.\n";
+
+			const auto entry = std::filesystem::directory_entry(fileName);
+
+			Instrumentation::ScopedPhase phase("compile");
+
+			if (Compile(entry, globalContext_.language) != 0)
+			{
+				Out::All() << "The mutant schema could not be compiled, each variant is compiled separately.\n";
+				return "";
+			}
+
+			return TempFolder + entry.path().filename().replace_extension(".out").string();
+		}
+
+		/**
+		 * Determines whether the mutant schema can run the variant of a given bit mask, i.e., whether all nodes
+		 * removed from the variant are guarded in the schema. Nodes whose parents are removed are removed with
+		 * their parents, skipped nodes are never removed.
+		 *
+		 * @param bitMask The bit mask of the variant.
+		 * @param guardedNodes The nodes guarded in the schema.
+		 * @param dependencies The dependency graph of the input.
+		 * @param skippedNodes The nodes skipped by the printing.
+		 * @return True if the variant can be run by the schema, false otherwise.
+		 */
+		static bool IsSchemaVariant(const BitMask& bitMask, const BitMask& guardedNodes, DependencyGraph& dependencies,
+		                            const std::unordered_map<int, bool>& skippedNodes)
+		{
+			for (size_t i = 0; i < bitMask.size(); i++)
+			{
+				if (bitMask[i] || guardedNodes[i] || skippedNodes.find(static_cast<int>(i)) != skippedNodes.end())
+				{
+					continue;
+				}
+
+				const auto parents = dependencies.GetParentNodes(static_cast<int>(i));
+
+				if (std::all_of(parents.begin(), parents.end(), [&bitMask](const int parent)
+				{
+					return bitMask[parent];
+				}))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		/**
+		 * Validates the bit masks of a bin using the mutant schema.\n
+		 * The bit masks are streamed in the order of the bin, the same order in which `GenerateVariantsForABin`
+		 * prints them, so the bin is never copied and its spilled segments are only mapped one at a time.
+		 * Variants that can be run by the schema are only executed. Variants reproducing the error in the schema,
+		 * as well as those that cannot be run by it, are printed and validated by `ValidateVariant`.
+		 *
+		 * @param context ASTContext of the current traversal.
+		 * @param bitMasks The bin to be validated.
+		 * @param schemaExecutable The path to the executable of the schema.
+		 * @param guardedNodes The nodes guarded in the schema.
+		 * @param dependencies The dependency graph of the input.
+		 * @return True if an error-inducing variant has been found and stored, false otherwise.
+		 */
+		bool ValidateBinUsingSchema(clang::ASTContext& context, const BitMaskBin& bitMasks,
+		                            const std::string& schemaExecutable, const BitMask& guardedNodes,
+		                            DependencyGraph& dependencies) const
+		{
+			const auto skippedNodes = mappingConsumer_.GetSkippedNodes();
+			const auto errorLines = mappingConsumer_.GetPotentialErrorLines();
+
+			auto& cursor = globalContext_.checkpoint.binCursor;
+
+			// The variants validated before the checkpoint are counted as well.
+			globalContext_.stats.totalIterations += cursor;
+
+			size_t i = 0;
+
+			for (auto it = bitMasks.begin(); it != bitMasks.end(); ++it, i++)
+			{
+				if (i < cursor)
+				{
+					continue;
+				}
+
+				const auto& bitMask = *it;
+
+				globalContext_.stats.totalIterations++;
+
+				// Print the progress.
+				if ((i + 1) % 100 == 0)
+				{
+					Out::All() << "Done " << i + 1 << " variants.\n";
+				}
+
+				if (LearnDependencies && dependencies.ViolatesLearnedDependencies(bitMask))
+				{
+					Instrumentation::Count("rejected/learned");
+
+					cursor = i + 1;
+					SaveCheckpoint(globalContext_, "naive");
+					continue;
+				}
+
+				const auto runnable = IsSchemaVariant(bitMask, guardedNodes, dependencies, *skippedNodes);
+
+				if (!runnable || ValidateSchemaVariant(schemaExecutable, bitMask, errorLines))
+				{
+					Instrumentation::Count(runnable ? "schema/reproduced" : "schema/unsupported");
+
+					// Confirm the variant (or validate it, if the schema cannot run it) in the usual way.
+					try
+					{
+						const auto variant = i + 1;
+						const auto fileName = TempFolder + std::to_string(variant) + "_" + GetFileName(
+							globalContext_.parsedInput.errorLocation.filePath) + LanguageToExtension(
+							globalContext_.language);
+
+						printingConsumer_.HandleTranslationUnit(context, fileName, bitMask);
+						globalContext_.variantAdjustedErrorLocations[variant] = printingConsumer_.
+							GetAdjustedErrorLines();
+
+						if (ValidateVariant(globalContext_, std::filesystem::directory_entry(fileName)))
+						{
+							StoreResult(globalContext_, fileName);
+							return true;
+						}
+
+						if (LearnDependencies)
+						{
+							dependencies.LearnFromErrors(bitMask, globalContext_.compilationErrors);
+						}
+					}
+					catch (...)
+					{
+						Out::All() << "Could not process variant no. " << i + 1 << " due to an internal exception.\n";
+					}
+				}
+
+				cursor = i + 1;
+				SaveCheckpoint(globalContext_, "naive");
+			}
+
+			Out::All() << "Finished. Done " << i << " variants.\n";
+
+			return false;
+		}
+
+		/**
+		 * Divides the `--max-memory` limit between the bins that may be held at the same time - the final bins and
+		 * the bins of each chunk, as a finished chunk may wait for the merge of the preceding ones.\n
+		 * Limits that leave less than `MinimalSpillSize` bit masks to a bin cannot be honoured and are rejected.
+		 *
+		 * @param chunkCount The number of chunks of the binning.
+		 * @return The number of bit masks each bin may keep in the memory, zero for no limit, or nothing if
+		 * the limit is too small.
+		 */
+		[[nodiscard]] std::optional<size_t> GetMaxCodesInMemory(const size_t chunkCount) const
+		{
+			if (MaxMemory == 0)
+			{
+				return 0;
+			}
+
+			// The epoch bins, the bin of the ratio 1.0 and the bin of invalid bit masks.
+			const auto binCount = (globalContext_.deepeningContext.epochCount + 2) * (chunkCount + 1);
+
+			// A growing vector may temporarily need twice its size.
+			const auto bytesPerBin = sizeof(EncodedBitMask) * 2;
+			const auto limit = static_cast<size_t>(MaxMemory) * 1024 * 1024 / bytesPerBin / binCount;
+
+			if (limit < MinimalSpillSize)
+			{
+				const auto required = (MinimalSpillSize * bytesPerBin * binCount + 1024 * 1024 - 1) / (1024 * 1024);
+
+				Out::All() << "The `--max-memory` limit of " << static_cast<unsigned>(MaxMemory) <<
+					" MiB cannot be kept by " << binCount << " bins, at least " << required <<
+					" MiB is needed. Consider a greater limit or fewer `--jobs`.\n";
+				return std::nullopt;
+			}
+
+			return limit;
+		}
+
 		/**
 		 * A worker function for parallel runs.\n
 		 * Given a starting bit mask and a number of iterations, the function iterates over all
@@ -96,63 +324,66 @@ namespace Naive
 		 * into a bit mask later.
 		 * @param numberOfVariants The number of iterations - new bit masks to be checked.
 		 * @param numberOfCodeUnits The size of the bit mask.
-		 * @param dependencies A copy of the dependency graph.
-		 * A copy allows us to avoid locking the graph when inserting cache entries.
-		 * @param id The number of the thread used for printing the progress.
+		 * @param dependencies The encoded dependency graph, shared by all workers.
+		 * @param maxCodesInMemory The number of bit masks each bin may keep in the memory before it is spilled
+		 * to the disk, zero for no limit.
 		 * @return All processed bit masks separated into bins - a map of bit mask containers accessible
 		 * by a given size ratio.
 		 */
 		[[nodiscard]] EpochRanges GetValidBitMasksInRange(const size_t startingPoint, const size_t numberOfVariants,
-		                                                  const int numberOfCodeUnits, DependencyGraph dependencies,
-		                                                  const int id) const
+		                                                  const int numberOfCodeUnits,
+		                                                  const EncodedDependencies& dependencies,
+		                                                  const size_t maxCodesInMemory) const
 		{
-			{
-				std::lock_guard<std::mutex> lock(streamMutex);
-				Out::All() << "Thread #" << id << " started.\n";
-			}
-
 			// Create ranges for each epoch.
 			EpochRanges bins;
 
 			for (auto i = 0; i < globalContext_.deepeningContext.epochCount; i++)
 			{
-				bins.insert(
-					std::pair<double, std::vector<BitMask>>((i + 1) * globalContext_.deepeningContext.epochStep,
-					                                        std::vector<BitMask>()));
+				bins.insert(std::pair<double, BitMaskBin>((i + 1) * globalContext_.deepeningContext.epochStep,
+				                                          BitMaskBin(numberOfCodeUnits, maxCodesInMemory)));
 			}
 
 			// Add the last range (of invalid bit masks).
-			bins.insert(std::pair<double, std::vector<BitMask>>(1.0, std::vector<BitMask>()));
-			bins.insert(std::pair<double, std::vector<BitMask>>(INFINITY, std::vector<BitMask>()));
+			bins.insert(std::pair<double, BitMaskBin>(1.0, BitMaskBin(numberOfCodeUnits, maxCodesInMemory)));
+			bins.insert(std::pair<double, BitMaskBin>(INFINITY, BitMaskBin(numberOfCodeUnits, maxCodesInMemory)));
 
-			auto bitMask = BitMask(numberOfCodeUnits);
-			InitializeBitMask(bitMask, startingPoint);
+			// The bit masks are enumerated as integers, incrementing the integer increments the bit mask.
+			const auto lastBitMask = numberOfCodeUnits == 0
+				                         ? 0
+				                         : ~static_cast<EncodedBitMask>(0) >> (MaxEncodedBitMaskSize -
+					                         numberOfCodeUnits);
+			auto bitMask = static_cast<EncodedBitMask>(startingPoint);
+
+			// Counted locally, the shared counters would be locked for each of the bit masks.
+			size_t rejected = 0;
 
 			// Iterate over the given range and assign valid bit masks into bins.
 			for (size_t i = 0; i < numberOfVariants; i++)
 			{
-				Increment(bitMask);
+				bitMask = (bitMask + 1) & lastBitMask;
 
 				const auto validation = IsValid(bitMask, dependencies);
 
 				if (validation.first)
 				{
 					auto it = bins.upper_bound(validation.second);
-					it->second.push_back(bitMask);
+					it->second.Add(bitMask);
+				}
+				else
+				{
+					rejected++;
 				}
 			}
 
-			{
-				std::lock_guard<std::mutex> lock(streamMutex);
-				Out::All() << "Thread #" << id << " finished.\n";
-			}
+			Instrumentation::Count("rejected/dependencies", rejected);
 
 			return bins;
 		}
 
 		/**
-		 * Launches worker threads to validate all possible bit masks.\n
-		 * Creates ranges for the workers and assigns them to each thread.\n
+		 * Validates all possible bit masks using the shared thread pool.\n
+		 * Splits the bit masks into fine-grained chunks, which are then stolen by idle workers.\n
 		 * Merges all results.
 		 *
 		 * @param numberOfCodeUnits The size of each bit mask.
@@ -160,84 +391,129 @@ namespace Naive
 		 */
 		void PartitionVariantsIntoBins(const int numberOfCodeUnits, DependencyGraph& dependencies) const
 		{
+			Instrumentation::ScopedPhase phase("binning");
+
 			Out::All() << "Binning variants...\n";
 
+			// Each bit mask is encoded in a single integer.
+			if (static_cast<size_t>(numberOfCodeUnits) >= MaxEncodedBitMaskSize)
+			{
+				Out::All() << "The expected number of variants is greater than supported data types. "
+					<< "It is not wise to run the algorithm on such a large input. Exiting...\n";
+				return;
+			}
+
 			const auto totalNumberOfVariants = static_cast<size_t>(1) << numberOfCodeUnits;
 
-			if (totalNumberOfVariants == 0)
+			auto& pool = GetSharedThreadPool();
+
+			// Split the range into many more chunks than there are workers. The density of valid bit masks varies
+			// greatly, idle workers steal the remaining chunks of the busy ones.
+			const auto numberOfVariants = totalNumberOfVariants - 1;
+			const auto chunkCount = std::max<size_t>(std::min<size_t>(pool.Size() * ChunksPerWorker,
+			                                                          numberOfVariants / MinimalChunkSize), 1);
+
+			const auto memoryLimit = GetMaxCodesInMemory(chunkCount);
+
+			if (!memoryLimit.has_value())
 			{
-				std::cerr << "The expected number of variants is greater than supported data types."
-					<< "It is not wise to run the algorithm on such a large input. Exiting...\n";
 				return;
 			}
 
+			const auto maxCodesInMemory = *memoryLimit;
+
+			if (maxCodesInMemory > 0)
+			{
+				// Remove the segments left by an interrupted run.
+				std::error_code error;
+				std::filesystem::remove_all(SpillFolder, error);
+
+				Out::All() << "Bins larger than " << maxCodesInMemory << " bit masks will be spilled to '" <<
+					SpillFolder << "'.\n";
+			}
+
 			// Create ranges for each epoch.
 			for (auto i = 0; i < globalContext_.deepeningContext.epochCount; i++)
 			{
 				globalContext_.deepeningContext.bitMasks.insert(
-					std::pair<double, std::vector<BitMask>>(
+					std::pair<double, BitMaskBin>(
 						(i + 1) * globalContext_.deepeningContext.epochStep,
-						std::vector<BitMask>()));
+						BitMaskBin(numberOfCodeUnits, maxCodesInMemory)));
 			}
 
 			const auto originalVariant = BitMask(numberOfCodeUnits, true);
 			globalContext_.deepeningContext.bitMasks.at(
 				               globalContext_.deepeningContext.epochCount * globalContext_.deepeningContext.epochStep).
-			               push_back(originalVariant);
+			               Add(originalVariant);
 
 			// Add the last range (of invalid bit masks).
 			globalContext_.deepeningContext.bitMasks.insert(
-				std::pair<double, std::vector<BitMask>>(1.0, std::vector<BitMask>()));
+				std::pair<double, BitMaskBin>(1.0, BitMaskBin(numberOfCodeUnits, maxCodesInMemory)));
 			globalContext_.deepeningContext.bitMasks.insert(
-				std::pair<double, std::vector<BitMask>>(INFINITY, std::vector<BitMask>()));
+				std::pair<double, BitMaskBin>(INFINITY, BitMaskBin(numberOfCodeUnits, maxCodesInMemory)));
 
-			// The thread count must be specified in code, since it must have the const qualifier.
-			const auto threadCount = 12;
-			size_t ranges[threadCount];
+			// Encode the graph up front, the workers then share it without copying or locking it.
+			dependencies.Prepare(numberOfCodeUnits);
+			const auto encodedDependencies = EncodedDependencies(dependencies, numberOfCodeUnits);
 
-			// Determine the number of variants for each thread.
-			for (auto& range : ranges)
-			{
-				range = (totalNumberOfVariants - 1) / threadCount;
-			}
-
-			for (size_t i = 0; i < (totalNumberOfVariants - 1) % threadCount; i++)
-			{
-				ranges[i]++;
-			}
+			Out::All() << "Validating " << numberOfVariants << " bit masks in " << chunkCount << " chunks using " <<
+				pool.Size() << " threads.\n";
 
 			auto futures = std::vector<std::future<EpochRanges>>();
 
-			// Launch all threads.
-			for (auto i = 0; i < threadCount; i++)
+			for (size_t i = 0; i < chunkCount; i++)
 			{
-				const auto numberOfVariants = ranges[i];
-				size_t startingPoint = 0;
-
-				// Determine the starting point of each thread by summing up the previous counts.
-				if (i > 0)
-				{
-					ranges[i] += ranges[i - 1];
-					startingPoint = ranges[i - 1];
-				}
-
-				futures.emplace_back(std::async(std::launch::async, &VariantGeneratingConsumer::GetValidBitMasksInRange,
-				                                this, startingPoint, numberOfVariants, numberOfCodeUnits, dependencies,
-				                                i));
+				// Determine the range of each chunk, the first chunks take the remainder.
+				const auto chunkSize = numberOfVariants / chunkCount + (i < numberOfVariants % chunkCount ? 1 : 0);
+				const auto startingPoint = i * (numberOfVariants / chunkCount) + std::min(i, numberOfVariants %
+					chunkCount);
+
+				futures.push_back(pool.Submit(
+					[this, startingPoint, chunkSize, numberOfCodeUnits, &encodedDependencies, maxCodesInMemory]()
+					{
+						return GetValidBitMasksInRange(startingPoint, chunkSize, numberOfCodeUnits,
+						                               encodedDependencies, maxCodesInMemory);
+					}));
 			}
 
-			auto results = std::vector<EpochRanges>();
+			// Each chunk has its own result, no locks are needed. The results are merged in the order of the chunks
+			// (keeping the order of the bit masks deterministic) as soon as they are ready. The bit masks are moved
+			// and each result is released right after its merge, so the bins are never held twice.
+			// A failure is reported once all chunks have finished, they share the encoded dependencies.
+			auto failure = std::string();
 
-			// Collect the results and wait for all workers.
 			for (auto& future : futures)
 			{
-				results.push_back(future.get());
+				try
+				{
+					auto result = future.get();
+
+					if (failure.empty())
+					{
+						MergeVectorMaps(result, globalContext_.deepeningContext.bitMasks);
+					}
+				}
+				catch (const SpillError& error)
+				{
+					if (failure.empty())
+					{
+						failure = error.what();
+					}
+				}
+				catch (const std::exception& error)
+				{
+					if (failure.empty())
+					{
+						failure = std::string("The binning has failed: ") + error.what();
+					}
+				}
 			}
 
-			// Distribute bit masks into ranges.
-			for (auto& result : results)
+			if (!failure.empty())
 			{
-				MergeVectorMaps(result, globalContext_.deepeningContext.bitMasks);
+				Out::All() << failure << "\n";
+				globalContext_.deepeningContext.bitMasks.clear();
+				return;
 			}
 
 			Out::All() << "Binning done.\n";
@@ -278,8 +554,24 @@ namespace Naive
 				return;
 			}
 
+			// The mutant schema is compiled once, the variants of all epochs are then only run.
+			auto schemaExecutable = std::string();
+			auto guardedNodes = BitMask();
+
+			if (MutantSchema)
+			{
+				schemaExecutable = CompileSchema(context, numberOfCodeUnits, guardedNodes);
+			}
+
+			auto& checkpoint = globalContext_.checkpoint;
+
+			if (checkpoint.resumed)
+			{
+				Out::All() << "Skipping " << checkpoint.epoch << " epochs finished before the checkpoint.\n";
+			}
+
 			// Process in epochs, generating only a portion of all variants.
-			for (auto i = 0; i < globalContext_.deepeningContext.epochCount; i++)
+			for (auto i = checkpoint.resumed ? checkpoint.epoch : 0; i < globalContext_.deepeningContext.epochCount; i++)
 			{
 				auto& bitMasks = globalContext_.deepeningContext.bitMasks.lower_bound(
 					(i + 1) * globalContext_.deepeningContext.epochStep - globalContext_
@@ -287,9 +579,43 @@ namespace Naive
 					                                                      .epochStep /
 					2)->second;
 
-				GenerateVariantsForABin(context, bitMasks);
+				// The variants of the resumed epoch are generated again, the validated ones are skipped.
+				if (checkpoint.resumed)
+				{
+					globalContext_.stats.totalIterations = checkpoint.iteration;
+					checkpoint.resumed = false;
+				}
+				else
+				{
+					checkpoint.epoch = i;
+					checkpoint.binCursor = 0;
+					checkpoint.iteration = static_cast<int>(globalContext_.stats.totalIterations);
+				}
+
+				auto found = false;
 
-				if (ValidateResults(globalContext_))
+				try
+				{
+					if (schemaExecutable.empty())
+					{
+						GenerateVariantsForABin(context, bitMasks);
+						found = ValidateResults(globalContext_, LearnDependencies ? &dependencies : nullptr);
+					}
+					else
+					{
+						found = ValidateBinUsingSchema(context, bitMasks, schemaExecutable, guardedNodes,
+						                               dependencies);
+					}
+				}
+				catch (const SpillError& error)
+				{
+					Out::All() << error.what() << "\n";
+
+					globalContext_.stats.exitCode = EXIT_FAILURE;
+					return;
+				}
+
+				if (found)
 				{
 					globalContext_.stats.exitCode = EXIT_SUCCESS;
 					return;
@@ -297,7 +623,12 @@ namespace Naive
 
 				Out::All() << "Epoch " << i + 1 << " out of " << globalContext_.deepeningContext.epochCount <<
 					": A smaller program variant could not be found.\n";
-				ClearTempDirectory();
+
+				// The schema is kept for the following epochs, the validated variants are overwritten.
+				if (schemaExecutable.empty())
+				{
+					ClearTempDirectory();
+				}
 			}
 
 			Out::All() <<
@@ -0,0 +1,18 @@
+#ifndef NAIVE_REDUCTION_H
+#define NAIVE_REDUCTION_H
+#pragma once
+
+namespace Naive
+{
+	/**
+	 * Generates a minimal program variant by naively removing statements.\n
+	 * Used as the entry point of both the `NaiveReduction` binary and the `naive` stage of the `autopie` driver.
+	 *
+	 * @param argc The number of command-line arguments.
+	 * @param argv The command-line arguments, including the program name.
+	 * @return The exit code of the run.
+	 */
+	int RunNaiveReduction(int argc, const char** argv);
+}
+
+#endif
@@ -0,0 +1,13 @@
+#include "../../Common/include/Streams.h"
+#include "../include/NaiveReduction.h"
+
+/**
+ * Runs the naive reduction as a standalone program.
+ */
+int main(int argc, const char** argv)
+{
+	const auto result = Naive::RunNaiveReduction(argc, argv);
+	Out::Flush();
+
+	return result;
+}
@@ -12,33 +12,45 @@
 #include "../../Common/include/Options.h"
 #include "../../Common/include/Streams.h"
 #include "../include/Actions.h"
+#include "../include/NaiveReduction.h"
 
 using namespace llvm;
 using namespace Common;
 
 /**
- * Generates a minimal program variant by naively removing statements.
+ * Generates a minimal program variant by naively removing statements.\n
+ * Serves as the body of the `NaiveReduction` binary and of the `naive` stage of the `autopie` driver.
  * 
  * Call:\n
  * > NaiveReduction.exe [line with error] [error description message] [reduction ratio] [runtime arguments] <source path> --
  * e.g. NaiveReduction.exe --loc-line=17 --error-message="segmentation fault" --arguments="arg1 arg2" --ratio=0.5 example.cpp --
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments, including the program name.
+ * @return The exit code of the reduction.
  */
-int main(int argc, const char** argv)
+int Naive::RunNaiveReduction(int argc, const char** argv)
 {
 	// Parse the command-line args passed to the tool.
-	clang::tooling::CommonOptionsParser op(argc, argv, AutoPieArgs);
+	auto op = ParseCommandLine(argc, argv);
 
-	if (op.getSourcePathList().size() > 1)
+	if (!op)
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (op->getSourcePathList().size() > 1)
 	{
 		errs() << "Only a single source file is supported.\n";
 		return EXIT_FAILURE;
 	}
 
 	auto parsedInput = InputData(static_cast<std::basic_string<char>>(ErrorMessage),
-	                             Location(op.getSourcePathList()[0], LineNumber), ReductionRatio,
+	                             Location(op->getSourcePathList()[0], LineNumber), ReductionRatio,
 	                             DumpDot);
 
 	// Prompt the user to clear the temp directory.
+	// A resumed reduction clears it as well, the variants of the resumed epoch are generated again.
 	if (!ClearTempDirectory())
 	{
 		errs() << "Terminating...\n";
@@ -48,36 +60,30 @@ int main(int argc, const char** argv)
 	// The epoch count must be specified in the code, since it must have the const qualifier.
 	const auto epochCount = 5;
 
-	auto context = GlobalContext(parsedInput, *op.getSourcePathList().begin(), epochCount);
-	clang::tooling::ClangTool tool(op.getCompilations(), context.parsedInput.errorLocation.filePath);
+	Statistics::StartRun();
+
+	auto context = GlobalContext(parsedInput, *op->getSourcePathList().begin(), epochCount);
+
+	if (Resume && !LoadCheckpoint(context, "naive"))
+	{
+		errs() << "Terminating...\n";
+		return EXIT_FAILURE;
+	}
+	clang::tooling::ClangTool tool(op->getCompilations(), context.parsedInput.errorLocation.filePath);
 
 	// Include paths are not always recognized, especially for standard/system includes.
 	// This Adjuster helps with that.
 	auto includes = clang::tooling::getInsertArgumentAdjuster("-I/usr/local/lib/clang/11.0.0/include/");
 	tool.appendArgumentsAdjuster(includes);
 
-	auto inputLanguage = clang::Language::Unknown;
-	// Run a language check inside a separate scope so that all built ASTs get freed at the end.
-	{
-		Out::Verb() << "Checking the language...\n";
-
-		std::vector<std::unique_ptr<clang::ASTUnit>> trees;
-		tool.buildASTs(trees);
-
-		if (trees.size() != 1)
-		{
-			errs() << "Although only one AST was expected, " << trees.size() << " ASTs have been built.\n";
-			return EXIT_FAILURE;
-		}
-
-		inputLanguage = (*trees.begin())->getInputKind().getLanguage();
+	const auto inputLanguage = DetermineInputLanguage(tool, op->getCompilations(),
+	                                                  context.parsedInput.errorLocation.filePath);
 
-		Out::Verb() << "File: " << (*trees.begin())->getOriginalSourceFileName() << ", language: " <<
-			LanguageToString(inputLanguage) << "\n";
+	if (inputLanguage == clang::Language::Unknown)
+	{
+		return EXIT_FAILURE;
 	}
 
-	assert(inputLanguage != clang::Language::Unknown);
-
 	context.language = inputLanguage;
 
 	// Check whether the given line is in the file and pretty print it to the standard output.
@@ -90,12 +96,15 @@ int main(int argc, const char** argv)
 	LLDBSentry sentry;
 
 	// Run all Clang AST related actions.
-	auto result = tool.run(Naive::VariantGeneratingFrontendActionFactory(context).get());
+	auto result = RunOnSharedAST(tool, op->getCompilations(), context.parsedInput.errorLocation.filePath,
+	                             Naive::VariantGeneratingFrontendActionFactory(context).get());
 
 	if (result != 0)
 	{
 		errs() << "The tool returned a non-standard value: " << result << "\n";
 	}
 
+	RemoveCheckpoint();
+
 	return context.stats.exitCode;
 }
@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 
 import os
+import json
 import subprocess
 import sys
 import pathlib
@@ -34,6 +35,12 @@ parser.add_argument("-l", "--log", type=lambda x: (str(x).lower() in ['true', '1
 parser.add_argument("--static_slice", type=lambda x: (str(x).lower() in ['true', '1', 'yes']), default=True,
                     help="Runs a pass of the static slicer during "
                          "preprocessing. Enabled by default.")
+parser.add_argument("--native_slicer", type=lambda x: (str(x).lower() in ['true', '1', 'yes']), default=True,
+                    help="Computes the static and the dynamic slice in the "
+                         "`static-slice` and `dynamic-slice` stages of the "
+                         "driver instead of running the DG and Giri slicers "
+                         "in Docker. Enabled by default, ignored if the "
+                         "driver is not built.")
 parser.add_argument("--dynamic_slice", type=lambda x: (str(x).lower() in ['true', '1', 'yes']), default=True,
                     help="Runs a pass of the dynamic slicer during "
                          "preprocessing. Enabled by default.")
@@ -44,6 +51,11 @@ parser.add_argument("--inject", type=lambda x: (str(x).lower() in ['true', '1',
                     help="Instead of calling the debugged program with its "
                          "arguments, the tool specifies the arguments directly "
                          "in source code.")
+parser.add_argument("--driver", type=lambda x: (str(x).lower() in ['true', '1', 'yes']), default=True,
+                    help="Runs all components inside a single long-lived "
+                         "`autopie` driver process instead of launching "
+                         "each binary separately. Enabled by default, "
+                         "ignored if the driver is not built.")
 
 # Define relative paths to all components.
 
@@ -51,6 +63,17 @@ delta_path = "../DeltaReduction/build/bin/DeltaReduction"
 naive_path = "../NaiveReduction/build/bin/NaiveReduction"
 var_extractor_path = "../VariableExtractor/build/bin/VariableExtractor"
 slice_extractor_path = "../SliceExtractor/build/bin/SliceExtractor"
+driver_path = "../Driver/build/bin/autopie"
+
+# Stage names under which the components are known to the driver.
+
+driver_stages = {
+    delta_path: "delta",
+    naive_path: "naive",
+    var_extractor_path: "variables",
+    slice_extractor_path: "slice"
+}
+driver_done_marker = "@@autopie-done"
 
 # Define paths to output files
 
@@ -73,6 +96,46 @@ language = ""
 # A list of created resource for further cleanup.
 created_files = []
 
+# The running driver, if the components are run in-process.
+driver = None
+
+
+class DriverClient:
+    # Keeps a single `autopie --serve` process
+    # alive and forwards component invocations
+    # to it instead of spawning new processes.
+
+    def __init__(self, binary_path):
+        self.proc = subprocess.Popen([binary_path, "--serve"], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     universal_newlines=True, bufsize=1)
+
+    def run(self, stage, arguments):
+        # Sends a single request and echoes
+        # the output of the stage until
+        # the driver reports its exit code.
+        # Returns None if the driver has died.
+
+        try:
+            self.proc.stdin.write(json.dumps([stage] + arguments) + "\n")
+            self.proc.stdin.flush()
+        except OSError:
+            self.proc.wait()
+            return None
+
+        for line in self.proc.stdout:
+            if line.startswith(driver_done_marker):
+                return int(line.split()[1])
+
+            print(line, end="")
+
+        self.proc.wait()
+        return None
+
+    def close(self):
+        if self.proc.poll() is None:
+            self.proc.stdin.close()
+            self.proc.wait()
+
 
 def validate_paths(args):
     # Checks whether all required paths are present.
@@ -92,6 +155,9 @@ def validate_paths(args):
             print("The input file is written neither in C or C++!")
             valid = False
 
+    if args.driver and os.path.exists(driver_path):
+        return valid
+
     if not os.path.exists(delta_path):
         print("The DeltaReduction binary is missing!")
         valid = False
@@ -219,6 +285,61 @@ def run_static_slicer(args, var, iteration):
     return output_file
 
 
+def run_driver_stage(stage, arguments):
+    # Runs a stage inside the driver.
+    # Returns the exit code of the stage,
+    # or None if the driver has died. The
+    # driver is not used afterwards, the
+    # components are run as subprocesses.
+
+    global driver
+
+    print(f"Executing the '{stage}' stage of the driver...")
+
+    exit_code = driver.run(stage, arguments)
+
+    if exit_code is None:
+        print("The driver has stopped unexpectedly, the components are run as separate processes from now on.")
+        driver.close()
+        driver = None
+        return None
+
+    print("Execution done.")
+
+    return exit_code
+
+
+def run_native_static_slicer(args):
+    # Executes the static slicer of the driver.
+    # All variables on the error line are
+    # sliced at once, no argument injection
+    # is needed.
+    # The result is saved in file with
+    # the following name:
+    # static_slice_native.txt
+    # Returns None if the driver has died.
+
+    output_file = "static_slice_native.txt"
+
+    check_and_remove(output_file)
+
+    static_slicer_args = [f"--loc-line={args.line_number}",
+                          f"--verbose={args.verbose}",
+                          f"--log={args.log}",
+                          f"-o={output_file}",
+                          args.source_file,
+                          "--"
+                          ]
+
+    if run_driver_stage("static-slice", static_slicer_args) is None:
+        return None
+
+    global created_files
+    created_files.append(output_file)
+
+    return output_file
+
+
 def inject_arguments(arguments, file_path, location):
     # Inserts two lines with argv and argc
     # into the content of a specified file.
@@ -279,6 +400,37 @@ def run_dynamic_slicer(args, variables, iteration):
     return output_file
 
 
+def run_native_dynamic_slicer(args):
+    # Executes the dynamic slicer of the driver.
+    # The program is traced up to its error,
+    # the criterion needs no modification.
+    # The result is saved in file with
+    # the following name:
+    # dynamic_slice_native.txt
+    # Returns None if the driver has died.
+
+    output_file = "dynamic_slice_native.txt"
+
+    check_and_remove(output_file)
+
+    dynamic_slicer_args = [f"--loc-line={args.line_number}",
+                           f"--arguments={args.arguments}",
+                           f"--verbose={args.verbose}",
+                           f"--log={args.log}",
+                           f"-o={output_file}",
+                           args.source_file,
+                           "--"
+                           ]
+
+    if run_driver_stage("dynamic-slice", dynamic_slicer_args) is None:
+        return None
+
+    global created_files
+    created_files.append(output_file)
+
+    return output_file
+
+
 def adjust_slice(output_file, start):
     # Adjust all line numbers after
     # a given line number by two.
@@ -308,6 +460,12 @@ def run_tool(binary_path, arguments):
     # and a list of its arguments.
     # Returns the exit code of tool.
 
+    if driver is not None:
+        exit_code = run_driver_stage(driver_stages[binary_path], arguments)
+
+        if exit_code is not None:
+            return exit_code
+
     if not os.path.exists(binary_path):
         print(f"The tool '{binary_path}' could not be found!")
         print("Make sure to build all components using a Makefile before running the script.")
@@ -597,6 +755,10 @@ def main(args):
 
     validate_paths(args)
 
+    if args.driver and os.path.exists(driver_path):
+        global driver
+        driver = DriverClient(driver_path)
+
     print(f"Extracting variables...")
     variables = get_variables_on_line(args, var_extractor_output)
 
@@ -607,11 +769,20 @@ def main(args):
         static_slices = []
         i = 0
 
-        for var in variables:
-            print(f"Running static slicing with the criterion '{var}'...")
+        if args.native_slicer and driver is not None:
+            print(f"Running native static slicing with the criterion '{args.line_number}'...")
+
+            native_slice = run_native_static_slicer(args)
 
-            static_slices.append(run_static_slicer(args, var, i))
-            i += 1
+            if native_slice is not None:
+                static_slices.append(native_slice)
+
+        if not static_slices:
+            for var in variables:
+                print(f"Running static slicing with the criterion '{var}'...")
+
+                static_slices.append(run_static_slicer(args, var, i))
+                i += 1
 
         update_source_from_slices(args, static_slices)
 
@@ -623,7 +794,13 @@ def main(args):
 
         print(f"Running dynamic slicing with the criterion '{args.line_number}'...")
 
-        dynamic_slice = run_dynamic_slicer(args, variables, i)
+        dynamic_slice = None
+
+        if args.native_slicer and driver is not None:
+            dynamic_slice = run_native_dynamic_slicer(args)
+
+        if dynamic_slice is None:
+            dynamic_slice = run_dynamic_slicer(args, variables, i)
 
         update_source_from_slices(args, [dynamic_slice])
 
@@ -664,6 +841,8 @@ if __name__ == "__main__":
     try:
         main(args)
     finally:
+        if driver is not None:
+            driver.close()
         for file in created_files:
             check_and_remove(file)
         if os.path.exists("dg-data"):
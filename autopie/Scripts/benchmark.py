@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+
+import os
+import json
+import random
+import subprocess
+import sys
+import pathlib
+import platform
+import shutil
+import tempfile
+import time
+import argparse
+
+parser = argparse.ArgumentParser(description="Runs the reducers over the evaluation corpus, records their "
+                                             "performance and compares it with a stored baseline.")
+parser.add_argument("--data_dir", type=str, default="../EvaluationData", help="The directory containing the "
+                                                                               "benchmark inputs and their "
+                                                                               "`args.txt` criteria.")
+parser.add_argument("--tools", type=str, default="delta,naive", help="A comma-separated list of the tools to "
+                                                                     "be benchmarked (naive, delta).")
+parser.add_argument("--strategies", type=str, default="ddmin,hdd,probdd", help="A comma-separated list of "
+                                                                               "DeltaReduction strategies to be "
+                                                                               "benchmarked.")
+parser.add_argument("--profiles", type=str, default="default", help="A comma-separated list of compile profiles "
+                                                                   "(default, fast) with which each tool is "
+                                                                   "benchmarked.")
+parser.add_argument("--cases", type=str, default="", help="A comma-separated list of file name prefixes, only "
+                                                          "the matching inputs are benchmarked (e.g. 'oop,"
+                                                          "structured1'). All inputs are used by default.")
+parser.add_argument("--repetitions", type=int, default=1, help="The number of runs of each benchmark, the "
+                                                               "median of the runs is recorded.")
+parser.add_argument("--seed", type=int, default=0, help="The seed with which the order of the runs is "
+                                                        "shuffled. It only fixes the order, the tools are not "
+                                                        "seeded and the measurements still vary.")
+parser.add_argument("--timeout", type=float, default=3600, help="The time limit of a single run in seconds.")
+parser.add_argument("-o", "--output", type=str, default="benchmark.json", help="The path to which the results "
+                                                                              "should be saved.")
+parser.add_argument("--baseline", type=str, default="", help="The path to the results of a previous run. If set, "
+                                                              "the new results are compared with it.")
+parser.add_argument("--threshold", type=float, default=0.1, help="The relative increase of a metric that is "
+                                                                 "considered a regression, e.g., 0.1 for 10 %%.")
+
+# Define relative paths to all components.
+
+binary_paths = {
+    "delta": "../DeltaReduction/build/bin/DeltaReduction",
+    "naive": "../NaiveReduction/build/bin/NaiveReduction"
+}
+
+# Metrics compared with the baseline, a greater value is always worse.
+
+compared_metrics = ["wall_seconds", "validations", "compile_seconds", "compile_seconds_per_validation", "peak_rss_kb",
+                    "output_bytes"]
+
+stats_file = "stats.json"
+
+
+def load_cases(args):
+    # Reads the criteria of all benchmark inputs.
+    # Each line of `args.txt` contains the file name,
+    # the error line, the error message, the runtime
+    # arguments and the reduction ratio, separated
+    # by semicolons.
+    # Returns a list of cases.
+
+    prefixes = [prefix for prefix in args.cases.split(",") if prefix]
+    cases = []
+
+    with open(os.path.join(args.data_dir, "args.txt"), "r") as ifs:
+        for line in ifs:
+            line = line.strip()
+
+            if not line:
+                continue
+
+            fields = line.split(";")
+
+            if prefixes and not any(fields[0].startswith(prefix) for prefix in prefixes):
+                continue
+
+            cases.append({
+                "file": fields[0],
+                "line": int(fields[1]),
+                "message": fields[2],
+                "arguments": fields[3],
+                "ratio": float(fields[4]) if len(fields) > 4 and fields[4] else 1.0
+            })
+
+    return cases
+
+
+def get_configurations(args):
+    # Combines the tools, strategies and compile
+    # profiles into a list of (tool, strategy,
+    # profile) triples.
+    # NaiveReduction has no strategies.
+
+    configurations = []
+    profiles = [profile for profile in args.profiles.split(",") if profile]
+
+    for tool in [tool for tool in args.tools.split(",") if tool]:
+        if tool not in binary_paths:
+            print(f"Unknown tool '{tool}', skipping.")
+            continue
+
+        strategies = [strategy for strategy in args.strategies.split(",") if strategy] if tool == "delta" else [""]
+
+        for strategy in strategies:
+            for profile in profiles:
+                configurations.append((tool, strategy, profile))
+
+    return configurations
+
+
+def get_tool_arguments(tool, strategy, profile, case, source_file):
+    # Creates the command line of a single run.
+
+    tool_args = [f"--loc-line={case['line']}",
+                 f"--error-message={case['message']}",
+                 f"--arguments={case['arguments']}",
+                 f"--stats-file={stats_file}"]
+
+    if tool == "naive":
+        tool_args.append(f"--ratio={case['ratio']}")
+
+    if strategy:
+        tool_args.append(f"--strategy={strategy}")
+
+    if profile:
+        tool_args.append(f"--compile-profile={profile}")
+
+    return tool_args + [source_file, "--"]
+
+
+def run_once(args, tool, strategy, profile, case):
+    # Runs a tool on a single input in a fresh
+    # working directory, so that runs do not
+    # share their temporary files.
+    # Returns the measured metrics.
+
+    binary_path = os.path.abspath(binary_paths[tool])
+    working_directory = tempfile.mkdtemp(prefix="autopie-benchmark-")
+
+    try:
+        source_file = os.path.join(working_directory, case["file"])
+        shutil.copyfile(os.path.join(args.data_dir, case["file"]), source_file)
+
+        start = time.perf_counter()
+        proc = subprocess.Popen([binary_path] + get_tool_arguments(tool, strategy, profile, case, source_file),
+                                cwd=working_directory, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL,
+                                stderr=subprocess.DEVNULL)
+
+        # Wait for the child directly, so that its own resource usage (peak RSS) can be collected.
+        timed_out = False
+        deadline = start + args.timeout
+
+        while True:
+            pid, status, usage = os.wait4(proc.pid, os.WNOHANG)
+
+            if pid != 0:
+                break
+
+            if time.perf_counter() > deadline:
+                proc.kill()
+                _, status, usage = os.wait4(proc.pid, 0)
+                timed_out = True
+                break
+
+            time.sleep(0.05)
+
+        # Prevent Popen from waiting for the already collected child.
+        proc.returncode = os.waitstatus_to_exitcode(status)
+        wall_seconds = time.perf_counter() - start
+
+        metrics = {
+            "exit_code": proc.returncode,
+            "timed_out": timed_out,
+            "wall_seconds": wall_seconds,
+            "peak_rss_kb": usage.ru_maxrss,
+            "validations": 0,
+            "compile_seconds": 0.0,
+            "compile_seconds_per_validation": 0.0,
+            "output_bytes": 0
+        }
+
+        report_path = os.path.join(working_directory, stats_file)
+
+        if os.path.exists(report_path):
+            with open(report_path, "r") as ifs:
+                report = json.load(ifs)
+
+            metrics["validations"] = report["counters"].get("variants/validated", 0)
+            metrics["compile_seconds"] = sum(phase["seconds"] for path, phase in report["phases"].items()
+                                             if path.endswith("compile"))
+            metrics["output_bytes"] = report["outputSizeInBytes"]
+
+            if metrics["validations"] > 0:
+                metrics["compile_seconds_per_validation"] = metrics["compile_seconds"] / metrics["validations"]
+
+        return metrics
+    finally:
+        shutil.rmtree(working_directory, ignore_errors=True)
+
+
+def median(values):
+    values = sorted(values)
+    middle = len(values) // 2
+
+    return values[middle] if len(values) % 2 == 1 else (values[middle - 1] + values[middle]) / 2
+
+
+def run_benchmarks(args):
+    # Runs all configurations on all cases.
+    # The order of the runs is shuffled using
+    # the given seed to spread systematic noise
+    # (e.g., thermal throttling) over all benchmarks.
+    # Returns the results keyed by the benchmark name.
+
+    cases = load_cases(args)
+    configurations = get_configurations(args)
+
+    runs = [(tool, strategy, profile, case) for tool, strategy, profile in configurations for case in cases
+            for _ in range(args.repetitions)]
+    random.Random(args.seed).shuffle(runs)
+
+    measurements = {}
+
+    for i, (tool, strategy, profile, case) in enumerate(runs):
+        # The default profile is left out of the name, so that older baselines can still be compared.
+        name = "/".join(filter(None, [tool, strategy, "" if profile == "default" else profile, case["file"]]))
+
+        print(f"[{i + 1}/{len(runs)}] {name}...")
+
+        metrics = run_once(args, tool, strategy, profile, case)
+        measurements.setdefault(name, []).append(metrics)
+
+        print(f"Done in {metrics['wall_seconds']:.2f} s, {metrics['validations']} validations, "
+              f"{metrics['output_bytes']} bytes.")
+
+    results = {}
+
+    for name, runs_of_benchmark in measurements.items():
+        results[name] = {metric: median([run[metric] for run in runs_of_benchmark]) for metric in compared_metrics}
+        results[name]["exit_code"] = runs_of_benchmark[0]["exit_code"]
+        results[name]["timed_out"] = any(run["timed_out"] for run in runs_of_benchmark)
+
+    return results
+
+
+def compare_with_baseline(results, baseline, threshold):
+    # Compares each metric of each benchmark
+    # with the baseline.
+    # Returns the number of regressions.
+
+    regressions = 0
+
+    for name, metrics in sorted(results.items()):
+        if name not in baseline:
+            print(f"{name}: not in the baseline.")
+            continue
+
+        for metric in compared_metrics:
+            old = baseline[name].get(metric, 0)
+            new = metrics[metric]
+
+            if old == 0:
+                continue
+
+            change = (new - old) / old
+
+            if change > threshold:
+                print(f"REGRESSION {name} {metric}: {old} -> {new} ({change:+.1%})")
+                regressions += 1
+            elif change < -threshold:
+                print(f"Improvement {name} {metric}: {old} -> {new} ({change:+.1%})")
+
+    return regressions
+
+
+def main(args):
+    for tool in args.tools.split(","):
+        if tool in binary_paths and not os.path.exists(binary_paths[tool]):
+            print(f"The tool '{binary_paths[tool]}' could not be found!")
+            print("Make sure to build all components using a Makefile before running the script.")
+            return 1
+
+    results = run_benchmarks(args)
+
+    output = {
+        "meta": {
+            "seed": args.seed,
+            "repetitions": args.repetitions,
+            "timeout": args.timeout,
+            "machine": platform.machine(),
+            "system": platform.platform(),
+            "processors": os.cpu_count(),
+            "time": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime())
+        },
+        "results": results
+    }
+
+    pathlib.Path(args.output).write_text(json.dumps(output, indent=2, sort_keys=True) + "\n")
+
+    print(f"The results have been saved to '{args.output}'.")
+
+    if not args.baseline:
+        return 0
+
+    baseline = json.loads(pathlib.Path(args.baseline).read_text())["results"]
+    regressions = compare_with_baseline(results, baseline, args.threshold)
+
+    print(f"{regressions} regressions found (threshold {args.threshold:.0%}).")
+
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    args = parser.parse_args()
+    sys.exit(main(args))
@@ -13,6 +13,8 @@ using namespace Common;
 namespace SliceExtractor
 {
 	std::unique_ptr<clang::tooling::FrontendActionFactory> SliceExtractorFrontendActionFactory(std::vector<int>& lines);
+	std::unique_ptr<clang::tooling::FrontendActionFactory> SlicerFrontendActionFactory(
+		std::vector<size_t>& lines, const Execution::JitTrace* trace = nullptr);
 
 	/**
 	 * Specifies the frontend action for collecting relevant line numbers in a file.\n
@@ -34,6 +36,28 @@ namespace SliceExtractor
 			return std::unique_ptr<clang::ASTConsumer>(std::make_unique<SliceExtractorASTConsumer>(&ci, lines_));
 		}
 	};
+
+	/**
+	 * Specifies the frontend action for computing the static or the dynamic slice of the error location.\n
+	 * Currently creates the slicing consumer.
+	 */
+	class SlicerAction final : public clang::ASTFrontendAction
+	{
+		std::vector<size_t>& lines_;
+		const Execution::JitTrace* trace_;
+
+	public:
+
+		SlicerAction(std::vector<size_t>& lines, const Execution::JitTrace* trace) : lines_(lines), trace_(trace)
+		{
+		}
+
+		std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& ci, llvm::StringRef /*file*/)
+			override
+		{
+			return std::unique_ptr<clang::ASTConsumer>(std::make_unique<SlicerASTConsumer>(&ci, lines_, trace_));
+		}
+	};
 }
 
 #endif
\ No newline at end of file
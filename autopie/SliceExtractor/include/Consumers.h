@@ -6,6 +6,8 @@
 
 #include <algorithm>
 
+#include "../../Common/include/JitExecutor.h"
+#include "../../Common/include/Streams.h"
 #include "Visitors.h"
 
 namespace SliceExtractor
@@ -46,6 +48,54 @@ namespace SliceExtractor
 			originalLines.erase(it, originalLines.end());
 		}
 	};
+
+	/**
+	 * Dispatches the slicing graph visitor and computes the slice of the error location (`LineNumber`).\n
+	 * The slice contains the lines of all units the units on the error location depend on, see `SliceGraph`.
+	 * Given a trace of a run, the slice is dynamic - it contains only the units executed by the run.
+	 */
+	class SlicerASTConsumer final : public clang::ASTConsumer
+	{
+		std::unique_ptr<SliceGraphASTVisitor> graphVisitor_{};
+		std::vector<size_t>& lines_;
+		const Execution::JitTrace* trace_;
+
+	public:
+		SlicerASTConsumer(clang::CompilerInstance* ci, std::vector<size_t>& lines, const Execution::JitTrace* trace) :
+			lines_(lines), trace_(trace)
+		{
+			graphVisitor_ = std::make_unique<SliceGraphASTVisitor>(ci);
+		}
+
+		/**
+		 * Builds the slicing graph of the file and appends the lines of the slice to the referenced container.\n
+		 * No lines are appended if there is no code on the error location.
+		 */
+		void HandleTranslationUnit(clang::ASTContext& context) override
+		{
+			graphVisitor_->TraverseDecl(context.getTranslationUnitDecl());
+
+			auto& graph = graphVisitor_->graph;
+
+			if (trace_ != nullptr)
+			{
+				graph.RestrictToExecution(trace_->codeLines, trace_->executedLines);
+			}
+
+			const auto criterion = graph.GetUnitsOnLine(LineNumber);
+
+			Out::Verb() << "Slicing graph units: " << graph.GetUnitCount() << ", criterion units: " << criterion.size()
+				<< ".\n";
+
+			if (criterion.empty())
+			{
+				return;
+			}
+
+			const auto slice = graph.GetSlice(criterion);
+			lines_.insert(lines_.end(), slice.begin(), slice.end());
+		}
+	};
 } // namespace SliceExtractor
 
 #endif
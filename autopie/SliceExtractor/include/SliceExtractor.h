@@ -0,0 +1,40 @@
+#ifndef SLICE_EXTRACTOR_H
+#define SLICE_EXTRACTOR_H
+#pragma once
+
+namespace SliceExtractor
+{
+	/**
+	 * Extracts a slice from source code based on a given list of lines.\n
+	 * Used as the entry point of both the `SliceExtractor` binary and the `slice` stage of the `autopie` driver.
+	 *
+	 * @param argc The number of command-line arguments.
+	 * @param argv The command-line arguments, including the program name.
+	 * @return The exit code of the run.
+	 */
+	int RunSliceExtractor(int argc, const char** argv);
+
+	/**
+	 * Computes the static slice of the error location from the AST of the input, without any external slicer.\n
+	 * The line numbers of the slice are written to the output file, one per line, as expected by `--slice-file`.
+	 * Used as the entry point of the `static-slice` stage of the `autopie` driver.
+	 *
+	 * @param argc The number of command-line arguments.
+	 * @param argv The command-line arguments, including the program name.
+	 * @return The exit code of the run.
+	 */
+	int RunStaticSlicer(int argc, const char** argv);
+
+	/**
+	 * Computes the dynamic slice of the error location by tracing a run of the input in the JIT, without Giri.\n
+	 * The line numbers of the slice are written to the output file, one per line, as expected by `--slice-file`.
+	 * Used as the entry point of the `dynamic-slice` stage of the `autopie` driver.
+	 *
+	 * @param argc The number of command-line arguments.
+	 * @param argv The command-line arguments, including the program name.
+	 * @return The exit code of the run.
+	 */
+	int RunDynamicSlicer(int argc, const char** argv);
+}
+
+#endif
@@ -0,0 +1,384 @@
+#ifndef SLICEGRAPH_H
+#define SLICEGRAPH_H
+#pragma once
+
+#include <clang/AST/Decl.h>
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace SliceExtractor
+{
+	/**
+	 * Represents a single statement, a header of a compound statement (e.g., the condition of a loop),
+	 * a function signature, a global variable or a type declaration in the slicing graph.\n
+	 * Only the declarations the unit refers to are kept, the slicing is flow-insensitive.
+	 */
+	struct SliceUnit
+	{
+		int parent{-1}; ///< The enclosing control statement or the signature of the function, -1 for none.
+		const clang::FunctionDecl* function{nullptr}; ///< The function containing the unit, null for declarations.
+		bool isJump{false}; ///< Set for units that may leave their block, e.g., `return`, `break` or `exit`.
+		bool takesAddress{false}; ///< Set if a variable defined by the unit may be aliased (e.g., `p = &x`).
+		bool changesFields{false}; ///< Set if the unit may change the fields of the object of its method.
+		bool executed{true}; ///< Cleared for units not executed by the traced run, see `RestrictToExecution`.
+		const clang::LabelDecl* jumpTarget{nullptr}; ///< The label of a `goto`, null for other units.
+		std::vector<size_t> lines; ///< The lines of the code of the unit, sorted.
+		std::vector<const clang::ValueDecl*> uses; ///< The variables and fields read by the unit.
+		std::vector<const clang::ValueDecl*> definitions; ///< The variables and fields the unit may change.
+		std::vector<const clang::FunctionDecl*> calls; ///< The functions called or referenced by the unit.
+		std::vector<const clang::Decl*> types; ///< The type declarations the unit refers to.
+		/// The pointer and non-const reference parameters through which the callees may change the variables.
+		std::vector<const clang::ValueDecl*> outParameters;
+		/// The non-const methods and constructors called by the unit, which may change the fields of their object.
+		std::vector<const clang::FunctionDecl*> changingMethods;
+	};
+
+	/**
+	 * Keeps the data and control dependencies of the code units of a file and computes its static slices.\n
+	 * Declarations are identified by their canonical declarations.
+	 */
+	class SliceGraph
+	{
+		/**
+		 * Units in a slice are either reached from the criterion, in which case the callers of their function
+		 * are in the slice as well, or they are reached by descending into a called function only.
+		 */
+		enum class Reach
+		{
+			None,
+			Ascending,
+			Descending
+		};
+
+		std::vector<SliceUnit> units_;
+		std::unordered_map<const clang::ValueDecl*, std::vector<int>> definitions_;
+		std::unordered_map<const clang::FunctionDecl*, std::vector<int>> callSites_;
+		std::unordered_map<const clang::FunctionDecl*, std::vector<int>> jumps_;
+		std::unordered_map<const clang::FunctionDecl*, std::vector<int>> fieldChanges_;
+		std::unordered_map<const clang::FunctionDecl*, int> functionUnits_;
+		std::unordered_map<const clang::Decl*, int> typeUnits_;
+		std::unordered_map<const clang::LabelDecl*, int> labelUnits_;
+
+		/**
+		 * Checks whether a given declaration keeps its value between the calls of functions.
+		 *
+		 * @param decl The variable or the field.
+		 * @return True for global and static variables and for fields, false for local variables and parameters.
+		 */
+		static bool IsGlobal(const clang::ValueDecl* decl)
+		{
+			if (llvm::isa<clang::FieldDecl>(decl))
+			{
+				return true;
+			}
+
+			return llvm::isa<clang::VarDecl>(decl) && llvm::cast<clang::VarDecl>(decl)->hasGlobalStorage();
+		}
+
+		template <typename Key>
+		static const std::vector<int>& Find(const std::unordered_map<Key, std::vector<int>>& container,
+		                                    const Key& key)
+		{
+			static const auto empty = std::vector<int>();
+
+			const auto it = container.find(key);
+
+			return it != container.end() ? it->second : empty;
+		}
+
+	public:
+		/**
+		 * Adds a unit to the graph and indexes the declarations it defines, the functions it calls and the units
+		 * changing the fields of the object of a method.
+		 *
+		 * @param unit The unit to be added.
+		 * @return The number of the unit.
+		 */
+		int InsertUnit(SliceUnit unit)
+		{
+			const auto number = static_cast<int>(units_.size());
+
+			for (const auto* decl : unit.definitions)
+			{
+				definitions_[decl].push_back(number);
+			}
+
+			for (const auto* callee : unit.calls)
+			{
+				callSites_[callee].push_back(number);
+			}
+
+			if (unit.isJump && unit.function != nullptr)
+			{
+				jumps_[unit.function].push_back(number);
+			}
+
+			if (unit.changesFields && unit.function != nullptr)
+			{
+				fieldChanges_[unit.function].push_back(number);
+			}
+
+			std::sort(unit.lines.begin(), unit.lines.end());
+			unit.lines.erase(std::unique(unit.lines.begin(), unit.lines.end()), unit.lines.end());
+
+			units_.push_back(std::move(unit));
+
+			return number;
+		}
+
+		void SetFunctionUnit(const clang::FunctionDecl* function, const int unit)
+		{
+			functionUnits_[function] = unit;
+		}
+
+		void SetTypeUnit(const clang::Decl* type, const int unit)
+		{
+			typeUnits_[type] = unit;
+		}
+
+		void SetLabelUnit(const clang::LabelDecl* label, const int unit)
+		{
+			labelUnits_[label] = unit;
+		}
+
+		[[nodiscard]] size_t GetUnitCount() const
+		{
+			return units_.size();
+		}
+
+		[[nodiscard]] const SliceUnit& GetUnit(const int unit) const
+		{
+			return units_[unit];
+		}
+
+		/**
+		 * Searches for the units with code on a given line, i.e., the units of the slicing criterion.
+		 *
+		 * @param line The line number.
+		 * @return The numbers of the units on the line.
+		 */
+		[[nodiscard]] std::vector<int> GetUnitsOnLine(const size_t line) const
+		{
+			auto found = std::vector<int>();
+
+			for (auto i = 0; i < static_cast<int>(units_.size()); i++)
+			{
+				if (std::binary_search(units_[i].lines.begin(), units_[i].lines.end(), line))
+				{
+					found.push_back(i);
+				}
+			}
+
+			return found;
+		}
+
+		/**
+		 * Marks the units of functions that have not been executed by a traced run, these are never added to a slice.\n
+		 * A unit is executed if any of its lines has been executed. Units without code of their own (e.g.,
+		 * a compound statement) are executed if their enclosing statement is. An executed unit implies that its
+		 * enclosing statements have been executed as well.
+		 *
+		 * @param codeLines The sorted lines with any code.
+		 * @param executedLines The sorted lines executed by the run.
+		 */
+		void RestrictToExecution(const std::vector<size_t>& codeLines, const std::vector<size_t>& executedLines)
+		{
+			auto hasCode = std::vector<bool>(units_.size(), false);
+
+			for (auto& unit : units_)
+			{
+				if (unit.function == nullptr)
+				{
+					continue;
+				}
+
+				const auto number = &unit - units_.data();
+				auto executed = false;
+
+				for (auto line : unit.lines)
+				{
+					hasCode[number] = hasCode[number] || std::binary_search(codeLines.begin(), codeLines.end(), line);
+					executed = executed || std::binary_search(executedLines.begin(), executedLines.end(), line);
+				}
+
+				unit.executed = executed;
+			}
+
+			// Units are inserted after their parents, the parents can be updated in a single pass in reverse.
+			for (auto i = static_cast<int>(units_.size()) - 1; i >= 0; i--)
+			{
+				if (units_[i].function != nullptr && units_[i].executed && units_[i].parent >= 0)
+				{
+					units_[units_[i].parent].executed = true;
+				}
+			}
+
+			for (size_t i = 0; i < units_.size(); i++)
+			{
+				if (units_[i].function != nullptr && !hasCode[i] && !units_[i].executed)
+				{
+					units_[i].executed = units_[i].parent < 0 || units_[units_[i].parent].executed;
+				}
+			}
+		}
+
+		/**
+		 * Computes the backward slice of the given units.\n
+		 * A unit in the slice needs the units defining the variables it uses (all of the defined variables if
+		 * the unit may alias them), its enclosing control statement, the types it refers to and the functions it
+		 * calls. A called function needs its signature and all units which may leave it (e.g., `return` statements).
+		 * A call passing a variable by a pointer or a non-const reference needs the units of the callee defining
+		 * the parameter, a call of a non-const method needs the units of the method changing the fields of its object.
+		 * A function containing a unit reached from the criterion needs all of its call sites, which provide the
+		 * values of its parameters, the call sites of a function that has only been called are not needed
+		 * (the two phases of interprocedural slicing by Horwitz, Reps and Binkley).
+		 *
+		 * @param criterion The numbers of the units of the slicing criterion.
+		 * @return The sorted line numbers of the code of the slice.
+		 */
+		[[nodiscard]] std::vector<size_t> GetSlice(const std::vector<int>& criterion) const
+		{
+			auto reached = std::vector<Reach>(units_.size(), Reach::None);
+			auto unitQ = std::queue<int>();
+
+			const auto reach = [this, &reached, &unitQ](const int unit, const Reach how)
+			{
+				if (unit < 0 || !units_[unit].executed || reached[unit] == Reach::Ascending || reached[unit] == how)
+				{
+					return;
+				}
+
+				// Units reached by descending may be reached from the criterion later, they are processed again.
+				reached[unit] = how;
+				unitQ.push(unit);
+			};
+
+			const auto reachDefinitions = [&](const clang::ValueDecl* decl, const Reach how)
+			{
+				// Globals may be changed by any function, its callers are needed regardless of how it was reached.
+				const auto definitionReach = IsGlobal(decl) ? Reach::Ascending : how;
+
+				for (auto definition : Find(definitions_, decl))
+				{
+					reach(definition, definitionReach);
+				}
+			};
+
+			for (auto unit : criterion)
+			{
+				reach(unit, Reach::Ascending);
+			}
+
+			while (!unitQ.empty())
+			{
+				const auto currentUnit = unitQ.front();
+				const auto how = reached[currentUnit];
+				const auto& unit = units_[currentUnit];
+				unitQ.pop();
+
+				reach(unit.parent, how);
+
+				for (const auto* decl : unit.uses)
+				{
+					reachDefinitions(decl, how);
+				}
+
+				if (unit.takesAddress)
+				{
+					for (const auto* decl : unit.definitions)
+					{
+						reachDefinitions(decl, how);
+					}
+				}
+
+				for (const auto* type : unit.types)
+				{
+					const auto it = typeUnits_.find(type);
+
+					if (it != typeUnits_.end())
+					{
+						reach(it->second, Reach::Descending);
+					}
+				}
+
+				for (const auto* callee : unit.calls)
+				{
+					const auto it = functionUnits_.find(callee);
+
+					if (it != functionUnits_.end())
+					{
+						reach(it->second, Reach::Descending);
+					}
+
+					for (auto jump : Find(jumps_, callee))
+					{
+						reach(jump, Reach::Descending);
+					}
+				}
+
+				// The callees change the variables of the unit through their parameters and their object
+				// (the edges between the formal-out and the actual-out vertices of Horwitz, Reps and Binkley).
+				for (const auto* parameter : unit.outParameters)
+				{
+					for (auto definition : Find(definitions_, parameter))
+					{
+						reach(definition, Reach::Descending);
+					}
+				}
+
+				for (const auto* method : unit.changingMethods)
+				{
+					for (auto change : Find(fieldChanges_, method))
+					{
+						reach(change, Reach::Descending);
+					}
+				}
+
+				if (unit.jumpTarget != nullptr)
+				{
+					const auto it = labelUnits_.find(unit.jumpTarget);
+
+					if (it != labelUnits_.end())
+					{
+						reach(it->second, how);
+					}
+				}
+
+				if (unit.function != nullptr && how == Reach::Ascending)
+				{
+					// The function must be called and its parameters must get their values.
+					for (auto callSite : Find(callSites_, unit.function))
+					{
+						reach(callSite, Reach::Ascending);
+					}
+
+					// Any unit leaving the function might prevent the criterion from being reached.
+					for (auto jump : Find(jumps_, unit.function))
+					{
+						reach(jump, Reach::Ascending);
+					}
+				}
+			}
+
+			auto lines = std::vector<size_t>();
+
+			for (size_t i = 0; i < units_.size(); i++)
+			{
+				if (reached[i] != Reach::None)
+				{
+					lines.insert(lines.end(), units_[i].lines.begin(), units_[i].lines.end());
+				}
+			}
+
+			std::sort(lines.begin(), lines.end());
+			lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+
+			return lines;
+		}
+	};
+} // namespace SliceExtractor
+
+#endif
@@ -5,6 +5,11 @@
 #include <clang/AST/RecursiveASTVisitor.h>
 #include <clang/Frontend/CompilerInstance.h>
 
+#include <algorithm>
+#include <cctype>
+
+#include "SliceGraph.h"
+
 namespace SliceExtractor
 {
 	class SliceExtractorASTVisitor;
@@ -200,6 +205,737 @@ namespace SliceExtractor
 			return true;
 		}
 	};
+
+	/**
+	 * Collects the declarations a single code unit of the slicing graph refers to.\n
+	 * A variable is defined by the unit if the unit declares it, assigns to it, increments or decrements it,
+	 * takes its address, lets an array decay into a pointer to it, or passes it by a non-const reference.
+	 * The definitions through pointers are attributed to the pointer. The parameters and the methods through which
+	 * the callees may change the variables of the unit are kept as well.
+	 */
+	class SliceUnitASTVisitor final : public clang::RecursiveASTVisitor<SliceUnitASTVisitor>
+	{
+		SliceUnit& unit_;
+
+		/**
+		 * Searches for the variable whose memory is accessed by a given expression, e.g., `a` in `a[i].b = 0`.\n
+		 * The fields accessed through `this` are considered to be variables.
+		 *
+		 * @param expr The accessing expression.
+		 * @return The variable or the field, null if there is none (e.g., the result of a call is accessed).
+		 */
+		static clang::ValueDecl* GetBaseDeclaration(clang::Expr* expr)
+		{
+			while (expr != nullptr)
+			{
+				expr = expr->IgnoreParenImpCasts();
+
+				if (llvm::isa<clang::DeclRefExpr>(expr))
+				{
+					return llvm::cast<clang::DeclRefExpr>(expr)->getDecl();
+				}
+
+				if (llvm::isa<clang::MemberExpr>(expr))
+				{
+					const auto member = llvm::cast<clang::MemberExpr>(expr);
+
+					if (member->isImplicitAccess() || llvm::isa<clang::CXXThisExpr>(
+						member->getBase()->IgnoreParenImpCasts()))
+					{
+						return member->getMemberDecl();
+					}
+
+					expr = member->getBase();
+				}
+				else if (llvm::isa<clang::ArraySubscriptExpr>(expr))
+				{
+					expr = llvm::cast<clang::ArraySubscriptExpr>(expr)->getBase();
+				}
+				else if (llvm::isa<clang::UnaryOperator>(expr) && llvm::cast<clang::UnaryOperator>(expr)->getOpcode() ==
+					clang::UO_Deref)
+				{
+					expr = llvm::cast<clang::UnaryOperator>(expr)->getSubExpr();
+				}
+				else if (llvm::isa<clang::CXXOperatorCallExpr>(expr) && llvm::cast<clang::CXXOperatorCallExpr>(expr)->
+					getNumArgs() > 0)
+				{
+					// Overloaded subscripts, dereferences and member accesses, e.g., `v[i] = 0` or `*it = 0`.
+					expr = llvm::cast<clang::CXXOperatorCallExpr>(expr)->getArg(0);
+				}
+				else
+				{
+					return nullptr;
+				}
+			}
+
+			return nullptr;
+		}
+
+		/**
+		 * Normalizes a called function, calls of template instances are calls of the template, whose code is in the file.
+		 *
+		 * @param function The called function.
+		 * @return The canonical declaration of the template pattern or of the function itself.
+		 */
+		static const clang::FunctionDecl* GetCalledFunction(const clang::FunctionDecl* function)
+		{
+			if (const auto pattern = function->getTemplateInstantiationPattern())
+			{
+				function = pattern;
+			}
+
+			return function->getCanonicalDecl();
+		}
+
+		/**
+		 * Keeps the parameter of a callee through which the callee may change the variables of the unit.
+		 *
+		 * @param callee The called function.
+		 * @param index The index of the parameter.
+		 */
+		void AddOutParameter(const clang::FunctionDecl* callee, const unsigned index) const
+		{
+			// The body refers to the parameters of the definition.
+			const auto definition = GetCalledFunction(callee)->getDefinition();
+
+			if (definition != nullptr && index < definition->getNumParams())
+			{
+				unit_.outParameters.push_back(definition->getParamDecl(index));
+			}
+		}
+
+		/**
+		 * Marks the arguments passed by a non-const reference as defined by the unit and keeps the parameters
+		 * through which the callee may change the variables of the unit, see `AddOutParameter`.
+		 *
+		 * @param callee The called function.
+		 * @param arguments The arguments of the call.
+		 * @param firstParameter The index of the argument bound to the first parameter (the object of an overloaded
+		 * operator is passed as the first argument).
+		 */
+		template <typename Arguments>
+		void AddReferenceArguments(const clang::FunctionDecl* callee, Arguments arguments, const unsigned firstParameter)
+		{
+			auto index = 0u;
+
+			for (auto* argument : arguments)
+			{
+				if (index >= firstParameter && index - firstParameter < callee->getNumParams())
+				{
+					const auto type = callee->getParamDecl(index - firstParameter)->getType();
+
+					if (type->isReferenceType() && !type.getNonReferenceType().isConstQualified())
+					{
+						AddDefinition(GetBaseDeclaration(argument), true);
+						AddOutParameter(callee, index - firstParameter);
+					}
+					else if (type->isPointerType() && !type->getPointeeType().isConstQualified())
+					{
+						AddOutParameter(callee, index - firstParameter);
+					}
+				}
+
+				index++;
+			}
+		}
+
+	public:
+		explicit SliceUnitASTVisitor(SliceUnit& unit) : unit_(unit)
+		{
+		}
+
+		void AddUse(clang::ValueDecl* decl) const
+		{
+			if (llvm::isa<clang::VarDecl>(decl) || llvm::isa<clang::FieldDecl>(decl))
+			{
+				unit_.uses.push_back(llvm::cast<clang::ValueDecl>(decl->getCanonicalDecl()));
+			}
+		}
+
+		/**
+		 * Marks a variable as defined by the unit.
+		 *
+		 * @param decl The variable or the field, ignored if null.
+		 * @param aliased True if the variable may be changed through another name after the unit, e.g., its address
+		 * is taken.
+		 */
+		void AddDefinition(clang::ValueDecl* decl, const bool aliased) const
+		{
+			if (decl == nullptr || !(llvm::isa<clang::VarDecl>(decl) || llvm::isa<clang::FieldDecl>(decl)))
+			{
+				return;
+			}
+
+			unit_.definitions.push_back(llvm::cast<clang::ValueDecl>(decl->getCanonicalDecl()));
+			unit_.takesAddress |= aliased;
+
+			// Fields are only defined through `this`, see `GetBaseDeclaration`.
+			unit_.changesFields |= llvm::isa<clang::FieldDecl>(decl);
+		}
+
+		void AddCall(const clang::FunctionDecl* function) const
+		{
+			unit_.calls.push_back(GetCalledFunction(function));
+		}
+
+		/**
+		 * Keeps a non-const method or a constructor called by the unit, which may change the fields of its object.
+		 *
+		 * @param method The called method.
+		 * @param object The object of the call, null for constructors.
+		 */
+		void AddChangingMethod(const clang::FunctionDecl* method, clang::Expr* object) const
+		{
+			unit_.changingMethods.push_back(GetCalledFunction(method));
+
+			// Calls on `this` change the fields of the object of the calling method as well.
+			unit_.changesFields |= object != nullptr && llvm::isa<clang::CXXThisExpr>(object->IgnoreParenImpCasts());
+		}
+
+		void AddType(const clang::Decl* decl) const
+		{
+			unit_.types.push_back(decl->getCanonicalDecl());
+		}
+
+		bool VisitBinaryOperator(clang::BinaryOperator* expr)
+		{
+			// Compound assignments are visited as binary operators as well.
+			if (expr->isAssignmentOp())
+			{
+				AddDefinition(GetBaseDeclaration(expr->getLHS()), false);
+			}
+
+			return true;
+		}
+
+		bool VisitUnaryOperator(clang::UnaryOperator* expr)
+		{
+			if (expr->isIncrementDecrementOp())
+			{
+				AddDefinition(GetBaseDeclaration(expr->getSubExpr()), false);
+			}
+			else if (expr->getOpcode() == clang::UO_AddrOf)
+			{
+				AddDefinition(GetBaseDeclaration(expr->getSubExpr()), true);
+			}
+
+			return true;
+		}
+
+		bool VisitImplicitCastExpr(clang::ImplicitCastExpr* expr)
+		{
+			if (expr->getCastKind() == clang::CK_ArrayToPointerDecay)
+			{
+				AddDefinition(GetBaseDeclaration(expr->getSubExpr()), true);
+			}
+
+			return true;
+		}
+
+		bool VisitCallExpr(clang::CallExpr* expr)
+		{
+			const auto callee = expr->getDirectCallee();
+
+			if (callee == nullptr)
+			{
+				return true;
+			}
+
+			// Calls such as `exit` or `abort` leave the function just like `return`.
+			unit_.isJump |= callee->isNoReturn();
+
+			auto firstParameter = 0u;
+			clang::Expr* object = nullptr;
+
+			if (llvm::isa<clang::CXXMemberCallExpr>(expr))
+			{
+				object = llvm::cast<clang::CXXMemberCallExpr>(expr)->getImplicitObjectArgument();
+			}
+			else if (llvm::isa<clang::CXXOperatorCallExpr>(expr) && llvm::isa<clang::CXXMethodDecl>(callee) &&
+				expr->getNumArgs() > 0)
+			{
+				object = expr->getArg(0);
+				firstParameter = 1;
+			}
+
+			if (object != nullptr && !llvm::cast<clang::CXXMethodDecl>(callee)->isConst())
+			{
+				AddDefinition(GetBaseDeclaration(object), false);
+				AddChangingMethod(callee, object);
+			}
+
+			AddReferenceArguments(callee, expr->arguments(), firstParameter);
+
+			return true;
+		}
+
+		bool VisitCXXConstructExpr(clang::CXXConstructExpr* expr)
+		{
+			AddCall(expr->getConstructor());
+			AddChangingMethod(expr->getConstructor(), nullptr);
+			AddReferenceArguments(expr->getConstructor(), expr->arguments(), 0);
+
+			return true;
+		}
+
+		bool VisitCXXThrowExpr(clang::CXXThrowExpr* /*expr*/)
+		{
+			unit_.isJump = true;
+
+			return true;
+		}
+
+		bool VisitDeclRefExpr(clang::DeclRefExpr* expr)
+		{
+			const auto decl = expr->getDecl();
+
+			if (llvm::isa<clang::FunctionDecl>(decl))
+			{
+				AddCall(llvm::cast<clang::FunctionDecl>(decl));
+			}
+			else if (llvm::isa<clang::EnumConstantDecl>(decl))
+			{
+				AddType(llvm::cast<clang::Decl>(decl->getDeclContext()));
+			}
+			else
+			{
+				AddUse(decl);
+			}
+
+			return true;
+		}
+
+		bool VisitMemberExpr(clang::MemberExpr* expr)
+		{
+			const auto member = expr->getMemberDecl();
+
+			if (llvm::isa<clang::CXXMethodDecl>(member))
+			{
+				AddCall(llvm::cast<clang::CXXMethodDecl>(member));
+			}
+			else if (expr->isImplicitAccess() || llvm::isa<clang::CXXThisExpr>(expr->getBase()->IgnoreParenImpCasts()))
+			{
+				AddUse(member);
+			}
+
+			return true;
+		}
+
+		bool VisitVarDecl(clang::VarDecl* decl)
+		{
+			AddDefinition(decl, false);
+
+			// References initialized by a variable are its aliases.
+			if (decl->getType()->isReferenceType() && decl->hasInit())
+			{
+				AddDefinition(GetBaseDeclaration(decl->getInit()), true);
+			}
+
+			return true;
+		}
+
+		bool VisitTagTypeLoc(clang::TagTypeLoc typeLoc)
+		{
+			AddType(typeLoc.getDecl());
+
+			return true;
+		}
+
+		bool VisitTypedefTypeLoc(clang::TypedefTypeLoc typeLoc)
+		{
+			AddType(typeLoc.getTypedefNameDecl());
+
+			return true;
+		}
+	};
+
+	/**
+	 * Builds the slicing graph of the main file, see `SliceGraph`.\n
+	 * Each statement of a block is a unit. Compound statements (e.g., loops) are split into a unit for their header,
+	 * which is the parent of the units of their body. Function signatures, global variables and type declarations
+	 * are units as well.
+	 */
+	class SliceGraphASTVisitor final : public clang::RecursiveASTVisitor<SliceGraphASTVisitor>
+	{
+		clang::ASTContext& astContext_;
+
+		[[nodiscard]] bool IsInMainFile(const clang::SourceLocation location) const
+		{
+			return astContext_.getSourceManager().isInMainFile(location);
+		}
+
+		/**
+		 * Lists the lines spanned by a given source range.
+		 *
+		 * @param range The source range.
+		 * @return All line numbers from the first to the last line of the range.
+		 */
+		[[nodiscard]] std::vector<size_t> GetLines(const clang::SourceRange range) const
+		{
+			const auto& sourceManager = astContext_.getSourceManager();
+			const auto printableRange = GetPrintableRange(GetPrintableRange(range, sourceManager), sourceManager);
+
+			const auto startingLine = sourceManager.getSpellingLineNumber(printableRange.getBegin());
+			const auto endingLine = sourceManager.getSpellingLineNumber(printableRange.getEnd());
+
+			auto lines = std::vector<size_t>();
+
+			for (auto i = startingLine; i <= endingLine; i++)
+			{
+				lines.push_back(i);
+			}
+
+			return lines;
+		}
+
+		/**
+		 * Checks whether only whitespace precedes a given location on its line, e.g., for braces on their own line.
+		 */
+		[[nodiscard]] bool StartsLine(const clang::SourceLocation location) const
+		{
+			const auto& sourceManager = astContext_.getSourceManager();
+			const auto spellingLocation = sourceManager.getSpellingLoc(location);
+			const auto* data = sourceManager.getCharacterData(spellingLocation);
+			const auto column = sourceManager.getSpellingColumnNumber(spellingLocation);
+
+			return std::all_of(data - (column - 1), data, [](const char c)
+			{
+				return std::isspace(static_cast<unsigned char>(c));
+			});
+		}
+
+		static void CollectAccesses(SliceUnit& unit, clang::Stmt* stmt)
+		{
+			SliceUnitASTVisitor(unit).TraverseStmt(stmt);
+		}
+
+		static void CollectAccesses(SliceUnit& unit, clang::Decl* decl)
+		{
+			SliceUnitASTVisitor(unit).TraverseDecl(decl);
+		}
+
+		/**
+		 * Creates the units of a given statement and of its sub-statements.
+		 *
+		 * @param stmt The statement, ignored if null.
+		 * @param parent The unit of the enclosing control statement or of the function signature.
+		 * @param function The canonical declaration of the function containing the statement.
+		 * @return The number of the unit of the statement, its parent for blocks, -1 for null statements.
+		 */
+		int InsertStatement(clang::Stmt* stmt, const int parent, const clang::FunctionDecl* function)
+		{
+			if (stmt == nullptr)
+			{
+				return -1;
+			}
+
+			if (llvm::isa<clang::CompoundStmt>(stmt))
+			{
+				auto childParent = parent;
+
+				for (auto* child : llvm::cast<clang::CompoundStmt>(stmt)->body())
+				{
+					const auto childUnit = InsertStatement(child, childParent, function);
+
+					// The statements following a case label run only if the label is reached.
+					if (llvm::isa<clang::SwitchCase>(child))
+					{
+						childParent = childUnit;
+					}
+				}
+
+				return parent;
+			}
+
+			if (llvm::isa<clang::AttributedStmt>(stmt))
+			{
+				return InsertStatement(llvm::cast<clang::AttributedStmt>(stmt)->getSubStmt(), parent, function);
+			}
+
+			auto unit = SliceUnit();
+			unit.parent = parent;
+			unit.function = function;
+
+			auto children = std::vector<clang::Stmt*>();
+
+			if (llvm::isa<clang::IfStmt>(stmt))
+			{
+				const auto ifStmt = llvm::cast<clang::IfStmt>(stmt);
+
+				unit.lines = GetLines({ifStmt->getBeginLoc(), ifStmt->getCond()->getEndLoc()});
+				CollectAccesses(unit, ifStmt->getInit());
+				CollectAccesses(unit, ifStmt->getConditionVariableDeclStmt());
+				CollectAccesses(unit, ifStmt->getCond());
+				children = {ifStmt->getThen(), ifStmt->getElse()};
+			}
+			else if (llvm::isa<clang::WhileStmt>(stmt))
+			{
+				const auto whileStmt = llvm::cast<clang::WhileStmt>(stmt);
+
+				unit.lines = GetLines({whileStmt->getBeginLoc(), whileStmt->getCond()->getEndLoc()});
+				CollectAccesses(unit, whileStmt->getConditionVariableDeclStmt());
+				CollectAccesses(unit, whileStmt->getCond());
+				children = {whileStmt->getBody()};
+			}
+			else if (llvm::isa<clang::DoStmt>(stmt))
+			{
+				const auto doStmt = llvm::cast<clang::DoStmt>(stmt);
+
+				unit.lines = GetLines({doStmt->getDoLoc(), doStmt->getDoLoc()});
+				const auto conditionLines = GetLines({doStmt->getWhileLoc(), doStmt->getRParenLoc()});
+				unit.lines.insert(unit.lines.end(), conditionLines.begin(), conditionLines.end());
+				CollectAccesses(unit, doStmt->getCond());
+				children = {doStmt->getBody()};
+			}
+			else if (llvm::isa<clang::ForStmt>(stmt))
+			{
+				const auto forStmt = llvm::cast<clang::ForStmt>(stmt);
+
+				unit.lines = GetLines({forStmt->getBeginLoc(), forStmt->getRParenLoc()});
+				CollectAccesses(unit, forStmt->getInit());
+				CollectAccesses(unit, forStmt->getConditionVariableDeclStmt());
+				CollectAccesses(unit, forStmt->getCond());
+				CollectAccesses(unit, forStmt->getInc());
+				children = {forStmt->getBody()};
+			}
+			else if (llvm::isa<clang::CXXForRangeStmt>(stmt))
+			{
+				const auto forStmt = llvm::cast<clang::CXXForRangeStmt>(stmt);
+
+				unit.lines = GetLines({forStmt->getBeginLoc(), forStmt->getRParenLoc()});
+				CollectAccesses(unit, forStmt->getInit());
+				CollectAccesses(unit, forStmt->getLoopVarStmt());
+				CollectAccesses(unit, forStmt->getRangeInit());
+				children = {forStmt->getBody()};
+			}
+			else if (llvm::isa<clang::SwitchStmt>(stmt))
+			{
+				const auto switchStmt = llvm::cast<clang::SwitchStmt>(stmt);
+
+				unit.lines = GetLines({switchStmt->getBeginLoc(), switchStmt->getCond()->getEndLoc()});
+				CollectAccesses(unit, switchStmt->getInit());
+				CollectAccesses(unit, switchStmt->getConditionVariableDeclStmt());
+				CollectAccesses(unit, switchStmt->getCond());
+				children = {switchStmt->getBody()};
+			}
+			else if (llvm::isa<clang::SwitchCase>(stmt))
+			{
+				const auto switchCase = llvm::cast<clang::SwitchCase>(stmt);
+
+				unit.lines = GetLines({switchCase->getBeginLoc(), switchCase->getColonLoc()});
+
+				if (llvm::isa<clang::CaseStmt>(stmt))
+				{
+					CollectAccesses(unit, llvm::cast<clang::CaseStmt>(stmt)->getLHS());
+					CollectAccesses(unit, llvm::cast<clang::CaseStmt>(stmt)->getRHS());
+				}
+
+				children = {switchCase->getSubStmt()};
+			}
+			else if (llvm::isa<clang::LabelStmt>(stmt))
+			{
+				const auto labelStmt = llvm::cast<clang::LabelStmt>(stmt);
+
+				unit.lines = GetLines({labelStmt->getIdentLoc(), labelStmt->getIdentLoc()});
+				children = {labelStmt->getSubStmt()};
+			}
+			else if (llvm::isa<clang::CXXTryStmt>(stmt))
+			{
+				const auto tryStmt = llvm::cast<clang::CXXTryStmt>(stmt);
+
+				unit.lines = GetLines({tryStmt->getTryLoc(), tryStmt->getTryLoc()});
+				children = {tryStmt->getTryBlock()};
+
+				for (auto i = 0u; i < tryStmt->getNumHandlers(); i++)
+				{
+					children.push_back(tryStmt->getHandler(i));
+				}
+			}
+			else if (llvm::isa<clang::CXXCatchStmt>(stmt))
+			{
+				const auto catchStmt = llvm::cast<clang::CXXCatchStmt>(stmt);
+				const auto exceptionDecl = catchStmt->getExceptionDecl();
+
+				unit.lines = GetLines({
+					catchStmt->getCatchLoc(),
+					exceptionDecl != nullptr ? exceptionDecl->getEndLoc() : catchStmt->getCatchLoc()
+				});
+				CollectAccesses(unit, exceptionDecl);
+				children = {catchStmt->getHandlerBlock()};
+			}
+			else
+			{
+				// Simple statements form a single unit together with all of their sub-expressions.
+				unit.lines = GetLines(stmt->getSourceRange());
+				unit.isJump = llvm::isa<clang::ReturnStmt>(stmt) || llvm::isa<clang::BreakStmt>(stmt) ||
+					llvm::isa<clang::ContinueStmt>(stmt) || llvm::isa<clang::GotoStmt>(stmt) || llvm::isa<
+						clang::IndirectGotoStmt>(stmt);
+
+				if (llvm::isa<clang::GotoStmt>(stmt))
+				{
+					unit.jumpTarget = llvm::cast<clang::GotoStmt>(stmt)->getLabel();
+				}
+
+				CollectAccesses(unit, stmt);
+			}
+
+			const auto number = graph.InsertUnit(std::move(unit));
+
+			if (llvm::isa<clang::LabelStmt>(stmt))
+			{
+				graph.SetLabelUnit(llvm::cast<clang::LabelStmt>(stmt)->getDecl(), number);
+			}
+
+			for (auto* child : children)
+			{
+				InsertStatement(child, number, function);
+			}
+
+			return number;
+		}
+
+		/**
+		 * Creates the unit of a type declaration, which refers to the types of its members.
+		 */
+		void InsertTypeDeclaration(clang::Decl* decl)
+		{
+			auto references = SliceUnit();
+			CollectAccesses(references, decl);
+
+			auto unit = SliceUnit();
+			unit.lines = GetLines(decl->getSourceRange());
+			unit.types = std::move(references.types);
+
+			graph.SetTypeUnit(decl->getCanonicalDecl(), graph.InsertUnit(std::move(unit)));
+		}
+
+	public:
+
+		SliceGraph graph;
+
+		explicit SliceGraphASTVisitor(clang::CompilerInstance* ci) : astContext_(ci->getASTContext())
+		{
+		}
+
+		/**
+		 * Creates the unit of the signature of a function definition and the units of its body.\n
+		 * The signature defines the parameters, the lines of the prototypes of the function are added to it.
+		 */
+		bool VisitFunctionDecl(clang::FunctionDecl* decl)
+		{
+			if (!decl->doesThisDeclarationHaveABody() || decl->getBody() == nullptr || !IsInMainFile(
+				decl->getBeginLoc()))
+			{
+				return true;
+			}
+
+			// Lambda bodies belong to the units in which the lambdas are defined.
+			if (llvm::isa<clang::CXXMethodDecl>(decl) && llvm::cast<clang::CXXMethodDecl>(decl)->getParent()->isLambda())
+			{
+				return true;
+			}
+
+			const auto function = decl->getCanonicalDecl();
+			const auto bodyBegin = decl->getBody()->getBeginLoc();
+
+			auto unit = SliceUnit();
+			unit.function = function;
+			unit.lines = GetLines({decl->getBeginLoc(), bodyBegin});
+
+			// The opening brace on its own line belongs to the body.
+			if (unit.lines.size() > 1 && StartsLine(bodyBegin))
+			{
+				unit.lines.pop_back();
+			}
+
+			for (auto* redeclaration : decl->redecls())
+			{
+				if (redeclaration != decl && IsInMainFile(redeclaration->getBeginLoc()))
+				{
+					const auto prototypeLines = GetLines(redeclaration->getSourceRange());
+					unit.lines.insert(unit.lines.end(), prototypeLines.begin(), prototypeLines.end());
+				}
+			}
+
+			SliceUnitASTVisitor signatureVisitor(unit);
+
+			if (const auto typeInfo = decl->getTypeSourceInfo())
+			{
+				// Parameters are visited as a part of the function type.
+				signatureVisitor.TraverseTypeLoc(typeInfo->getTypeLoc());
+			}
+
+			if (llvm::isa<clang::CXXMethodDecl>(decl))
+			{
+				signatureVisitor.AddType(llvm::cast<clang::CXXMethodDecl>(decl)->getParent());
+			}
+
+			if (llvm::isa<clang::CXXConstructorDecl>(decl))
+			{
+				for (auto* initializer : llvm::cast<clang::CXXConstructorDecl>(decl)->inits())
+				{
+					if (initializer->isWritten())
+					{
+						signatureVisitor.AddDefinition(initializer->getAnyMember(), false);
+						signatureVisitor.TraverseConstructorInitializer(initializer);
+					}
+				}
+			}
+
+			const auto number = graph.InsertUnit(std::move(unit));
+			graph.SetFunctionUnit(function, number);
+
+			InsertStatement(decl->getBody(), number, function);
+
+			return true;
+		}
+
+		/**
+		 * Creates the units of global variables and static data members.
+		 */
+		bool VisitVarDecl(clang::VarDecl* decl)
+		{
+			if (!(decl->isFileVarDecl() || decl->isStaticDataMember()) || !IsInMainFile(decl->getBeginLoc()))
+			{
+				return true;
+			}
+
+			auto unit = SliceUnit();
+			unit.lines = GetLines(decl->getSourceRange());
+			CollectAccesses(unit, decl);
+
+			graph.InsertUnit(std::move(unit));
+
+			return true;
+		}
+
+		/**
+		 * Creates the units of the definitions of records and enumerations.\n
+		 * Only the types the definition refers to are needed when it is in the slice, the members are kept whole.
+		 */
+		bool VisitTagDecl(clang::TagDecl* decl)
+		{
+			if (!decl->isThisDeclarationADefinition() || !IsInMainFile(decl->getBeginLoc()) ||
+				(llvm::isa<clang::CXXRecordDecl>(decl) && llvm::cast<clang::CXXRecordDecl>(decl)->isLambda()))
+			{
+				return true;
+			}
+
+			InsertTypeDeclaration(decl);
+
+			return true;
+		}
+
+		bool VisitTypedefNameDecl(clang::TypedefNameDecl* decl)
+		{
+			if (IsInMainFile(decl->getBeginLoc()))
+			{
+				InsertTypeDeclaration(decl);
+			}
+
+			return true;
+		}
+	};
 } // namespace SliceExtractor
 
 #endif
@@ -33,4 +33,38 @@ namespace SliceExtractor
 		return std::unique_ptr<clang::tooling::FrontendActionFactory>(
 			std::make_unique<SliceExtractorFrontendActionFactory>(lines));
 	}
+
+	/**
+	 * Creates a `SlicerFrontendActionFactory` with a given container for the lines of the slice.\n
+	 * This extra step is required due to the default `FrontendActionFactory` not having support for custom constructors
+	 * and passing data to created instances.
+	 *
+	 * @param lines A container for the lines of the slice.
+	 * @param trace The lines executed by the program for a dynamic slice, null for a static slice.
+	 * @return A `SlicerFrontendActionFactory` instance with the given container as a member.
+	 */
+	std::unique_ptr<clang::tooling::FrontendActionFactory> SlicerFrontendActionFactory(
+		std::vector<size_t>& lines, const Execution::JitTrace* trace)
+	{
+		class SlicerFrontendActionFactory : public clang::tooling::FrontendActionFactory
+		{
+			std::vector<size_t>& lines_;
+			const Execution::JitTrace* trace_;
+
+		public:
+
+			SlicerFrontendActionFactory(std::vector<size_t>& lines, const Execution::JitTrace* trace) : lines_(lines),
+				trace_(trace)
+			{
+			}
+
+			std::unique_ptr<clang::FrontendAction> create() override
+			{
+				return std::make_unique<SlicerAction>(lines_, trace_);
+			}
+		};
+
+		return std::unique_ptr<clang::tooling::FrontendActionFactory>(
+			std::make_unique<SlicerFrontendActionFactory>(lines, trace));
+	}
 } // namespace SliceExtractor
@@ -0,0 +1,13 @@
+#include "../../Common/include/Streams.h"
+#include "../include/SliceExtractor.h"
+
+/**
+ * Runs the slice extractor as a standalone program.
+ */
+int main(int argc, const char** argv)
+{
+	const auto result = SliceExtractor::RunSliceExtractor(argc, argv);
+	Out::Flush();
+
+	return result;
+}
@@ -0,0 +1,177 @@
+#include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/Tooling.h"
+
+#include <fstream>
+#include <optional>
+
+#include "../../Common/include/Helper.h"
+#include "../../Common/include/JitExecutor.h"
+#include "../../Common/include/Streams.h"
+#include "../include/Actions.h"
+#include "../include/SliceExtractor.h"
+
+#define _SILENCE_ALL_CXX17_DEPRECATION_WARNINGS
+
+using namespace clang;
+using namespace llvm;
+
+/**
+ * The time limit of the traced run in seconds.
+ */
+constexpr int TraceTimeout = 30;
+
+/**
+ * Computes the slice of the error location and writes its line numbers to the output file.\n
+ * The static slice is computed from the AST of the input. If `dynamic` is set, the program is first run with
+ * the `--arguments` in the JIT and the lines it executes are recorded, the slice is then the static slice restricted
+ * to the lines executed before the last execution of the error location.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments, including the program name.
+ * @param dynamic Specifies whether the dynamic slice should be computed.
+ * @return The exit code of the slicing.
+ */
+static int RunSlicer(int argc, const char** argv, const bool dynamic)
+{
+	const auto kind = dynamic ? "dynamic" : "static";
+
+	// Parse the command-line args passed to the tool.
+	auto op = ParseCommandLine(argc, argv);
+
+	if (!op)
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (op->getSourcePathList().size() > 1)
+	{
+		errs() << "Only a single source file is supported.\n";
+		return EXIT_FAILURE;
+	}
+
+	const auto& sourcePath = op->getSourcePathList()[0];
+
+	tooling::ClangTool tool(op->getCompilations(), sourcePath);
+
+	// Include paths are not always recognized, especially for standard/system includes.
+	// This Adjuster helps with that.
+	auto includes = tooling::getInsertArgumentAdjuster("-I/usr/local/lib/clang/11.0.0/include/");
+	tool.appendArgumentsAdjuster(includes);
+
+	const auto inputLanguage = DetermineInputLanguage(tool, op->getCompilations(), sourcePath);
+
+	if (inputLanguage == Language::Unknown)
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Check whether the given line is in the file and pretty print it to the standard output.
+	if (!CheckLocationValidity(sourcePath, LineNumber))
+	{
+		errs() << "The specified error location is invalid!\nSource path: " << sourcePath
+			<< ", line: " << LineNumber << " could not be found.\n";
+	}
+
+	std::optional<Execution::JitTrace> trace;
+
+	if (dynamic)
+	{
+		trace = Execution::TraceInJit(sourcePath, inputLanguage, TraceTimeout, LineNumber);
+
+		if (!trace->run.failure.empty())
+		{
+			errs() << trace->run.failure << "\nThe program could not be run, the slice could not be computed.\n";
+			return EXIT_FAILURE;
+		}
+
+		if (!trace->run.compiled)
+		{
+			errs() << "The program could not be compiled, the slice could not be computed.\n";
+			return EXIT_FAILURE;
+		}
+
+		if (!trace->reachedStopLine)
+		{
+			errs() << "The error location has not been executed, the slice could not be computed.\n";
+			return EXIT_FAILURE;
+		}
+
+		Out::Verb() << "Traced run: " << trace->executedLines.size() << " of " << trace->codeLines.size()
+			<< " lines with code have been executed.\n";
+	}
+
+	std::vector<size_t> sliceLines;
+
+	auto result = RunOnSharedAST(tool, op->getCompilations(), sourcePath,
+	                             SliceExtractor::SlicerFrontendActionFactory(
+		                             sliceLines, trace ? &*trace : nullptr).get());
+
+	if (result != 0)
+	{
+		errs() << "The tool returned a non-standard value: " << result << "\n";
+	}
+
+	if (sliceLines.empty())
+	{
+		errs() << "No code has been found on the error location, the slice could not be computed.\n";
+		return EXIT_FAILURE;
+	}
+
+	std::ofstream ofs(OutputFile);
+
+	if (ofs)
+	{
+		Out::Verb() << "Lines of the " << kind << " slice:\n";
+
+		for (auto line : sliceLines)
+		{
+			Out::Verb() << line << "\n";
+
+			ofs << line << "\n";
+		}
+	}
+	else
+	{
+		errs() << "The output file could not be opened.\n";
+		return EXIT_FAILURE;
+	}
+
+	Out::All() << (dynamic ? "Dynamic" : "Static") << " slicing done, " << sliceLines.size()
+		<< " lines are in the slice.\n";
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Computes the static slice of the error location and writes its line numbers to the output file.\n
+ * Serves as the body of the `static-slice` stage of the `autopie` driver.
+ *
+ * Call:\n
+ * > autopie static-slice [line with error] [output path] <source path> --
+ * e.g. autopie static-slice --loc-line=17 -o="static_slice.txt" example.cpp --
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments, including the program name.
+ * @return The exit code of the slicing.
+ */
+int SliceExtractor::RunStaticSlicer(int argc, const char** argv)
+{
+	return RunSlicer(argc, argv, false);
+}
+
+/**
+ * Computes the dynamic slice of the error location and writes its line numbers to the output file.\n
+ * Serves as the body of the `dynamic-slice` stage of the `autopie` driver.
+ *
+ * Call:\n
+ * > autopie dynamic-slice [line with error] [arguments] [output path] <source path> --
+ * e.g. autopie dynamic-slice --loc-line=17 --arguments="input.txt" -o="dynamic_slice.txt" example.cpp --
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments, including the program name.
+ * @return The exit code of the slicing.
+ */
+int SliceExtractor::RunDynamicSlicer(int argc, const char** argv)
+{
+	return RunSlicer(argc, argv, true);
+}
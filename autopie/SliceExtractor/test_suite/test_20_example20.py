@@ -0,0 +1,25 @@
+import os
+import unittest
+from run_tests import BaseTest
+
+TestName = 'example20.cpp'
+
+SliceFile = 'example20_static_slice.txt'
+
+Output = '''\
+Static slicing done, 21 lines are in the slice.
+'''
+
+
+class Example20(BaseTest):
+    def test_execution(self):
+        self.runTool(TestName, Output, ['static-slice', '--loc-line=40', f'-o={SliceFile}'])
+
+        with open(SliceFile, 'r') as actual, open(os.path.join('results', SliceFile), 'r') as expected:
+            self.evaluate(expected.read(), actual.read(), command=f'static-slice {TestName}')
+
+        os.remove(SliceFile)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,42 @@
+/*
+ * Division by zero -- `y` is zeroed by `Init` through a pointer. The slice of line 40 must keep
+ * the assignments made by the callees through their parameters and through `this`.
+ */
+
+struct Counter
+{
+	int value = 0;
+
+	void Reset();
+};
+
+void Counter::Reset()
+{
+	value = 10;
+}
+
+void Set(int& r)
+{
+	r = 5;
+}
+
+void Init(int* p)
+{
+	*p = 0;
+}
+
+int main()
+{
+	int x = 1;
+	int y = 1;
+	int z = 2;
+	Counter counter;
+
+	Set(x);
+	Init(&y);
+	counter.Reset();
+	z++;
+
+	int result = x / y + counter.value;
+	return 0;
+}
@@ -0,0 +1,346 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "../../Common/include/BitMaskBin.h"
+#include "../../Common/include/Context.h"
+#include "../../Common/include/DependencyGraph.h"
+#include "../../Common/include/Helper.h"
+#include "../../Common/include/Options.h"
+
+#define _SILENCE_ALL_CXX17_DEPRECATION_WARNINGS
+
+using namespace Common;
+
+/**
+ * Contains the regression tests of the reduction's building blocks that can be checked without compiling
+ * and running the variants, i.e., the encoding of bit masks, the bins and the checkpoints.
+ */
+namespace Tests
+{
+	/**
+	 * Creates a synthetic dependency graph, see `Benchmarks::CreateGraph`.\n
+	 * Each node depends on its predecessor in a deep graph and on the first node in a shallow graph. Every third
+	 * node also depends on its predecessor through a variable. The last node is the criterion.
+	 *
+	 * @param nodeCount The number of nodes (code units) in the graph.
+	 * @param deep Specifies whether the nodes should be nested in each other.
+	 * @return The created graph.
+	 */
+	static DependencyGraph CreateGraph(const int nodeCount, const bool deep)
+	{
+		auto graph = DependencyGraph();
+
+		for (auto i = 0; i < nodeCount; i++)
+		{
+			graph.InsertNodeDataForDebugging(i, i, std::string(16 + i % 7, 'x'), "Stmt", "black");
+		}
+
+		for (auto i = 1; i < nodeCount; i++)
+		{
+			graph.InsertStatementDependency(deep ? i - 1 : 0, i);
+
+			if (i % 3 == 0)
+			{
+				graph.InsertVariableDependency(i - 1, i);
+			}
+		}
+
+		graph.AddCriterionNode(nodeCount - 1);
+
+		return graph;
+	}
+
+	/**
+	 * Creates bit masks with randomly set bits, always using the same seed.
+	 *
+	 * @param nodeCount The size of each bit mask.
+	 * @param count The number of bit masks.
+	 * @return The created bit masks.
+	 */
+	static std::vector<BitMask> CreateBitMasks(const int nodeCount, const int count)
+	{
+		auto generator = std::mt19937(42);
+		auto bitMasks = std::vector<BitMask>();
+
+		for (auto i = 0; i < count; i++)
+		{
+			auto bitMask = BitMask(nodeCount);
+
+			for (auto j = 0; j < nodeCount; j++)
+			{
+				bitMask[j] = generator() % 2 == 0;
+			}
+
+			bitMasks.push_back(bitMask);
+		}
+
+		return bitMasks;
+	}
+
+	/**
+	 * Runs each test in its own directory, so that the spilled bins and the checkpoints of one test are never
+	 * seen by another one.
+	 */
+	class TemporaryDirectoryTest : public testing::Test
+	{
+		std::filesystem::path previousPath_;
+
+	protected:
+		std::filesystem::path directory_;
+
+		void SetUp() override
+		{
+			previousPath_ = std::filesystem::current_path();
+			directory_ = std::filesystem::temp_directory_path() / ("autopie_" + std::string(
+				testing::UnitTest::GetInstance()->current_test_info()->name()));
+
+			std::filesystem::remove_all(directory_);
+			std::filesystem::create_directories(directory_);
+			std::filesystem::current_path(directory_);
+		}
+
+		void TearDown() override
+		{
+			std::filesystem::current_path(previousPath_);
+			std::filesystem::remove_all(directory_);
+		}
+	};
+
+	TEST(BitMaskEncoding, DecodesEncodedBitMasks)
+	{
+		for (auto size : {1, 7, 32, 63, 64})
+		{
+			for (const auto& bitMask : CreateBitMasks(size, 64))
+			{
+				auto decoded = BitMask(size);
+				DecodeBitMask(EncodeBitMask(bitMask), decoded);
+
+				EXPECT_EQ(decoded, bitMask) << "size " << size;
+			}
+		}
+	}
+
+	TEST(BitMaskEncoding, MatchesInitializeBitMask)
+	{
+		for (size_t number : {0, 1, 2, 5, 1023, 4096, 65535})
+		{
+			auto bitMask = BitMask(16);
+			InitializeBitMask(bitMask, number);
+
+			EXPECT_EQ(EncodeBitMask(bitMask), number);
+		}
+	}
+
+	TEST(BitMaskEncoding, KeepsTheFirstUnitInTheMostSignificantBit)
+	{
+		auto bitMask = BitMask(64, false);
+		bitMask[0] = true;
+
+		EXPECT_EQ(EncodeBitMask(bitMask), static_cast<EncodedBitMask>(1) << 63);
+	}
+
+	/**
+	 * The encoded validation must accept exactly the variants accepted by the validation of `BitMask`s
+	 * and compute the same size ratio.
+	 */
+	TEST(IsValid, EncodedOverloadAgrees)
+	{
+		for (auto nodeCount : {5, 20, 64})
+		{
+			for (auto deep : {false, true})
+			{
+				auto graph = CreateGraph(nodeCount, deep);
+				graph.Prepare(nodeCount);
+
+				const auto encodedGraph = EncodedDependencies(graph, nodeCount);
+
+				for (const auto& bitMask : CreateBitMasks(nodeCount, 512))
+				{
+					for (auto heuristics : {false, true})
+					{
+						const auto expected = IsValid(bitMask, graph, heuristics);
+						const auto actual = IsValid(EncodeBitMask(bitMask), encodedGraph, heuristics);
+
+						ASSERT_EQ(actual.first, expected.first) << "units " << nodeCount << ", deep " << deep;
+
+						if (expected.first)
+						{
+							EXPECT_DOUBLE_EQ(actual.second, expected.second);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	TEST(IsValid, EncodedOverloadAgreesWithLearnedDependencies)
+	{
+		auto graph = CreateGraph(12, false);
+		graph.InsertLearnedDependency(4, 9);
+		graph.Prepare(12);
+
+		const auto encodedGraph = EncodedDependencies(graph, 12);
+
+		for (const auto& bitMask : CreateBitMasks(12, 512))
+		{
+			EXPECT_EQ(IsValid(EncodeBitMask(bitMask), encodedGraph, false).first, IsValid(bitMask, graph, false).first);
+		}
+	}
+
+	using BitMaskBinTest = TemporaryDirectoryTest;
+
+	/**
+	 * Bins spilled into several segments are iterated in the order in which the bit masks were added,
+	 * including bins appended to each other.
+	 */
+	TEST_F(BitMaskBinTest, IteratesAcrossSpilledSegments)
+	{
+		const auto bitMasks = CreateBitMasks(40, 100);
+
+		auto first = BitMaskBin(40, 16);
+		auto second = BitMaskBin(40, 16);
+
+		for (size_t i = 0; i < bitMasks.size(); i++)
+		{
+			(i < 70 ? first : second).Add(bitMasks[i]);
+		}
+
+		ASSERT_GT(first.GetSpilledCount(), 0u);
+		ASSERT_GT(second.GetSpilledCount(), 0u);
+
+		first.Append(std::move(second));
+
+		EXPECT_TRUE(second.empty());
+		EXPECT_LE(first.GetCodes().size(), 16u);
+		ASSERT_EQ(first.size(), bitMasks.size());
+
+		size_t i = 0;
+
+		for (const auto& bitMask : first)
+		{
+			ASSERT_LT(i, bitMasks.size());
+			EXPECT_EQ(bitMask, bitMasks[i]) << "bit mask " << i;
+			i++;
+		}
+
+		EXPECT_EQ(i, bitMasks.size());
+	}
+
+	TEST_F(BitMaskBinTest, RemovesSegmentsWithTheLastBin)
+	{
+		{
+			auto bin = BitMaskBin(8, 4);
+
+			for (EncodedBitMask code = 0; code < 10; code++)
+			{
+				bin.Add(code);
+			}
+
+			EXPECT_FALSE(std::filesystem::is_empty(SpillFolder));
+		}
+
+		EXPECT_TRUE(std::filesystem::is_empty(SpillFolder));
+	}
+
+	TEST_F(BitMaskBinTest, IteratesAnEmptyBin)
+	{
+		const auto bin = BitMaskBin(8, 4);
+
+		EXPECT_TRUE(bin.begin() == bin.end());
+	}
+
+	/**
+	 * Runs each test on a small input with `--checkpoint-file` set.
+	 */
+	class CheckpointTest : public TemporaryDirectoryTest
+	{
+	protected:
+		std::string inputFile_;
+
+		void SetUp() override
+		{
+			TemporaryDirectoryTest::SetUp();
+
+			inputFile_ = (directory_ / "input.c").string();
+			std::ofstream(inputFile_) << "int main(void)\n{\n\treturn 1 / 0;\n}\n";
+
+			CheckpointFile.setValue((directory_ / "reduction.checkpoint").string());
+		}
+
+		void TearDown() override
+		{
+			CheckpointFile.setValue("");
+
+			TemporaryDirectoryTest::TearDown();
+		}
+
+		[[nodiscard]] InputData CreateInput() const
+		{
+			return InputData("", Location(inputFile_, 3), 0.0, false);
+		}
+	};
+
+	TEST_F(CheckpointTest, RestoresTheSavedState)
+	{
+		auto input = CreateInput();
+
+		{
+			auto context = GlobalContext(input, inputFile_, 4);
+			context.checkpoint.iteration = 42;
+			context.checkpoint.epoch = 2;
+			context.checkpoint.binCursor = 17;
+			context.unsavedValidations = {{1234, true}, {5678, false}};
+
+			SaveCheckpoint(context, "naive", true);
+		}
+
+		auto context = GlobalContext(input, inputFile_, 4);
+
+		ASSERT_TRUE(LoadCheckpoint(context, "naive"));
+		EXPECT_TRUE(context.checkpoint.resumed);
+		EXPECT_EQ(context.checkpoint.iteration, 42);
+		EXPECT_EQ(context.checkpoint.epoch, 2);
+		EXPECT_EQ(context.checkpoint.binCursor, 17u);
+		EXPECT_EQ(context.validationCache.size(), 2u);
+		EXPECT_TRUE(context.validationCache[1234]);
+		EXPECT_FALSE(context.validationCache[5678]);
+	}
+
+	TEST_F(CheckpointTest, RejectsACheckpointOfAnotherTool)
+	{
+		auto input = CreateInput();
+		auto context = GlobalContext(input, inputFile_, 4);
+
+		SaveCheckpoint(context, "naive", true);
+
+		EXPECT_FALSE(LoadCheckpoint(context, "delta"));
+	}
+
+	TEST_F(CheckpointTest, RejectsAChangedInput)
+	{
+		auto input = CreateInput();
+		auto context = GlobalContext(input, inputFile_, 4);
+
+		SaveCheckpoint(context, "naive", true);
+		std::ofstream(inputFile_, std::ios::app) << "\n";
+
+		EXPECT_FALSE(LoadCheckpoint(context, "naive"));
+	}
+
+	TEST_F(CheckpointTest, SkipsSavesWithinTheInterval)
+	{
+		auto input = CreateInput();
+		auto context = GlobalContext(input, inputFile_, 4);
+
+		SaveCheckpoint(context, "naive");
+
+		EXPECT_FALSE(std::filesystem::exists(std::string(CheckpointFile)));
+
+		SaveCheckpoint(context, "naive", true);
+
+		EXPECT_TRUE(std::filesystem::exists(std::string(CheckpointFile)));
+	}
+} // namespace Tests
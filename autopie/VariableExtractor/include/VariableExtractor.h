@@ -0,0 +1,18 @@
+#ifndef VARIABLE_EXTRACTOR_H
+#define VARIABLE_EXTRACTOR_H
+#pragma once
+
+namespace VariableExtractor
+{
+	/**
+	 * Extracts variables on a given line in a given file.\n
+	 * Used as the entry point of both the `VariableExtractor` binary and the `variables` stage of the `autopie` driver.
+	 *
+	 * @param argc The number of command-line arguments.
+	 * @param argv The command-line arguments, including the program name.
+	 * @return The exit code of the run.
+	 */
+	int RunVariableExtractor(int argc, const char** argv);
+}
+
+#endif
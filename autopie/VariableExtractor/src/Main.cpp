@@ -0,0 +1,13 @@
+#include "../../Common/include/Streams.h"
+#include "../include/VariableExtractor.h"
+
+/**
+ * Runs the variable extractor as a standalone program.
+ */
+int main(int argc, const char** argv)
+{
+	const auto result = VariableExtractor::RunVariableExtractor(argc, argv);
+	Out::Flush();
+
+	return result;
+}
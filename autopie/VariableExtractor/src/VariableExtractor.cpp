@@ -13,6 +13,7 @@
 
 #include "../../Common/include/Helper.h"
 #include "../../Common/include/Streams.h"
+#include "../include/VariableExtractor.h"
 
 #define _SILENCE_ALL_CXX17_DEPRECATION_WARNINGS
 
@@ -60,56 +61,51 @@ public:
 };
 
 /**
- * Extracts variables on a given line in a given file.
+ * Extracts variables on a given line in a given file.\n
+ * Serves as the body of the `VariableExtractor` binary and of the `variables` stage of the `autopie` driver.
  *
  * Call:\n
  * > VariableExtractor.exe [line with error] [output path] <source path> --
  * e.g. VariableExtractor.exe --loc-line=17 -o="variables.txt" example.cpp --
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments, including the program name.
+ * @return The exit code of the extraction.
  */
-int main(int argc, const char** argv)
+int VariableExtractor::RunVariableExtractor(int argc, const char** argv)
 {
 	// Parse the command-line args passed to the tool.
-	tooling::CommonOptionsParser op(argc, argv, AutoPieArgs);
+	auto op = ParseCommandLine(argc, argv);
 
-	if (op.getSourcePathList().size() > 1)
+	if (!op)
+	{
+		return EXIT_FAILURE;
+	}
+
+	if (op->getSourcePathList().size() > 1)
 	{
 		errs() << "Only a single source file is supported.\n";
 		return EXIT_FAILURE;
 	}
 
-	tooling::ClangTool tool(op.getCompilations(), op.getSourcePathList()[0]);
+	tooling::ClangTool tool(op->getCompilations(), op->getSourcePathList()[0]);
 
 	// Include paths are not always recognized, especially for standard/system includes.
 	// This Adjuster helps with that.
 	auto includes = tooling::getInsertArgumentAdjuster("-I/usr/local/lib/clang/11.0.0/include/");
 	tool.appendArgumentsAdjuster(includes);
 
-	auto inputLanguage = Language::Unknown;
-	// Run a language check inside a separate scope so that all built ASTs get freed at the end.
-	{
-		Out::Verb() << "Checking the language...\n";
-
-		std::vector<std::unique_ptr<ASTUnit>> trees;
-		tool.buildASTs(trees);
+	const auto inputLanguage = DetermineInputLanguage(tool, op->getCompilations(), op->getSourcePathList()[0]);
 
-		if (trees.size() != 1)
-		{
-			errs() << "Although only one AST was expected, " << trees.size() << " ASTs have been built.\n";
-			return EXIT_FAILURE;
-		}
-
-		inputLanguage = (*trees.begin())->getInputKind().getLanguage();
-
-		Out::Verb() << "File: " << (*trees.begin())->getOriginalSourceFileName() << ", language: " <<
-			LanguageToString(inputLanguage) << "\n";
+	if (inputLanguage == Language::Unknown)
+	{
+		return EXIT_FAILURE;
 	}
 
-	assert(inputLanguage != clang::Language::Unknown);
-
 	// Check whether the given line is in the file and pretty print it to the standard output.
-	if (!CheckLocationValidity(op.getSourcePathList()[0], LineNumber))
+	if (!CheckLocationValidity(op->getSourcePathList()[0], LineNumber))
 	{
-		errs() << "The specified error location is invalid!\nSource path: " << op.getSourcePathList()[0]
+		errs() << "The specified error location is invalid!\nSource path: " << op->getSourcePathList()[0]
 			<< ", line: " << LineNumber << " could not be found.\n";
 	}
 
@@ -121,7 +117,8 @@ int main(int argc, const char** argv)
 
 	Out::Verb() << "Matching variables...\n";
 
-	auto result = tool.run(tooling::newFrontendActionFactory(&finder).get());
+	auto result = RunOnSharedAST(tool, op->getCompilations(), op->getSourcePathList()[0],
+	                             tooling::newFrontendActionFactory(&finder).get());
 
 	if (result != 0)
 	{